@@ -4,16 +4,47 @@ if(NOT GlslangValidator)
    message(FATAL_ERROR "failed to find glslangValidator")
 endif()
 
+# INCLUDE_DIRS are searched for the files included by the shader, e.g. the include directory
+# of vuh to compile custom operations of the bundled algorithms.
 function(vuh_compile_shader)
    set(OneValueArgs SOURCE TARGET)
-   cmake_parse_arguments(COMPILE_SHADER "" "${OneValueArgs}" "" ${ARGN})
+   set(MultiValueArgs INCLUDE_DIRS)
+   cmake_parse_arguments(COMPILE_SHADER "" "${OneValueArgs}" "${MultiValueArgs}" ${ARGN})
 
+   set(Includes)
+   foreach(Dir ${COMPILE_SHADER_INCLUDE_DIRS})
+      list(APPEND Includes -I${Dir})
+   endforeach()
    get_filename_component(TargetDir ${COMPILE_SHADER_TARGET} DIRECTORY)
    add_custom_command(
       COMMAND ${CMAKE_COMMAND} ARGS -E make_directory ${TargetDir}
-      COMMAND ${GlslangValidator} ARGS -V ${COMPILE_SHADER_SOURCE} -o ${COMPILE_SHADER_TARGET} --spirv-val #-Os
+      COMMAND ${GlslangValidator} ARGS -V ${Includes} ${COMPILE_SHADER_SOURCE} -o ${COMPILE_SHADER_TARGET} --spirv-val #-Os
       DEPENDS ${COMPILE_SHADER_SOURCE}
       OUTPUT ${COMPILE_SHADER_TARGET}
    )
    add_custom_target(${ARGV0} DEPENDS ${COMPILE_SHADER_TARGET})
 endfunction()
+
+# Compile the shader to a C++ header defining the SPIR-V code as `const uint32_t <NAME>[]`.
+# DEFINES are passed to the preprocessor, ENV selects the target environment (e.g. vulkan1.1),
+# DEPENDS lists the files included by the shader.
+function(vuh_embed_shader)
+   set(OneValueArgs SOURCE TARGET NAME ENV)
+   set(MultiValueArgs DEFINES DEPENDS)
+   cmake_parse_arguments(EMBED_SHADER "" "${OneValueArgs}" "${MultiValueArgs}" ${ARGN})
+
+   set(Options)
+   if(EMBED_SHADER_ENV)
+      list(APPEND Options --target-env ${EMBED_SHADER_ENV})
+   endif()
+   foreach(Define ${EMBED_SHADER_DEFINES})
+      list(APPEND Options -D${Define})
+   endforeach()
+   get_filename_component(TargetDir ${EMBED_SHADER_TARGET} DIRECTORY)
+   add_custom_command(
+      COMMAND ${CMAKE_COMMAND} ARGS -E make_directory ${TargetDir}
+      COMMAND ${GlslangValidator} ARGS -V ${Options} --vn ${EMBED_SHADER_NAME} ${EMBED_SHADER_SOURCE} -o ${EMBED_SHADER_TARGET}
+      DEPENDS ${EMBED_SHADER_SOURCE} ${EMBED_SHADER_DEPENDS}
+      OUTPUT ${EMBED_SHADER_TARGET}
+   )
+endfunction()
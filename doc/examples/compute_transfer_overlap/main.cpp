@@ -43,7 +43,7 @@ auto main()-> int {
 	const auto a = 0.1f;                         // saxpy scaling constant
 
 	auto instance = vuh::Instance();
-	auto device = instance.devices().at(0);  // just get the first compute-capable device
+	auto device = vuh::Device(instance, instance.bestDevice()); // prefer discrete GPU over integrated or CPU
 	using Specs = vuh::typelist<uint32_t>;   // the only specialization constant is the workgroup dimension
 
 	struct Params{uint32_t size; float a;};  // kernel parameters: array size, and saxpy scaling constant
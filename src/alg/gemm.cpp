@@ -0,0 +1,187 @@
+#include <vuh/alg/gemm.hpp>
+#include <vuh/cache.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+
+namespace {
+	using vuh::detail::GemmVariant;
+
+	/// Square problem sizes the variants are tuned on, one per size class.
+	/// Size classes are split by the larger dimension of the result, see sizeClass().
+	constexpr uint32_t tune_sizes[] = {128, 512, 1024};
+	/// Number of timed runs of each variant.
+	constexpr auto tune_reps = 3;
+
+	/// @return size class of the m x n result
+	auto sizeClass(uint32_t m, uint32_t n)-> size_t {
+		const auto d = std::max(m, n);
+		return d <= 128 ? 0 : (d <= 512 ? 1 : 2);
+	}
+
+	/// @return true if the variant fits the device limits on the workgroup size and shared memory
+	auto fits(const vuh::Device& device, const GemmVariant& v)-> bool {
+		const auto& limits = device.limits();
+		const auto shared_bytes = size_t(v.tile_k)*(v.group_y*v.rows + v.group_x*v.cols)*sizeof(float);
+		return v.group_x*v.group_y <= limits.maxComputeWorkGroupInvocations
+		       && v.group_x <= limits.maxComputeWorkGroupSize[0]
+		       && v.group_y <= limits.maxComputeWorkGroupSize[1]
+		       && shared_bytes <= limits.maxComputeSharedMemorySize;
+	}
+
+	/// Submit the batch and wait for it to complete.
+	auto run(vuh::Device& device, vuh::detail::Batch& batch)-> void {
+		auto fence = batch.submit();
+		(void)device.waitForFences({fence}, true, uint64_t(-1));
+		device.destroyFence(fence);
+	}
+
+	/// @return time (seconds) of the s x s x s multiply with the variant, infinity if it fails to run.
+	auto measure(vuh::Device& device, const GemmVariant& v, uint32_t s
+	             , vk::Buffer a, vk::Buffer b, vk::Buffer c)-> double
+	{
+		using vuh::detail::Batch;
+		try {
+			auto record = [&](Batch& batch){
+				vuh::detail::record_gemm(batch, device, v, s, s, s, 1.f, {a, 0, s, 0}, {b, 0, s, 0}
+				                         , 0.f, {c, 0, s, 0}, 1);
+			};
+			auto warmup = Batch(device); // pipeline creation and clock ramp-up
+			record(warmup);
+			run(device, warmup);
+			auto timed = Batch(device);
+			for(int i = 0; i < tune_reps; ++i){
+				record(timed);
+			}
+			const auto start = std::chrono::steady_clock::now();
+			run(device, timed);
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()/tune_reps;
+		} catch(std::exception&){
+			return std::numeric_limits<double>::infinity();
+		}
+	}
+
+	/// @return index of the fastest variant fitting the device on the problem of the size class
+	auto tune(vuh::Device& device, size_t size_class)-> uint32_t {
+		using vuh::detail::ScratchArray;
+		const auto s = tune_sizes[size_class];
+		const auto bytes = size_t(s)*s*sizeof(float);
+		auto a = ScratchArray<float>(device, size_t(s)*s);
+		auto b = ScratchArray<float>(device, size_t(s)*s);
+		auto c = ScratchArray<float>(device, size_t(s)*s);
+		{ // zero inputs, so that timings are not affected by denormals or NaNs
+			auto batch = vuh::detail::Batch(device);
+			batch.fill(a, 0, bytes, 0u);
+			batch.fill(b, 0, bytes, 0u);
+			run(device, batch);
+		}
+		const auto& variants = vuh::detail::gemm_variants();
+		auto best = uint32_t(0);
+		auto best_time = std::numeric_limits<double>::infinity();
+		for(uint32_t i = 0; i < variants.size(); ++i){
+			if(!fits(device, variants[i])){
+				continue;
+			}
+			const auto t = measure(device, variants[i], s, a, b, c);
+			if(t < best_time){
+				best = i;
+				best_time = t;
+			}
+		}
+		return best;
+	}
+
+	/// @return variant index stored in the tuning cache, variants.size() if the value is not usable
+	auto parseVariant(const std::string& value)-> size_t {
+		const auto& variants = vuh::detail::gemm_variants();
+		try {
+			return std::min(size_t(std::stoul(value)), variants.size());
+		} catch(std::exception&){
+			return variants.size();
+		}
+	}
+} // namespace
+
+namespace vuh {
+namespace detail {
+	/// @return tiling variants of the gemm kernel the tuning chooses from.
+	/// Indices are stored in the tuning cache, so new variants go to the end.
+	auto gemm_variants()-> const std::vector<GemmVariant>& {
+		static const auto variants = std::vector<GemmVariant>{
+			{ 8,  8,  8, 1, 1}, //  8 x  8 tile, fits any device
+			{16, 16, 16, 1, 1}, // 16 x 16
+			{16, 16, 16, 2, 2}, // 32 x 32
+			{16, 16,  8, 4, 4}, // 64 x 64
+			{16, 16, 16, 4, 4}, // 64 x 64, deeper k tile
+			{16,  8,  8, 8, 4}, // 64 x 64 on 128 invocations
+			{16, 16,  8, 8, 8}, // 128 x 128
+		};
+		return variants;
+	}
+
+	/// @return tiling variant for the m x n result on the device.
+	/// The fastest variant is chosen for each size class of the result by timing all variants
+	/// fitting the device on a representative problem. The choice is cached in the device and in
+	/// the file vuh_gemm_tuning.txt of DiskCache::defaultDir(), so tuning runs once per device,
+	/// driver version and size class.
+	auto gemm_variant(vuh::Device& device, uint32_t m, uint32_t n)-> const GemmVariant& {
+		const auto& variants = gemm_variants();
+		const auto size_class = sizeClass(m, n);
+		const auto key = "gemm:" + std::to_string(size_class);
+		const auto id = device.cached<size_t>("alg:" + key, [&]{
+			auto cache = DiskCache(DiskCache::defaultDir() + "/vuh_gemm_tuning.txt");
+			const auto disk_key = key + ":" + DiskCache::deviceKey(device.phys());
+			if(const auto value = cache.get(disk_key)){
+				const auto id = parseVariant(*value);
+				if(id < variants.size() && fits(device, variants[id])){
+					return std::make_unique<size_t>(id);
+				}
+			}
+			const auto id = tune(device, size_class);
+			cache.set(disk_key, std::to_string(id));
+			return std::make_unique<size_t>(id);
+		});
+		return variants[id];
+	}
+
+	/// Record the multiply of batch_count matrices C_i = alpha*A_i*B_i + beta*C_i.
+	/// Workgroups cover the tiles of C in x (columns) and y (rows) and the batch matrices in z,
+	/// the batch is split in several dispatches if it exceeds the device limit.
+	auto record_gemm(Batch& batch, vuh::Device& device, const GemmVariant& variant
+	                 , uint32_t m, uint32_t n, uint32_t k, float alpha, const GemmOperand& a
+	                 , const GemmOperand& b, float beta, const GemmOperand& c
+	                 , uint32_t batch_count)-> void
+	{
+		if(m == 0 || n == 0 || batch_count == 0){
+			return;
+		}
+		const auto& kern = kernel(device, KernelId::GemmF32, 3, sizeof(GemmPush)
+		                          , {variant.group_x, variant.group_y, variant.tile_k, variant.rows, variant.cols});
+		// bytes spanned by the batch of rows x cols matrices, at least one element
+		auto extent = [&](const GemmOperand& x, uint32_t rows, uint32_t cols){
+			const auto last = size_t(batch_count - 1)*x.stride + size_t(std::max(rows, 1u) - 1)*x.ld;
+			return (last + std::max(cols, 1u))*sizeof(float);
+		};
+		const auto ba = binding(device, a.buffer, a.offset_bytes, extent(a, m, k), sizeof(float));
+		const auto bb = binding(device, b.buffer, b.offset_bytes, extent(b, k, n), sizeof(float));
+		const auto bc = binding(device, c.buffer, c.offset_bytes, extent(c, m, n), sizeof(float));
+		auto push = GemmPush{m, n, k, a.ld, b.ld, c.ld, ba.offset, bb.offset, bc.offset
+		                     , a.stride, b.stride, c.stride, 0, alpha, beta};
+		const auto tile_m = variant.group_y*variant.rows;
+		const auto tile_n = variant.group_x*variant.cols;
+		const auto& limits = device.limits();
+		assert((n + tile_n - 1)/tile_n <= limits.maxComputeWorkGroupCount[0]);
+		assert((m + tile_m - 1)/tile_m <= limits.maxComputeWorkGroupCount[1]);
+		const auto max_layers = limits.maxComputeWorkGroupCount[2];
+		for(uint32_t first = 0; first < batch_count; first += std::min(max_layers, batch_count - first)){
+			push.first_batch = first;
+			batch.dispatch(kern, {ba.info, bb.info, bc.info}, &push, (n + tile_n - 1)/tile_n
+			               , (m + tile_m - 1)/tile_m, std::min(max_layers, batch_count - first));
+		}
+	}
+} // namespace detail
+} // namespace vuh
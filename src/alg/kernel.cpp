@@ -0,0 +1,288 @@
+#include <vuh/alg/kernel.h>
+#include <vuh/error.h>
+#include <vuh/instance.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <string>
+
+namespace {
+	/// @return true if the device runs subgroup arithmetic operations in compute shaders.
+	/// Needs Vulkan 1.1 on the loader, device and instance (application info) sides.
+	auto querySubgroupArithmetic(vuh::Device& device)-> bool {
+		const auto version = std::min(device.instance().apiVersion(), device.properties().apiVersion);
+		if(version < VK_API_VERSION_1_1 || vuh::Instance::getInstanceVersion() < VK_API_VERSION_1_1){
+			return false;
+		}
+		auto subgroup = vk::PhysicalDeviceSubgroupProperties{};
+		auto props = vk::PhysicalDeviceProperties2{};
+		props.pNext = &subgroup;
+		device.phys().getProperties2(&props);
+		const auto ops = vk::SubgroupFeatureFlagBits::eBasic | vk::SubgroupFeatureFlagBits::eArithmetic;
+		return bool(subgroup.supportedStages & vk::ShaderStageFlagBits::eCompute)
+		       && (subgroup.supportedOperations & ops) == ops;
+	}
+
+	/// @return cache key suffix made of the kernel interface and specialization constants
+	auto interfaceKey(uint32_t n_buffers, uint32_t push_bytes, const std::vector<uint32_t>& specs
+	                  )-> std::string
+	{
+		auto r = ":" + std::to_string(n_buffers) + ":" + std::to_string(push_bytes);
+		for(auto s: specs){
+			r += ":" + std::to_string(s);
+		}
+		return r;
+	}
+} // namespace
+
+namespace vuh {
+namespace detail {
+	/// Create the compute pipeline from SPIR-V code.
+	Kernel::Kernel(vuh::Device& device, SpirvCode code, uint32_t n_buffers, uint32_t push_bytes
+	               , const std::vector<uint32_t>& specs)
+	   : _device(device), _n_buffers(n_buffers), _push_bytes(push_bytes)
+	{
+		try {
+			_shader = device.createShaderModule({{}, code.size_bytes, code.code});
+			auto bindings = std::vector<vk::DescriptorSetLayoutBinding>{};
+			for(uint32_t i = 0; i < n_buffers; ++i){
+				bindings.emplace_back(i, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute);
+			}
+			_dsclayout = device.createDescriptorSetLayout({{}, uint32_t(bindings.size()), bindings.data()});
+			const auto push_range = vk::PushConstantRange(vk::ShaderStageFlagBits::eCompute, 0, push_bytes);
+			_pipelayout = device.createPipelineLayout({{}, 1, &_dsclayout
+			                                           , push_bytes > 0 ? 1u : 0u, &push_range});
+			auto entries = std::vector<vk::SpecializationMapEntry>{};
+			for(uint32_t i = 0; i < specs.size(); ++i){
+				entries.emplace_back(i, uint32_t(i*sizeof(uint32_t)), sizeof(uint32_t));
+			}
+			const auto spec_info = vk::SpecializationInfo(uint32_t(entries.size()), entries.data()
+			                                              , specs.size()*sizeof(uint32_t), specs.data());
+			const auto stage = vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute
+			                                                     , _shader, "main", &spec_info);
+			_pipeline = device.createPipeline(_pipelayout, nullptr, stage);
+		} catch(std::exception&){
+			release();
+			throw;
+		}
+	}
+
+	/// Destroy the pipeline and associated objects.
+	Kernel::~Kernel() noexcept {
+		release();
+	}
+
+	/// Release resources. Destroying null handles is a noop.
+	auto Kernel::release() noexcept-> void {
+		_device.destroyPipeline(_pipeline);
+		_device.destroyPipelineLayout(_pipelayout);
+		_device.destroyDescriptorSetLayout(_dsclayout);
+		_device.destroyShaderModule(_shader);
+	}
+
+	/// @return true if subgroup variants of the bundled kernels can run on the device.
+	/// The capability is queried once per device.
+	auto hasSubgroupArithmetic(vuh::Device& device)-> bool {
+		return device.cached<bool>("alg:subgroup", [&]{
+			return std::make_unique<bool>(querySubgroupArithmetic(device));
+		});
+	}
+
+	/// @return bundled kernel compiled for the device with given specialization constants.
+	/// Subgroup variant is used when the device supports that. Pipelines are cached in the device.
+	auto kernel(vuh::Device& device, KernelId id, uint32_t n_buffers, uint32_t push_bytes
+	            , const std::vector<uint32_t>& specs)-> const Kernel&
+	{
+		const auto subgroup = hasSubgroupArithmetic(device) && spirv(id, true).code != nullptr;
+		const auto key = "alg:" + std::to_string(int(id)) + (subgroup ? ":sg" : "")
+		                 + interfaceKey(n_buffers, push_bytes, specs);
+		return device.cached<Kernel>(key, [&]{
+			return std::make_unique<Kernel>(device, spirv(id, subgroup), n_buffers, push_bytes, specs);
+		});
+	}
+
+	/// @return kernel compiled from the user supplied SPIR-V code, cached in the device.
+	auto kernel(vuh::Device& device, const std::vector<char>& code, uint32_t n_buffers
+	            , uint32_t push_bytes, const std::vector<uint32_t>& specs)-> const Kernel&
+	{
+		const auto key = "alg:custom:" + std::string(code.begin(), code.end())
+		                 + interfaceKey(n_buffers, push_bytes, specs);
+		return device.cached<Kernel>(key, [&]{
+			const auto spv = SpirvCode{reinterpret_cast<const uint32_t*>(code.data()), code.size()};
+			return std::make_unique<Kernel>(device, spv, n_buffers, push_bytes, specs);
+		});
+	}
+
+	/// @return binding of the buffer range.
+	/// @pre size_bytes > 0, offset of the range should be a multiple of the element size.
+	/// @throws vuh::BufferRangeExceeded if the range is larger than maxStorageBufferRange
+	auto binding(const vuh::Device& device, vk::Buffer buffer, size_t offset_bytes, size_t size_bytes
+	             , size_t element_bytes)-> Binding
+	{
+		assert(size_bytes > 0 && offset_bytes % element_bytes == 0);
+		const auto alignment = size_t(device.limits().minStorageBufferOffsetAlignment);
+		const auto base = alignment > 0 ? offset_bytes/alignment*alignment : offset_bytes;
+		assert((offset_bytes - base) % element_bytes == 0);
+		const auto range = offset_bytes + size_bytes - base;
+		if(range > device.limits().maxStorageBufferRange){
+			throw BufferRangeExceeded("range of " + std::to_string(range) + " bytes exceeds maxStorageBufferRange");
+		}
+		return {{buffer, base, range}, uint32_t((offset_bytes - base)/element_bytes)};
+	}
+
+	/// Check that the device supports 64-bit types used by the kernel.
+	/// @throws vuh::DeviceFeatureMissing
+	auto requireFeatures(const vuh::Device& device, bool int64, bool float64)-> void {
+		if(int64 && !device.features().shaderInt64){
+			throw DeviceFeatureMissing("device does not support shaderInt64");
+		}
+		if(float64 && !device.features().shaderFloat64){
+			throw DeviceFeatureMissing("device does not support shaderFloat64");
+		}
+	}
+
+	/// Check that the number of elements fits the 32-bit counts the kernels take in push constants.
+	/// @throws vuh::BufferRangeExceeded
+	auto requireCount(const char* algorithm, size_t n)-> void {
+		if(n > std::numeric_limits<uint32_t>::max()){
+			throw BufferRangeExceeded(std::string(algorithm) + " of " + std::to_string(n)
+			                          + " elements exceeds the limit of 2^32 - 1 elements");
+		}
+	}
+
+	/// Check that the range of available elements has room for n elements written by the kernel.
+	/// @throws vuh::BufferRangeExceeded
+	auto requireRoom(const char* algorithm, const char* what, size_t available, size_t n)-> void {
+		if(n > available){
+			throw BufferRangeExceeded(std::string(algorithm) + " writes " + std::to_string(n) + " elements to "
+			                          + what + " with room for " + std::to_string(available));
+		}
+	}
+
+	/// Check that the arrays of the operation are allocated on the same device.
+	/// @throws vuh::DeviceMismatch
+	auto requireSameDevice(const char* algorithm, const vuh::Device& a, const vuh::Device& b)-> void {
+		if(a != b){
+			throw DeviceMismatch(std::string(algorithm) + " needs all arrays on the same device");
+		}
+	}
+
+	/// Command buffer of the batch with the descriptor pools and resources it uses.
+	struct Batch::Impl {
+		vuh::Device& device;
+		vk::CommandBuffer cmd_buf;
+		std::vector<vk::DescriptorPool> pools;          ///< one pool per dispatch
+		std::vector<std::shared_ptr<void>> resources;   ///< kept alive till the batch is destroyed
+		bool empty = true;                              ///< no commands recorded yet
+
+		/// Allocate and begin the command buffer.
+		explicit Impl(vuh::Device& device)
+		   : device(device)
+		   , cmd_buf(device.allocateCommandBuffers({device.computeCmdPool()
+		                                           , vk::CommandBufferLevel::ePrimary, 1})[0])
+		{
+			cmd_buf.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+		}
+
+		~Impl() noexcept {
+			device.freeCommandBuffers(device.computeCmdPool(), 1, &cmd_buf);
+			for(auto p: pools){
+				device.destroyDescriptorPool(p);
+			}
+		}
+
+		/// Make results of the previous commands visible to the next one.
+		auto barrier()-> void {
+			if(!empty){
+				const auto stages = vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer;
+				const auto mem = vk::MemoryBarrier(vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite
+				                                   , vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+				                                   | vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite);
+				cmd_buf.pipelineBarrier(stages, stages, {}, {mem}, {}, {});
+			}
+			empty = false;
+		}
+	}; // struct Batch::Impl
+
+	/// Constructor. Allocates the command buffer in the compute pool of the device.
+	Batch::Batch(vuh::Device& device): _impl(std::make_unique<Impl>(device)) {}
+
+	Batch::Batch(Batch&&) noexcept = default;
+	auto Batch::operator=(Batch&&) noexcept-> Batch& = default;
+
+	/// Destructor. Releases the command buffer and descriptors.
+	/// @pre submitted batch should be complete.
+	Batch::~Batch() noexcept = default;
+
+	/// Record the dispatch of groups_x*groups_y*groups_z workgroups of the kernel.
+	/// Buffers are bound in the order of bindings, push points to kernel.pushBytes() of push constants.
+	auto Batch::dispatch(const Kernel& kernel, std::initializer_list<vk::DescriptorBufferInfo> buffers
+	                     , const void* push, uint32_t groups_x, uint32_t groups_y, uint32_t groups_z)-> void
+	{
+		assert(_impl && buffers.size() == kernel.buffers());
+		auto& impl = *_impl;
+		const auto pool_size = vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, kernel.buffers());
+		impl.pools.reserve(impl.pools.size() + 1);
+		impl.pools.push_back(impl.device.createDescriptorPool({{}, 1, 1, &pool_size}));
+		const auto layout = kernel.descriptorLayout();
+		const auto dscset = impl.device.allocateDescriptorSets({impl.pools.back(), 1, &layout})[0];
+		auto writes = std::vector<vk::WriteDescriptorSet>{};
+		for(const auto& b: buffers){
+			writes.emplace_back(dscset, uint32_t(writes.size()), 0, 1, vk::DescriptorType::eStorageBuffer
+			                    , nullptr, &b, nullptr);
+		}
+		impl.device.updateDescriptorSets(writes, {});
+
+		impl.barrier();
+		impl.cmd_buf.bindPipeline(vk::PipelineBindPoint::eCompute, kernel.pipeline());
+		impl.cmd_buf.bindDescriptorSets(vk::PipelineBindPoint::eCompute, kernel.layout(), 0, {dscset}, {});
+		if(kernel.pushBytes() > 0){
+			impl.cmd_buf.pushConstants(kernel.layout(), vk::ShaderStageFlagBits::eCompute, 0
+			                           , kernel.pushBytes(), push);
+		}
+		impl.cmd_buf.dispatch(groups_x, groups_y, groups_z);
+	}
+
+	/// Record the fill of the buffer range with the repeated 32-bit pattern.
+	/// @pre offset_bytes and size_bytes should be multiples of 4
+	auto Batch::fill(vk::Buffer buffer, size_t offset_bytes, size_t size_bytes, uint32_t pattern)-> void {
+		assert(_impl && offset_bytes % 4 == 0 && size_bytes % 4 == 0);
+		_impl->barrier();
+		_impl->cmd_buf.fillBuffer(buffer, offset_bytes, size_bytes, pattern);
+	}
+
+	/// Record the copy between buffer ranges.
+	auto Batch::copy(vk::Buffer src, size_t src_offset, vk::Buffer dst, size_t dst_offset
+	                 , size_t size_bytes)-> void
+	{
+		assert(_impl);
+		_impl->barrier();
+		const auto region = vk::BufferCopy(src_offset, dst_offset, size_bytes);
+		_impl->cmd_buf.copyBuffer(src, dst, 1, &region);
+	}
+
+	/// Keep the resource (e.g. scratch array) alive till the batch is destroyed.
+	auto Batch::keep(std::shared_ptr<void> resource)-> void {
+		assert(_impl);
+		_impl->resources.push_back(std::move(resource));
+	}
+
+	/// Submit recorded commands to the compute queue.
+	/// Device writes are made available to host reads of the mapped memory on completion.
+	/// @return fence signalled when the batch completes. Ownership passes to the caller.
+	auto Batch::submit()-> vk::Fence {
+		assert(_impl);
+		auto& impl = *_impl;
+		const auto mem = vk::MemoryBarrier(vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite
+		                                   , vk::AccessFlagBits::eHostRead);
+		impl.cmd_buf.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer
+		                             , vk::PipelineStageFlagBits::eHost, {}, {mem}, {}, {});
+		impl.cmd_buf.end();
+		auto fence = impl.device.createFence(vk::FenceCreateInfo());
+		const auto submit_info = vk::SubmitInfo(0, nullptr, nullptr, 1, &impl.cmd_buf);
+		impl.device.computeQueue().submit({submit_info}, fence);
+		return fence;
+	}
+} // namespace detail
+} // namespace vuh
@@ -0,0 +1,61 @@
+#include <vuh/alg/kernel.h>
+
+#include <cstdint>
+
+// SPIR-V of the bundled kernels embedded at build time, see src/CMakeLists.txt
+#include "reduce_f32.h"
+#include "reduce_f32_sg.h"
+#include "reduce_i32.h"
+#include "reduce_i32_sg.h"
+#include "reduce_u32.h"
+#include "reduce_u32_sg.h"
+#include "scan_f32.h"
+#include "scan_f32_sg.h"
+#include "scan_i32.h"
+#include "scan_i32_sg.h"
+#include "scan_u32.h"
+#include "scan_u32_sg.h"
+#include "scan_f64.h"
+#include "scan_i64.h"
+#include "scan_u64.h"
+#include "radix_u32.h"
+#include "compact_f32.h"
+#include "compact_i32.h"
+#include "compact_u32.h"
+#include "histogram_f32.h"
+#include "histogram_i32.h"
+#include "histogram_u32.h"
+#include "gemm_f32.h"
+
+#define VUH_SPIRV(name) vuh::detail::SpirvCode{name, sizeof(name)}
+#define VUH_SPIRV_SG(name) (subgroup ? VUH_SPIRV(name##_sg) : VUH_SPIRV(name))
+#define VUH_SPIRV_NOSG(name) (subgroup ? vuh::detail::SpirvCode{nullptr, 0} : VUH_SPIRV(name))
+
+namespace vuh {
+namespace detail {
+	/// @return SPIR-V code of the bundled kernel, shared memory or subgroup variant.
+	/// Code pointer is null if the kernel has no such variant.
+	auto spirv(KernelId id, bool subgroup)-> SpirvCode {
+		switch(id){
+		case KernelId::ReduceF32:    return VUH_SPIRV_SG(vuh_reduce_f32);
+		case KernelId::ReduceI32:    return VUH_SPIRV_SG(vuh_reduce_i32);
+		case KernelId::ReduceU32:    return VUH_SPIRV_SG(vuh_reduce_u32);
+		case KernelId::ScanF32:      return VUH_SPIRV_SG(vuh_scan_f32);
+		case KernelId::ScanI32:      return VUH_SPIRV_SG(vuh_scan_i32);
+		case KernelId::ScanU32:      return VUH_SPIRV_SG(vuh_scan_u32);
+		case KernelId::ScanF64:      return VUH_SPIRV_NOSG(vuh_scan_f64);
+		case KernelId::ScanI64:      return VUH_SPIRV_NOSG(vuh_scan_i64);
+		case KernelId::ScanU64:      return VUH_SPIRV_NOSG(vuh_scan_u64);
+		case KernelId::Radix:        return VUH_SPIRV_NOSG(vuh_radix_u32);
+		case KernelId::CompactF32:   return VUH_SPIRV_NOSG(vuh_compact_f32);
+		case KernelId::CompactI32:   return VUH_SPIRV_NOSG(vuh_compact_i32);
+		case KernelId::CompactU32:   return VUH_SPIRV_NOSG(vuh_compact_u32);
+		case KernelId::HistogramF32: return VUH_SPIRV_NOSG(vuh_histogram_f32);
+		case KernelId::HistogramI32: return VUH_SPIRV_NOSG(vuh_histogram_i32);
+		case KernelId::HistogramU32: return VUH_SPIRV_NOSG(vuh_histogram_u32);
+		case KernelId::GemmF32:      return VUH_SPIRV_NOSG(vuh_gemm_f32);
+		}
+		return {nullptr, 0};
+	}
+} // namespace detail
+} // namespace vuh
@@ -0,0 +1,89 @@
+#include <vuh/cache.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace vuh {
+	/// Constructor. Loads the cached values from the file if it exists.
+	DiskCache::DiskCache(std::string path): _path(std::move(path)) {
+		auto in = std::ifstream(_path);
+		auto line = std::string{};
+		while(std::getline(in, line)){
+			const auto tab = line.find('\t');
+			if(tab != std::string::npos){
+				_values[line.substr(0, tab)] = line.substr(tab + 1);
+			}
+		}
+	}
+
+	/// @return cached value for the key, empty if there is none
+	auto DiskCache::get(const std::string& key) const-> std::optional<std::string> {
+		auto lock = std::lock_guard<std::mutex>(_mutex);
+		const auto it = _values.find(key);
+		if(it == _values.end()){
+			return std::nullopt;
+		}
+		return it->second;
+	}
+
+	/// Set the value for the key and write the cache to file.
+	/// The file is written to a temporary first and then renamed, so that concurrent
+	/// processes never see a partially written cache.
+	/// Keys and values should not contain tabs or newlines.
+	auto DiskCache::set(const std::string& key, const std::string& value)-> void {
+		auto lock = std::lock_guard<std::mutex>(_mutex);
+		_values[key] = value;
+		const auto tmp = _path + ".tmp";
+		{
+			auto out = std::ofstream(tmp, std::ios::trunc);
+			for(const auto& kv: _values){
+				out << kv.first << '\t' << kv.second << '\n';
+			}
+			if(!out){
+				std::remove(tmp.c_str());
+				return;
+			}
+		}
+		if(std::rename(tmp.c_str(), _path.c_str()) != 0){
+			std::remove(tmp.c_str());
+		}
+	}
+
+	/// @return directory for the cache files: $VUH_CACHE_DIR if set, otherwise
+	/// $XDG_CACHE_HOME or $HOME/.cache (%LOCALAPPDATA% on Windows), current directory as
+	/// the last resort. The directory is not created.
+	auto DiskCache::defaultDir()-> std::string {
+		if(const auto dir = std::getenv("VUH_CACHE_DIR")){
+			return dir;
+		}
+#ifdef _WIN32
+		if(const auto dir = std::getenv("LOCALAPPDATA")){
+			return dir;
+		}
+#else
+		if(const auto dir = std::getenv("XDG_CACHE_HOME")){
+			return dir;
+		}
+		if(const auto home = std::getenv("HOME")){
+			return std::string(home) + "/.cache";
+		}
+#endif
+		return ".";
+	}
+
+	/// @return key identifying the physical device together with its driver, so that
+	/// the values measured with one driver version are not reused with another.
+	auto DiskCache::deviceKey(vk::PhysicalDevice physdevice)-> std::string {
+		const auto props = physdevice.getProperties();
+		auto s = std::ostringstream{};
+		s << std::hex << std::setfill('0') << std::setw(4) << props.vendorID << ':'
+		  << std::setw(4) << props.deviceID << ':' << props.driverVersion << ':';
+		for(auto b: props.pipelineCacheUUID){
+			s << std::setw(2) << uint32_t(b);
+		}
+		return s.str();
+	}
+} // namespace vuh
@@ -1,9 +1,16 @@
 #include <vuh/device.h>
+#include <vuh/error.h>
+#include <vuh/instance.h>
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
 namespace {
 
@@ -145,6 +152,40 @@ namespace {
 } // namespace
 
 namespace vuh {
+	/// Immutable physical device data. Queried once at Device construction.
+	struct Device::PhysicalInfo {
+		vk::PhysicalDeviceProperties properties;            ///< properties incl. limits
+		vk::PhysicalDeviceMemoryProperties memory;          ///< memory types and heaps
+		vk::PhysicalDeviceFeatures features;                ///< supported features
+		std::vector<vk::QueueFamilyProperties> families;    ///< queue families
+		std::vector<vk::ExtensionProperties> extensions;    ///< supported device extensions
+
+		explicit PhysicalInfo(vk::PhysicalDevice physdev)
+		   : properties(physdev.getProperties())
+		   , memory(physdev.getMemoryProperties())
+		   , features(physdev.getFeatures())
+		   , families(physdev.getQueueFamilyProperties())
+		   , extensions(physdev.enumerateDeviceExtensionProperties())
+		{}
+	}; // struct Device::PhysicalInfo
+
+	/// Per-heap accounting of the device memory allocated through the Device.
+	/// Also memoizes memory type selection.
+	struct Device::MemoryAccount {
+		std::mutex mutex;                                 ///< guards the counters and the selection cache
+		std::vector<HeapUsage> heaps;                     ///< vuh-side counters and budgets per heap
+		std::unordered_map<VkDeviceMemory, std::pair<uint32_t, vk::DeviceSize>> allocations; ///< heap id and size of live allocations
+		std::unordered_map<uint64_t, uint32_t> selected;  ///< (memory type bits, property flags) -> selected memory type id
+
+		explicit MemoryAccount(const vk::PhysicalDeviceMemoryProperties& memory)
+		   : heaps(memory.memoryHeapCount)
+		{
+			for(uint32_t i = 0; i < memory.memoryHeapCount; ++i){
+				heaps[i].size_bytes = memory.memoryHeaps[i].size;
+			}
+		}
+	}; // struct Device::MemoryAccount
+
 	/// Constructs logical device wrapping the physical device of the given instance.
 	Device::Device(Instance& instance, vk::PhysicalDevice physical_device
                    , const std::vector<const char *> &layers, const std::vector<const char *> &extensions)
@@ -177,6 +218,15 @@ namespace vuh {
         vk::defaultDispatchLoaderDynamic.init(*this);
 #endif
 		try {
+			_info = std::make_shared<const PhysicalInfo>(physdevice);
+			_memaccount = std::make_unique<MemoryAccount>(_info->memory);
+			_cache = std::make_unique<ObjectCache>();
+			_cmp_timestamp_bits = _info->families.at(_cmp_family_id).timestampValidBits;
+			// queries can only be reset on compute or graphics capable queues
+			const auto& tfr_family = _info->families.at(_tfr_family_id);
+			_tfr_timestamp_bits = (tfr_family.queueFlags & (vk::QueueFlagBits::eCompute | vk::QueueFlagBits::eGraphics))
+			                      ? tfr_family.timestampValidBits : 0u;
+			_timestamp_period = _info->properties.limits.timestampPeriod;
 			_cmdpool_compute = createCommandPool({vk::CommandPoolCreateFlagBits::eResetCommandBuffer
 			                                     , computeFamilyId});
 			_cmdbuf_compute = allocCmdBuffer(*this, _cmdpool_compute);
@@ -188,7 +238,7 @@ namespace vuh {
 				                 {vk::CommandPoolCreateFlagBits::eResetCommandBuffer, _tfr_family_id});
 				_cmdbuf_transfer = allocCmdBuffer(*this, _cmdpool_transfer);
 			}
-		} catch(vk::Error&) {
+		} catch(std::exception&) {
 			release(); // because vk::Device does not know how to clean after itself
 			throw;
 		}
@@ -196,6 +246,7 @@ namespace vuh {
 
 	/// release resources associated with device
 	auto Device::release() noexcept-> void {
+		clearCache();
 		if(static_cast<vk::Device&>(*this)){
 			if(_tfr_family_id != _cmp_family_id){
 				freeCommandBuffers(_cmdpool_transfer, 1, &_cmdbuf_transfer);
@@ -239,6 +290,13 @@ namespace vuh {
 	   , _cmdbuf_transfer(other._cmdbuf_transfer)
 	   , _cmp_family_id(other._cmp_family_id)
 	   , _tfr_family_id(other._tfr_family_id)
+	   , _cmp_timestamp_bits(other._cmp_timestamp_bits)
+	   , _tfr_timestamp_bits(other._tfr_timestamp_bits)
+	   , _timestamp_period(other._timestamp_period)
+	   , _profiling(other._profiling)
+	   , _info(other._info)
+	   , _memaccount(std::move(other._memaccount))
+	   , _cache(std::move(other._cache))
 	{
 #if VULKAN_HPP_DISPATCH_LOADER_DYNAMIC == 1
         vk::defaultDispatchLoaderDynamic.init(*this);
@@ -266,16 +324,62 @@ namespace vuh {
 		swap(d1._cmdbuf_transfer , d2._cmdbuf_transfer );
 		swap(d1._cmp_family_id   , d2._cmp_family_id   );
 		swap(d1._tfr_family_id   , d2._tfr_family_id   );
+		swap(d1._cmp_timestamp_bits, d2._cmp_timestamp_bits);
+		swap(d1._tfr_timestamp_bits, d2._tfr_timestamp_bits);
+		swap(d1._timestamp_period, d2._timestamp_period);
+		swap(d1._profiling       , d2._profiling       );
+		swap(d1._info            , d2._info            );
+		swap(d1._memaccount      , d2._memaccount      );
+		swap(d1._cache           , d2._cache           );
+	}
+
+	/// Destroy the cached objects.
+	/// Should be called before the device is released, since objects may hold device resources.
+	auto Device::clearCache() noexcept-> void {
+		if(_cache){
+			auto lock = std::lock_guard<std::mutex>(_cache->mutex);
+			_cache->objects.clear();
+		}
 	}
 
 	/// @return physical device properties
-	auto Device::properties() const-> vk::PhysicalDeviceProperties {
-		return _physdev.getProperties();
+	auto Device::properties() const-> const vk::PhysicalDeviceProperties& {
+		return _info->properties;
+	}
+
+	/// @return physical device limits
+	auto Device::limits() const-> const vk::PhysicalDeviceLimits& {
+		return _info->properties.limits;
+	}
+
+	/// @return features supported by the physical device
+	auto Device::features() const-> const vk::PhysicalDeviceFeatures& {
+		return _info->features;
+	}
+
+	/// @return properties of the physical device queue families
+	auto Device::queueFamilies() const-> const std::vector<vk::QueueFamilyProperties>& {
+		return _info->families;
+	}
+
+	/// @return extensions supported by the physical device
+	auto Device::extensions() const-> const std::vector<vk::ExtensionProperties>& {
+		return _info->extensions;
+	}
+
+	/// @return true if the extension is supported by the physical device
+	auto Device::hasExtension(const char* name) const-> bool {
+		return contains(name, _info->extensions, [](const auto& e){ return e.extensionName; });
+	}
+
+	/// @return memory types and heaps of the physical device
+	auto Device::memoryProperties() const-> const vk::PhysicalDeviceMemoryProperties& {
+		return _info->memory;
 	}
 
 	/// @return memory properties of the memory with given id
 	auto Device::memoryProperties(uint32_t id) const-> vk::MemoryPropertyFlags {
-		return _physdev.getMemoryProperties().memoryTypes[id].propertyFlags;
+		return _info->memory.memoryTypes[id].propertyFlags;
 	}
 
 	/// Find first memory matching desired properties.
@@ -284,16 +388,43 @@ namespace vuh {
 	auto Device::selectMemory(vk::Buffer buffer, vk::MemoryPropertyFlags properties
 	                          ) const-> uint32_t
 	{
-		auto memProperties = _physdev.getMemoryProperties();
-		auto memoryReqs = getBufferMemoryRequirements(buffer);
+		return selectMemoryType(getBufferMemoryRequirements(buffer).memoryTypeBits, properties);
+	}
+
+	/// Find first memory matching desired properties and suitable for the image.
+	/// Does NOT check for free space availability, only matches the properties.
+	/// @return id of the suitable memory, -1 if no suitable memory found.
+	auto Device::selectMemory(vk::Image image, vk::MemoryPropertyFlags properties
+	                          ) const-> uint32_t
+	{
+		return selectMemoryType(getImageMemoryRequirements(image).memoryTypeBits, properties);
+	}
+
+	/// Find first memory among allowed memory types matching desired properties.
+	/// Results are memoized per (memory_type_bits, properties) pair.
+	/// @return id of the suitable memory, -1 if no suitable memory found.
+	auto Device::selectMemoryType(uint32_t memory_type_bits ///< bitmask of allowed memory types (as in vk::MemoryRequirements)
+	                              , vk::MemoryPropertyFlags properties ///< required memory properties
+	                              ) const-> uint32_t
+	{
+		const auto key = (uint64_t(memory_type_bits) << 32) | uint64_t(VkMemoryPropertyFlags(properties));
+		auto lock = std::lock_guard<std::mutex>(_memaccount->mutex);
+		auto it = _memaccount->selected.find(key);
+		if(it != _memaccount->selected.end()){
+			return it->second;
+		}
+		auto r = uint32_t(-1);
+		const auto& memProperties = _info->memory;
 		for(uint32_t i = 0; i < memProperties.memoryTypeCount; ++i){
-			if( (memoryReqs.memoryTypeBits & (1u << i))
+			if( (memory_type_bits & (1u << i))
 			    && ((properties & memProperties.memoryTypes[i].propertyFlags) == properties))
 			{
-				return i;
+				r = i;
+				break;
 			}
 		}
-		return uint32_t(-1);
+		_memaccount->selected.emplace(key, r);
+		return r;
 	}
 
 	/// @return true if compute queues family is different from that for transfer queues
@@ -301,6 +432,23 @@ namespace vuh {
 		return _cmp_family_id == _tfr_family_id;
 	}
 
+	/// Switch GPU time profiling on or off.
+	/// When on, kernel dispatches and async copies recorded afterwards are bracketed
+	/// by timestamp queries (if supported by the corresponding queue family).
+	/// Measured times are reported by the Delayed objects returned by async calls and
+	/// aggregated per Program.
+	auto Device::enableProfiling(bool enable)-> void {
+		_profiling = enable;
+	}
+
+	/// @return number of valid bits in timestamps written by compute (or transfer) queues.
+	/// 0 means timestamps are not supported by the queue family.
+	auto Device::timestampValidBits(bool transfer ///< if true query the transfer queue family
+	                                ) const-> uint32_t
+	{
+		return transfer ? _tfr_timestamp_bits : _cmp_timestamp_bits;
+	}
+
 	/// @return id of the queue family supporting compute operations
 	auto Device::computeQueue(uint32_t i)-> vk::Queue {
 		return getQueue(_cmp_family_id, i);
@@ -354,9 +502,100 @@ namespace vuh {
 
 	/// Allocate device memory for the buffer in the memory with given id.
 	auto Device::alloc(vk::Buffer buf, uint32_t memory_id)-> vk::DeviceMemory {
-	   auto memoryReqs = getBufferMemoryRequirements(buf);
-	   auto allocInfo = vk::MemoryAllocateInfo(memoryReqs.size, memory_id);
-		return allocateMemory(allocInfo);
+		return allocMemory(memory_id, getBufferMemoryRequirements(buf).size);
+	}
+
+	/// Allocate device memory of the given type and account it to the corresponding heap.
+	/// Memory should be released with releaseMemory().
+	/// @throws vuh::MemoryBudgetExceeded if allocation would exceed the budget set for the heap.
+	/// @throws vk::Error if the driver failed to allocate memory.
+	auto Device::allocMemory(uint32_t memory_id        ///< memory type id
+	                         , vk::DeviceSize size_bytes ///< allocation size
+	                         )-> vk::DeviceMemory
+	{
+		auto& account = *_memaccount;
+		const auto heap_id = _info->memory.memoryTypes[memory_id].heapIndex;
+		auto lock = std::lock_guard<std::mutex>(account.mutex);
+		auto& heap = account.heaps[heap_id];
+		if(heap.budget_bytes && heap.allocated_bytes + size_bytes > heap.budget_bytes){
+			throw MemoryBudgetExceeded("allocation of " + std::to_string(size_bytes)
+			      + " bytes exceeds the budget of memory heap " + std::to_string(heap_id) + " ("
+			      + std::to_string(heap.allocated_bytes) + " of " + std::to_string(heap.budget_bytes)
+			      + " bytes in use)");
+		}
+		auto memory = allocateMemory({size_bytes, memory_id});
+		try{
+			account.allocations.emplace(VkDeviceMemory(memory), std::make_pair(heap_id, size_bytes));
+		} catch(std::exception&){
+			vk::Device::freeMemory(memory);
+			throw;
+		}
+		heap.allocated_bytes += size_bytes;
+		heap.allocation_count += 1;
+		return memory;
+	}
+
+	/// Free device memory allocated with allocMemory() and update the heap counters.
+	auto Device::releaseMemory(vk::DeviceMemory memory) noexcept-> void {
+		if(!memory){
+			return;
+		}
+		if(_memaccount){
+			auto& account = *_memaccount;
+			auto lock = std::lock_guard<std::mutex>(account.mutex);
+			auto it = account.allocations.find(VkDeviceMemory(memory));
+			if(it != account.allocations.end()){
+				auto& heap = account.heaps[it->second.first];
+				heap.allocated_bytes -= it->second.second;
+				heap.allocation_count -= 1;
+				account.allocations.erase(it);
+			}
+		}
+		vk::Device::freeMemory(memory);
+	}
+
+	/// @return number of memory heaps on the device
+	auto Device::heapCount() const-> uint32_t {
+		return _info->memory.memoryHeapCount;
+	}
+
+	/// @return usage summary of the memory heap.
+	/// Driver-side budget and usage are only filled if VK_EXT_memory_budget is supported.
+	auto Device::heapUsage(uint32_t heap_id) const-> HeapUsage {
+		auto r = HeapUsage{};
+		{
+			auto lock = std::lock_guard<std::mutex>(_memaccount->mutex);
+			r = _memaccount->heaps.at(heap_id);
+		}
+		if(hasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)){
+			auto instance = VkInstance(_instance._instance);
+			auto fn = (PFN_vkGetPhysicalDeviceMemoryProperties2)
+			      VULKAN_HPP_DEFAULT_DISPATCHER.vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2");
+			if(!fn){
+				fn = (PFN_vkGetPhysicalDeviceMemoryProperties2)
+				      VULKAN_HPP_DEFAULT_DISPATCHER.vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+			}
+			if(fn){
+				auto budget = VkPhysicalDeviceMemoryBudgetPropertiesEXT{};
+				budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+				auto props = VkPhysicalDeviceMemoryProperties2{};
+				props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+				props.pNext = &budget;
+				fn(VkPhysicalDevice(_physdev), &props);
+				r.driver_budget_bytes = budget.heapBudget[heap_id];
+				r.driver_usage_bytes = budget.heapUsage[heap_id];
+			}
+		}
+		return r;
+	}
+
+	/// Set the hard limit on memory allocated through this device in the given heap.
+	/// Allocations exceeding it throw vuh::MemoryBudgetExceeded. Array allocators do not fall back
+	/// to other memory types on it, so the allocation never spills to another heap.
+	/// Budget of 0 means no limit.
+	auto Device::setMemoryBudget(uint32_t heap_id, vk::DeviceSize budget_bytes)-> void {
+		auto lock = std::lock_guard<std::mutex>(_memaccount->mutex);
+		_memaccount->heaps.at(heap_id).budget_bytes = budget_bytes;
 	}
 
 	/// @return handle to command pool for transfer command buffers
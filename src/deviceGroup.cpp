@@ -0,0 +1,110 @@
+#include "vuh/deviceGroup.h"
+#include "vuh/instance.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace vuh {
+	/// Create the group of all devices available to the instance.
+	DeviceGroup::DeviceGroup(vuh::Instance& instance)
+	   : DeviceGroup(instance, instance.devices())
+	{}
+
+	/// Create the group of logical devices on given physical devices.
+	/// Same physical device may be listed several times.
+	DeviceGroup::DeviceGroup(vuh::Instance& instance, const std::vector<vk::PhysicalDevice>& physdevices)
+	   : _weights(physdevices.size(), physdevices.empty() ? 0. : 1./double(physdevices.size()))
+	{
+		if(physdevices.empty()){
+			throw std::invalid_argument("device group should contain at least one device");
+		}
+		_devices.reserve(physdevices.size()); // devices should never move, arrays refer to them
+		for(auto pd: physdevices){
+			_devices.emplace_back(instance, pd);
+		}
+	}
+
+	/// Set relative device weights. Weights are normalized to sum up to 1.
+	/// @throws std::invalid_argument if number of weights does not match the group size or
+	/// weights are not positive.
+	auto DeviceGroup::setWeights(std::vector<double> weights)-> void {
+		if(weights.size() != _devices.size()){
+			throw std::invalid_argument("number of weights should match number of devices in group");
+		}
+		if(std::any_of(begin(weights), end(weights), [](double w){ return !(w > 0.); })){
+			throw std::invalid_argument("device weights should be positive");
+		}
+		const auto total = std::accumulate(begin(weights), end(weights), 0.);
+		for(auto& w: weights){
+			w /= total;
+		}
+		_weights = std::move(weights);
+	}
+
+	/// Set how fast weights follow the measured throughput.
+	/// 1 replaces the weights by the last measurement, smaller values average over runs.
+	auto DeviceGroup::setSmoothing(double smoothing)-> void {
+		assert(smoothing > 0. && smoothing <= 1.);
+		_smoothing = smoothing;
+	}
+
+	/// Split [0, n_items) to a shard per device proportionally to device weights.
+	/// Shard boundaries are multiples of granule, so some shards may be empty.
+	auto DeviceGroup::split(size_t n_items, size_t granule) const-> std::vector<Shard> {
+		assert(granule > 0);
+		const auto n_granules = (n_items + granule - 1)/granule;
+		auto r = std::vector<Shard>{};
+		r.reserve(_devices.size());
+		auto cumulative = 0.;
+		auto first = size_t(0);
+		for(size_t i = 0; i < _devices.size(); ++i){
+			cumulative += _weights[i];
+			auto last = size_t(std::llround(cumulative*double(n_granules)))*granule;
+			last = (i + 1 == _devices.size()) ? n_items : std::min(std::max(last, first), n_items);
+			r.push_back({i, first, last});
+			first = last;
+		}
+		return r;
+	}
+
+	/// Update device weights from the measured time (seconds) each shard took to complete.
+	/// Throughput of a device is the number of items it processed per second, shards with
+	/// no measurement (empty or zero time) keep their device weight.
+	auto DeviceGroup::updateWeights(const std::vector<Shard>& shards, const std::vector<double>& seconds
+	                                )-> void
+	{
+		assert(shards.size() == seconds.size());
+		auto items = std::vector<double>(_devices.size(), 0.);
+		auto time = std::vector<double>(_devices.size(), 0.);
+		for(size_t i = 0; i < shards.size(); ++i){
+			if(shards[i].size() > 0 && seconds[i] > 0.){
+				items[shards[i].device] += double(shards[i].size());
+				time[shards[i].device] = std::max(time[shards[i].device], seconds[i]);
+			}
+		}
+		auto measured = std::vector<double>(_devices.size(), 0.);
+		auto total_measured = 0.;
+		auto total_weight = 0.;
+		for(size_t d = 0; d < _devices.size(); ++d){
+			if(time[d] > 0.){
+				measured[d] = items[d]/time[d];
+				total_measured += measured[d];
+				total_weight += _weights[d];
+			}
+		}
+		if(total_measured == 0.){
+			return;
+		}
+		// measured devices share the part of the total weight they had before, so that
+		// devices left out of the run keep their relative weight
+		for(size_t d = 0; d < _devices.size(); ++d){
+			if(time[d] > 0.){
+				const auto w = measured[d]/total_measured*total_weight;
+				_weights[d] = (1. - _smoothing)*_weights[d] + _smoothing*w;
+			}
+		}
+	}
+} // namespace vuh
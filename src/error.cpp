@@ -11,6 +11,26 @@ namespace vuh {
 	   : vk::OutOfDeviceMemoryError(message)
 	{}
 
+	/// Constructs the exception object with explanatory string.
+	MemoryBudgetExceeded::MemoryBudgetExceeded(const std::string& message)
+	   : vk::OutOfDeviceMemoryError(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	MemoryBudgetExceeded::MemoryBudgetExceeded(const char* message)
+	   : vk::OutOfDeviceMemoryError(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	NoSuitableDeviceFound::NoSuitableDeviceFound(const std::string& message)
+	   : std::runtime_error(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	NoSuitableDeviceFound::NoSuitableDeviceFound(const char* message)
+	   : std::runtime_error(message)
+	{}
+
 	/// Constructs the exception object with explanatory string.
 	FileReadFailure::FileReadFailure(const std::string& message)
 	   : std::runtime_error(message)
@@ -21,4 +41,64 @@ namespace vuh {
 	   : std::runtime_error(message)
 	{}
 
+	/// Constructs the exception object with explanatory string.
+	FileWriteFailure::FileWriteFailure(const std::string& message)
+	   : std::runtime_error(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	FileWriteFailure::FileWriteFailure(const char* message)
+	   : std::runtime_error(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	ShaderInterfaceMismatch::ShaderInterfaceMismatch(const std::string& message)
+	   : std::logic_error(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	ShaderInterfaceMismatch::ShaderInterfaceMismatch(const char* message)
+	   : std::logic_error(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	BufferRangeExceeded::BufferRangeExceeded(const std::string& message)
+	   : std::length_error(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	BufferRangeExceeded::BufferRangeExceeded(const char* message)
+	   : std::length_error(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	BufferOffsetMisaligned::BufferOffsetMisaligned(const std::string& message)
+	   : std::invalid_argument(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	BufferOffsetMisaligned::BufferOffsetMisaligned(const char* message)
+	   : std::invalid_argument(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	DeviceMismatch::DeviceMismatch(const std::string& message)
+	   : std::invalid_argument(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	DeviceMismatch::DeviceMismatch(const char* message)
+	   : std::invalid_argument(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	DeviceFeatureMissing::DeviceFeatureMissing(const std::string& message)
+	   : std::runtime_error(message)
+	{}
+
+	/// Constructs the exception object with explanatory string.
+	DeviceFeatureMissing::DeviceFeatureMissing(const char* message)
+	   : std::runtime_error(message)
+	{}
+
 } // namespace vuh
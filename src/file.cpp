@@ -0,0 +1,273 @@
+#include <vuh/file.h>
+#include <vuh/error.h>
+#include <vuh/arr/allocDevice.hpp>
+#include <vuh/arr/hostArray.hpp>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#	include <fstream>
+#else
+#	include <fcntl.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace {
+	/// Size of a single staging buffer of the file transfer ring.
+	constexpr auto chunk_bytes = size_t(16) << 20;
+	/// Number of staging buffers in the ring.
+	constexpr auto n_slots = size_t(3);
+
+	/// File opened for positional reads or writes.
+	class FileHandle {
+	public:
+		/// Open file for reading, or for writing (created if not existing, not truncated).
+		FileHandle(const std::string& path, bool write): _path(path) {
+#ifdef _WIN32
+			auto mode = std::ios::binary | (write ? std::ios::in | std::ios::out : std::ios::in);
+			_file.open(path, mode);
+			if(write && !_file.is_open()){ // does not exist yet
+				_file.open(path, std::ios::binary | std::ios::out);
+			}
+			if(!_file.is_open()){
+				fail(write, "could not open file ");
+			}
+#else
+			_fd = write ? ::open(path.c_str(), O_WRONLY | O_CREAT, 0644) : ::open(path.c_str(), O_RDONLY);
+			if(_fd < 0){
+				fail(write, "could not open file ");
+			}
+#endif
+		}
+
+		~FileHandle() noexcept {
+#ifndef _WIN32
+			if(_fd >= 0){
+				::close(_fd);
+			}
+#endif
+		}
+
+		FileHandle(const FileHandle&) = delete;
+		auto operator=(const FileHandle&)-> FileHandle& = delete;
+
+		/// @return file size (bytes)
+		auto size()-> size_t {
+#ifdef _WIN32
+			_file.seekg(0, std::ios::end);
+			return size_t(_file.tellg());
+#else
+			struct stat st;
+			if(::fstat(_fd, &st) != 0){
+				fail(false, "could not stat file ");
+			}
+			return size_t(st.st_size);
+#endif
+		}
+
+		/// Read exactly size_bytes at given offset.
+		/// @throws vuh::FileReadFailure
+		auto read_at(void* dst, size_t size_bytes, size_t offset)-> void {
+#ifdef _WIN32
+			_file.seekg(std::streamoff(offset));
+			if(!_file.read(static_cast<char*>(dst), std::streamsize(size_bytes))){
+				fail(false, "failed reading file ");
+			}
+#else
+			auto p = static_cast<char*>(dst);
+			while(size_bytes > 0){
+				const auto r = ::pread(_fd, p, size_bytes, off_t(offset));
+				if(r <= 0){
+					fail(false, "failed reading file ");
+				}
+				p += r; offset += size_t(r); size_bytes -= size_t(r);
+			}
+#endif
+		}
+
+		/// Write size_bytes at given offset.
+		/// @throws vuh::FileWriteFailure
+		auto write_at(const void* src, size_t size_bytes, size_t offset)-> void {
+#ifdef _WIN32
+			_file.seekp(std::streamoff(offset));
+			if(!_file.write(static_cast<const char*>(src), std::streamsize(size_bytes))){
+				fail(true, "failed writing file ");
+			}
+#else
+			auto p = static_cast<const char*>(src);
+			while(size_bytes > 0){
+				const auto r = ::pwrite(_fd, p, size_bytes, off_t(offset));
+				if(r <= 0){
+					fail(true, "failed writing file ");
+				}
+				p += r; offset += size_t(r); size_bytes -= size_t(r);
+			}
+#endif
+		}
+	private:
+		[[noreturn]] auto fail(bool write, const char* what) const-> void {
+			if(write){
+				throw vuh::FileWriteFailure(what + _path);
+			}
+			throw vuh::FileReadFailure(what + _path);
+		}
+	private: // data
+		std::string _path;
+#ifdef _WIN32
+		std::fstream _file;
+#else
+		int _fd = -1;
+#endif
+	}; // class FileHandle
+} // namespace
+
+namespace vuh {
+namespace detail {
+	/// Staging ring. Slot i holds the staging buffer, the command buffer recording the transfer
+	/// of that buffer and the fence signalled when the transfer completes.
+	struct FileStage::Impl {
+		using Stage = arr::HostArray<char, arr::AllocDevice<arr::properties::HostCoherent>>;
+
+		struct Slot {
+			Stage stage;
+			vk::CommandBuffer cmd_buf;
+			vk::Fence fence;       ///< null if slot was not submitted or fence was handed over
+		};
+
+		vuh::Device& device;
+		std::vector<Slot> slots;
+
+		/// Allocate the ring with slots of given size.
+		Impl(vuh::Device& device, size_t n, size_t slot_bytes): device(device) {
+			if(n == 0){
+				return;
+			}
+			const auto cmd_bufs = device.allocateCommandBuffers({device.transferCmdPool()
+			                                                   , vk::CommandBufferLevel::ePrimary
+			                                                   , uint32_t(n)});
+			slots.reserve(n);
+			try{
+				for(size_t i = 0; i < n; ++i){
+					slots.push_back({Stage(device, slot_bytes), cmd_bufs[i], nullptr});
+				}
+			} catch(std::exception&){
+				device.freeCommandBuffers(device.transferCmdPool(), cmd_bufs);
+				throw;
+			}
+		}
+
+		~Impl() noexcept {
+			for(auto& s: slots){
+				wait(s);
+				device.freeCommandBuffers(device.transferCmdPool(), 1, &s.cmd_buf);
+			}
+		}
+
+		/// Wait for the slot transfer to complete and release its fence.
+		auto wait(Slot& s) noexcept-> void {
+			if(s.fence){
+				(void)device.waitForFences({s.fence}, true, uint64_t(-1));
+				device.destroyFence(s.fence);
+				s.fence = nullptr;
+			}
+		}
+
+		/// Record and submit the copy between buffers. Fence of the slot is signalled on completion.
+		auto submit(Slot& s, vk::Buffer src, size_t src_offset, vk::Buffer dst, size_t dst_offset
+		            , size_t size_bytes)-> void
+		{
+			s.cmd_buf.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+			auto region = vk::BufferCopy(src_offset, dst_offset, size_bytes);
+			s.cmd_buf.copyBuffer(src, dst, 1, &region);
+			s.cmd_buf.end();
+			s.fence = device.createFence(vk::FenceCreateInfo());
+			auto submit_info = vk::SubmitInfo(0, nullptr, nullptr, 1, &s.cmd_buf);
+			device.transferQueue().submit({submit_info}, s.fence);
+		}
+	}; // struct FileStage::Impl
+
+	/// Constructor. Staging resources are allocated on the first transfer.
+	FileStage::FileStage(vuh::Device& device)
+	   : _impl(std::make_unique<Impl>(device, 0, 0))
+	{}
+
+	FileStage::FileStage(FileStage&&) noexcept = default;
+	auto FileStage::operator=(FileStage&&) noexcept-> FileStage& = default;
+
+	/// Destructor. Waits for the outstanding transfers and releases the staging ring.
+	FileStage::~FileStage() noexcept = default;
+
+	/// Read the file range chunk by chunk to the staging ring and submit transfers of the chunks
+	/// to the destination buffer. Blocks till the whole range is read.
+	/// @return fence signalled when all transfers complete. Ownership passes to the caller.
+	/// @throws vuh::FileReadFailure
+	auto FileStage::upload(const FileRange& src, vk::Buffer dst, size_t dst_offset, size_t max_bytes
+	                       )-> vk::Fence
+	{
+		auto file = FileHandle(src.path, false);
+		const auto file_size = file.size();
+		if(src.offset > file_size){
+			throw FileReadFailure("offset is past the end of file " + src.path);
+		}
+		const auto size_bytes = std::min({src.size_bytes, file_size - src.offset, max_bytes});
+		auto& device = _impl->device;
+		if(size_bytes == 0){
+			return device.createFence({vk::FenceCreateFlagBits::eSignaled});
+		}
+		const auto chunk = std::min(size_bytes, chunk_bytes);
+		_impl = std::make_unique<Impl>(device, std::min(n_slots, (size_bytes + chunk - 1)/chunk), chunk);
+		auto& slots = _impl->slots;
+		auto last = size_t(0);
+		for(size_t done = 0, i = 0; done < size_bytes; done += chunk, ++i){
+			VUH_TRACE_SCOPE("file chunk", "transfer");
+			auto& s = slots[i % slots.size()];
+			_impl->wait(s);
+			const auto m = std::min(chunk, size_bytes - done);
+			file.read_at(s.stage.data(), m, src.offset + done);
+			s.stage.flush_mapped_writes(0, m);
+			_impl->submit(s, s.stage, 0, dst, dst_offset + done, m);
+			last = i % slots.size();
+		}
+		// fence of the last submission also covers all previous ones on the same queue
+		auto fence = slots[last].fence;
+		slots[last].fence = nullptr;
+		return fence;
+	}
+
+	/// Transfer the buffer range chunk by chunk to the staging ring and write the chunks to file
+	/// as they arrive. Blocks till the whole range is written.
+	/// @throws vuh::FileWriteFailure
+	auto FileStage::download(vk::Buffer src, size_t src_offset, size_t size_bytes, const FileRange& dst
+	                         )-> void
+	{
+		size_bytes = std::min(size_bytes, dst.size_bytes); // never write past the destination range
+		auto file = FileHandle(dst.path, true);
+		if(size_bytes == 0){
+			return;
+		}
+		const auto chunk = std::min(size_bytes, chunk_bytes);
+		const auto n_chunks = (size_bytes + chunk - 1)/chunk;
+		_impl = std::make_unique<Impl>(_impl->device, std::min(n_slots, n_chunks), chunk);
+		auto& slots = _impl->slots;
+		auto chunk_size = [&](size_t i){ return std::min(chunk, size_bytes - i*chunk); };
+		for(size_t i = 0; i < slots.size(); ++i){ // fill the pipeline
+			_impl->submit(slots[i], src, src_offset + i*chunk, slots[i].stage, 0, chunk_size(i));
+		}
+		for(size_t i = 0; i < n_chunks; ++i){
+			VUH_TRACE_SCOPE("file chunk", "transfer");
+			auto& s = slots[i % slots.size()];
+			_impl->wait(s);
+			s.stage.invalidate_mapped_cache(0, chunk_size(i));
+			file.write_at(s.stage.data(), chunk_size(i), dst.offset + i*chunk);
+			const auto next = i + slots.size();
+			if(next < n_chunks){
+				_impl->submit(s, src, src_offset + next*chunk, s.stage, 0, chunk_size(next));
+			}
+		}
+	}
+} // namespace detail
+} // namespace vuh
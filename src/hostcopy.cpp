@@ -0,0 +1,207 @@
+#include <vuh/arr/hostCopy.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
+
+namespace {
+	std::atomic<uint32_t> host_copy_threads{1};
+
+	/// Pool of worker threads running parallel_for() tasks.
+	/// One job at a time, the calling thread takes part in it.
+	class ThreadPool {
+	public:
+		explicit ThreadPool(uint32_t n_workers) {
+			for(uint32_t i = 0; i < n_workers; ++i){
+				_workers.emplace_back([this]{ work(); });
+			}
+		}
+
+		~ThreadPool() noexcept {
+			{
+				auto lock = std::lock_guard<std::mutex>(_mutex);
+				_stop = true;
+			}
+			_cv_job.notify_all();
+			for(auto& w: _workers){
+				w.join();
+			}
+		}
+
+		/// @return number of threads running a job, incl. the calling thread
+		auto size() const-> size_t { return _workers.size() + 1; }
+
+		/// Run fun(task_id) for task_id in [0, n_tasks), wait for completion.
+		/// @throws the first exception thrown by fun
+		auto run(size_t n_tasks, const std::function<void(size_t)>& fun)-> void {
+			auto job_lock = std::lock_guard<std::mutex>(_job_mutex);
+			{
+				auto lock = std::lock_guard<std::mutex>(_mutex);
+				_fun = &fun;
+				_n_tasks = n_tasks;
+				_next = 0;
+				_done = 0;
+				_error = nullptr;
+				++_generation;
+			}
+			_cv_job.notify_all();
+			process();
+			auto lock = std::unique_lock<std::mutex>(_mutex);
+			_cv_done.wait(lock, [this]{ return _done == _n_tasks; });
+			_fun = nullptr;
+			if(_error){
+				std::rethrow_exception(_error);
+			}
+		}
+	private:
+		/// Worker thread loop
+		auto work()-> void {
+			auto seen = uint64_t(0);
+			while(true){
+				{
+					auto lock = std::unique_lock<std::mutex>(_mutex);
+					_cv_job.wait(lock, [&]{ return _stop || _generation != seen; });
+					if(_stop){
+						return;
+					}
+					seen = _generation;
+				}
+				process();
+			}
+		}
+
+		/// Take and run the tasks of the current job until none is left.
+		auto process()-> void {
+			while(true){
+				auto task = size_t(0);
+				const std::function<void(size_t)>* fun = nullptr;
+				{
+					auto lock = std::lock_guard<std::mutex>(_mutex);
+					if(!_fun || _next >= _n_tasks){
+						return;
+					}
+					task = _next++;
+					fun = _fun;
+				}
+				try{
+					(*fun)(task);
+				} catch(...){
+					auto lock = std::lock_guard<std::mutex>(_mutex);
+					if(!_error){
+						_error = std::current_exception();
+					}
+				}
+				auto lock = std::lock_guard<std::mutex>(_mutex);
+				if(++_done == _n_tasks){
+					_cv_done.notify_all();
+				}
+			}
+		}
+	private: // data
+		std::vector<std::thread> _workers;
+		std::mutex _job_mutex;       ///< serializes the jobs
+		std::mutex _mutex;           ///< guards the job state
+		std::condition_variable _cv_job;
+		std::condition_variable _cv_done;
+		const std::function<void(size_t)>* _fun = nullptr; ///< current job
+		size_t _n_tasks = 0;
+		size_t _next = 0;            ///< next task to take
+		size_t _done = 0;            ///< number of finished tasks
+		uint64_t _generation = 0;    ///< job counter, wakes up workers
+		std::exception_ptr _error;   ///< first exception thrown by the job
+		bool _stop = false;
+	}; // class ThreadPool
+
+	/// @return the thread pool with a thread per hardware thread (incl. the calling one).
+	/// Jobs use as many of those as configured by vuh::setHostCopyThreads().
+	auto pool()-> ThreadPool& {
+		static ThreadPool p(std::max(std::thread::hardware_concurrency(), 1u) - 1u);
+		return p;
+	}
+} // namespace
+
+namespace vuh {
+	/// Set the number of threads used by the host side copies to (mapped) array memory.
+	/// 1 (default) makes the copies serial, 0 uses all hardware threads.
+	auto setHostCopyThreads(uint32_t n_threads)-> void {
+		if(n_threads == 0){
+			n_threads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		host_copy_threads = n_threads;
+	}
+
+	/// @return number of threads used by the host side copies
+	auto hostCopyThreads() noexcept-> uint32_t {
+		return host_copy_threads.load(std::memory_order_relaxed);
+	}
+
+namespace arr {
+	/// Split [0, n_items) into per-thread chunks and call fun(first, last) on each.
+	/// Chunk boundaries are multiples of granule, chunks are not smaller than min_items
+	/// (except the last one). Runs serially if only one thread is configured or the range is small.
+	auto parallel_for(size_t n_items, size_t granule, size_t min_items
+	                  , const std::function<void(size_t, size_t)>& fun)-> void
+	{
+		const auto n_threads = size_t(hostCopyThreads());
+		const auto max_tasks = std::max(n_items/std::max(min_items, size_t(1)), size_t(1));
+		const auto n_tasks = std::min(n_threads, max_tasks);
+		if(n_tasks <= 1){
+			fun(0, n_items);
+			return;
+		}
+		auto chunk = (n_items + n_tasks - 1)/n_tasks;
+		chunk = (chunk + granule - 1)/granule*granule;
+		const auto n_chunks = (n_items + chunk - 1)/chunk;
+		pool().run(n_chunks, [&](size_t i){
+			fun(i*chunk, std::min((i + 1)*chunk, n_items));
+		});
+	}
+
+	/// Copy memory with non-temporal stores (when available), bypassing the cache.
+	/// Suitable for filling the write-combined mapped memory, which is not read back on host.
+	auto stream_copy(void* dst, const void* src, size_t size_bytes) noexcept-> void {
+#ifdef __SSE2__
+		auto d = static_cast<char*>(dst);
+		auto s = static_cast<const char*>(src);
+		const auto head = std::min(size_t((16 - reinterpret_cast<uintptr_t>(d) % 16) % 16), size_bytes);
+		std::memcpy(d, s, head);
+		d += head; s += head; size_bytes -= head;
+		for(; size_bytes >= 64; d += 64, s += 64, size_bytes -= 64){
+			const auto x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+			const auto x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+			const auto x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+			const auto x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d), x0);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), x1);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), x2);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), x3);
+		}
+		std::memcpy(d, s, size_bytes);
+		_mm_sfence();
+#else
+		std::memcpy(dst, src, size_bytes);
+#endif
+	}
+
+	/// Copy memory to the (mapped) array memory. Splits the copy to the cache-line aligned chunks
+	/// processed in parallel (see vuh::setHostCopyThreads()), each using stream_copy().
+	auto host_copy(void* dst, const void* src, size_t size_bytes)-> void {
+		auto d = static_cast<char*>(dst);
+		auto s = static_cast<const char*>(src);
+		parallel_for(size_bytes, 64, host_copy_min_chunk_bytes, [&](size_t first, size_t last){
+			stream_copy(d + first, s + first, last - first);
+		});
+	}
+} // namespace arr
+} // namespace vuh
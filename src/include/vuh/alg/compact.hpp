@@ -0,0 +1,177 @@
+#pragma once
+
+#include "kernel.h"
+#include "scan.hpp"
+
+#include <vuh/arr/arrayIter.hpp>
+#include <vuh/arr/arrayView.hpp>
+#include <vuh/arr/copy_async.hpp>
+#include <vuh/delayed.hpp>
+#include <vuh/trace.h>
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace vuh {
+	/// Comparisons of the bundled copy_if predicates, element is the left operand.
+	enum class CompareOp: uint32_t {
+		Less = 0,
+		LessEqual = 1,
+		Greater = 2,
+		GreaterEqual = 3,
+		Equal = 4,
+		NotEqual = 5,
+	};
+
+	namespace detail {
+		/// Maps the element type to the bundled compaction kernel.
+		template<class T> struct CompactKernel;
+		template<> struct CompactKernel<float>   { static constexpr auto id = KernelId::CompactF32; };
+		template<> struct CompactKernel<int32_t> { static constexpr auto id = KernelId::CompactI32; };
+		template<> struct CompactKernel<uint32_t>{ static constexpr auto id = KernelId::CompactU32; };
+
+		constexpr auto compact_group_size = uint32_t(256);            ///< workgroup size of the compaction kernels
+		constexpr auto compact_block = size_t(compact_group_size)*4;  ///< elements handled by one workgroup
+
+		/// Flags of the compaction pass, see compact.glsl
+		enum CompactFlags: uint32_t {
+			compact_scatter = 1u,  ///< copy the selected elements, otherwise only count them
+			compact_indirect = 2u, ///< write the indirect dispatch command after the count
+		};
+
+		/// Push constants of the compaction kernels.
+		struct CompactPush {
+			uint32_t n;            ///< number of elements
+			uint32_t src_offset;   ///< offset (elements) of the input within the bound range
+			uint32_t dst_offset;   ///< offset (elements) of the output within the bound range
+			uint32_t sums_offset;  ///< offset (elements) of the block counts within the bound range
+			uint32_t count_offset; ///< offset (elements) of the total count within the bound range
+			uint32_t first_group;  ///< index of the first block of the dispatch
+			uint32_t flags;        ///< CompactFlags
+			uint32_t value;        ///< bits of the value elements are compared with
+			uint32_t group_size;   ///< workgroup size of the indirect dispatch
+		};
+
+		/// @return bundled compaction kernel for the element type and comparison
+		template<class T>
+		auto compact_kernel(vuh::Device& device, CompareOp op)-> const Kernel& {
+			return kernel(device, CompactKernel<T>::id, 4, sizeof(CompactPush), {compact_group_size, uint32_t(op)});
+		}
+
+		/// @return compaction kernel compiled from the user SPIR-V code
+		template<class T>
+		auto compact_kernel(vuh::Device& device, const std::vector<char>& code)-> const Kernel& {
+			static_assert(sizeof(T) == 4, "copy_if supports 32-bit types");
+			return kernel(device, code, 4, sizeof(CompactPush), {compact_group_size, 0u});
+		}
+
+		/// Record the compaction of n elements at src_offset (bytes) of src to dst_offset of dst.
+		/// The first pass counts the selected elements of each block, the counts are scanned
+		/// and the second pass copies the selected elements of each block after those of the preceding ones.
+		/// Total count is written at count_offset (bytes) of count, followed by the
+		/// VkDispatchIndirectCommand over workgroups of group_size when that is not 0.
+		/// @throws vuh::BufferRangeExceeded if n does not fit in 32 bits
+		template<class T>
+		auto record_compact(Batch& batch, vuh::Device& device, const Kernel& kernel, uint32_t value
+		                    , vk::Buffer src, size_t src_offset, size_t n, vk::Buffer dst, size_t dst_offset
+		                    , vk::Buffer count, size_t count_offset, uint32_t group_size)-> void
+		{
+			requireCount("copy_if", n);
+			const auto count_words = size_t(group_size == 0 ? 1 : 4);
+			if(n == 0){
+				batch.fill(count, count_offset, sizeof(uint32_t), 0u);
+				if(group_size != 0){ // no workgroups, {0, 1, 1}
+					batch.fill(count, count_offset + sizeof(uint32_t), sizeof(uint32_t), 0u);
+					batch.fill(count, count_offset + 2*sizeof(uint32_t), 2*sizeof(uint32_t), 1u);
+				}
+				return;
+			}
+			const auto n_blocks = (n + compact_block - 1)/compact_block;
+			auto& sums = scratch<uint32_t>(batch, device, n_blocks);
+			const auto in = binding(device, src, src_offset, n*sizeof(T), sizeof(T));
+			const auto out = binding(device, dst, dst_offset, n*sizeof(T), sizeof(T));
+			const auto blocks = binding(device, sums, 0, n_blocks*sizeof(uint32_t), sizeof(uint32_t));
+			const auto total = binding(device, count, count_offset, count_words*sizeof(uint32_t), sizeof(uint32_t));
+			const auto buffers = {in.info, out.info, blocks.info, total.info};
+			auto push = CompactPush{uint32_t(n), in.offset, out.offset, blocks.offset, total.offset, 0
+			                        , group_size == 0 ? 0u : uint32_t(compact_indirect), value, group_size};
+			dispatch_groups(batch, device, kernel, buffers, push, n_blocks);
+			record_scan<uint32_t>(batch, device, scan_kernel<uint32_t>(device), sums, 0, sums, 0, n_blocks, false);
+			push.flags |= compact_scatter;
+			dispatch_groups(batch, device, kernel, buffers, push, n_blocks);
+		}
+
+		/// Submit the compaction of the view to the range starting at dst.
+		/// @throws vuh::BufferRangeExceeded if dst has less room than the size of the view
+		/// or count has less room than the words written to it
+		/// @throws vuh::DeviceMismatch if the arrays are on different devices
+		template<class Array1, class Array2, class Array3, class T=typename Array1::value_type>
+		auto compact_async(const ArrayView<Array1>& src, ArrayIter<Array2> dst, ArrayIter<Array3> count
+		                   , const Kernel& kernel, uint32_t value, uint32_t group_size)-> vuh::Delayed<Copy>
+		{
+			static_assert(std::is_same<T, typename ArrayIter<Array2>::value_type>::value
+			              , "array value types should be the same");
+			static_assert(std::is_same<uint32_t, typename ArrayIter<Array3>::value_type>::value
+			              , "count should be an element of uint32_t array");
+			auto& device = src.device();
+			requireSameDevice("copy_if", dst.array().device(), device);
+			requireSameDevice("copy_if", count.array().device(), device);
+			requireRoom("copy_if", "the destination", dst.array().size() - dst.offset(), src.size());
+			requireRoom("copy_if", "the count", count.array().size() - count.offset()
+			            , group_size == 0 ? 1 : 4);
+			auto batch = Batch(device);
+			record_compact<T>(batch, device, kernel, value, src.array(), src.offset_bytes(), src.size()
+			                  , dst.array(), dst.offset()*sizeof(T)
+			                  , count.array(), count.offset()*sizeof(uint32_t), group_size);
+			auto fence = batch.submit();
+			return vuh::Delayed<Copy>{fence, device, Copy::wrap(std::move(batch))};
+		}
+
+		/// @return bits of the 32-bit value
+		template<class T>
+		auto bits(T value)-> uint32_t {
+			static_assert(sizeof(T) == 4, "copy_if supports 32-bit types");
+			auto r = uint32_t(0);
+			std::memcpy(&r, &value, sizeof(T));
+			return r;
+		}
+	} // namespace detail
+
+	/// Copy the elements x of the view satisfying (x op value) to the range starting at dst,
+	/// keeping their order. The number of copied elements is written to the device array element
+	/// at count, nothing is transferred to host.
+	/// When group_size is not 0, count is followed by the VkDispatchIndirectCommand
+	/// {ceil(count/group_size), 1, 1}, so the array holding it (created with the eIndirectBuffer
+	/// usage flag) may drive the indirect dispatch of the kernel processing the copied elements.
+	/// Supported element types are float, int32_t and uint32_t.
+	/// @throws vuh::BufferRangeExceeded if dst has less room than the size of the view,
+	/// or count has less room than the count (and the dispatch command)
+	/// @throws vuh::DeviceMismatch if the arrays are on different devices
+	template<class Array1, class Array2, class Array3>
+	auto copy_if(const ArrayView<Array1>& src, ArrayIter<Array2> dst, ArrayIter<Array3> count
+	             , CompareOp op, typename Array1::value_type value, uint32_t group_size=0
+	             )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("copy_if", "compute");
+		using T = typename Array1::value_type;
+		return detail::compact_async(src, dst, count, detail::compact_kernel<T>(src.device(), op)
+		                             , detail::bits(value), group_size);
+	}
+
+	/// Copy the elements of the view satisfying the custom predicate to the range starting at dst.
+	/// code is the SPIR-V of a shader including vuh/alg/shaders/compact.glsl with the predicate
+	/// defined (see doc/algorithms.md). The count is written as with the bundled predicates.
+	/// @throws vuh::BufferRangeExceeded if dst or count have too little room
+	/// @throws vuh::DeviceMismatch if the arrays are on different devices
+	template<class Array1, class Array2, class Array3>
+	auto copy_if(const ArrayView<Array1>& src, ArrayIter<Array2> dst, ArrayIter<Array3> count
+	             , const std::vector<char>& code, uint32_t group_size=0)-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("copy_if", "compute");
+		using T = typename Array1::value_type;
+		return detail::compact_async(src, dst, count, detail::compact_kernel<T>(src.device(), code)
+		                             , 0u, group_size);
+	}
+} // namespace vuh
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "kernel.h"
+
+#include <vuh/arr/arrayView.hpp>
+#include <vuh/arr/copy_async.hpp>
+#include <vuh/delayed.hpp>
+#include <vuh/trace.h>
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace vuh {
+	namespace detail {
+		/// Tiling of the gemm kernel, passed as specialization constants, see gemm.glsl.
+		/// Workgroup computes the (group_y*rows) x (group_x*cols) tile of the result.
+		struct GemmVariant {
+			uint32_t group_x; ///< workgroup size along the columns of C
+			uint32_t group_y; ///< workgroup size along the rows of C
+			uint32_t tile_k;  ///< depth of the tiles of A and B staged in shared memory
+			uint32_t rows;    ///< rows of C computed by one invocation
+			uint32_t cols;    ///< columns of C computed by one invocation
+		};
+
+		/// Push constants of the gemm kernel.
+		struct GemmPush {
+			uint32_t m, n, k;
+			uint32_t lda, ldb, ldc;                ///< row strides (elements)
+			uint32_t a_offset, b_offset, c_offset; ///< offsets (elements) within the bound ranges
+			uint32_t stride_a, stride_b, stride_c; ///< offsets (elements) between the batch matrices
+			uint32_t first_batch;                  ///< batch matrix of the first workgroup layer
+			float alpha;
+			float beta;
+		};
+
+		/// Row-major matrix (or strided batch of matrices) in the buffer.
+		struct GemmOperand {
+			vk::Buffer buffer;
+			size_t offset_bytes; ///< offset of the first matrix
+			uint32_t ld;         ///< row stride (elements)
+			uint32_t stride;     ///< offset (elements) between the batch matrices
+		};
+
+		auto gemm_variants()-> const std::vector<GemmVariant>&;
+		auto gemm_variant(vuh::Device& device, uint32_t m, uint32_t n)-> const GemmVariant&;
+		auto record_gemm(Batch& batch, vuh::Device& device, const GemmVariant& variant
+		                 , uint32_t m, uint32_t n, uint32_t k, float alpha, const GemmOperand& a
+		                 , const GemmOperand& b, float beta, const GemmOperand& c
+		                 , uint32_t batch_count)-> void;
+
+		/// @return operand referring to the view
+		template<class Array>
+		auto gemm_operand(const ArrayView<Array>& view, uint32_t ld, uint32_t stride=0)-> GemmOperand {
+			static_assert(std::is_same<float, typename Array::value_type>::value
+			              , "gemm supports float matrices");
+			return {view.array(), view.offset_bytes(), ld, stride};
+		}
+	} // namespace detail
+
+	/// Matrix multiply C = alpha*A*B + beta*C of the row-major matrices in the array views,
+	/// A is m x k with row stride lda, B is k x n with row stride ldb, C is m x n with row stride ldc.
+	/// C is not read when beta is 0.
+	/// The tiling variant is tuned for the device on the first call with matrices of similar size,
+	/// see doc/algorithms.md.
+	template<class Array1, class Array2, class Array3>
+	auto gemm(uint32_t m, uint32_t n, uint32_t k, float alpha
+	          , const ArrayView<Array1>& a, uint32_t lda, const ArrayView<Array2>& b, uint32_t ldb
+	          , float beta, const ArrayView<Array3>& c, uint32_t ldc)-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("gemm", "compute");
+		auto& device = c.device();
+		assert(a.device() == device && b.device() == device);
+		const auto& variant = detail::gemm_variant(device, m, n);
+		auto batch = detail::Batch(device);
+		detail::record_gemm(batch, device, variant, m, n, k, alpha, detail::gemm_operand(a, lda)
+		                    , detail::gemm_operand(b, ldb), beta, detail::gemm_operand(c, ldc), 1);
+		auto fence = batch.submit();
+		return vuh::Delayed<Copy>{fence, device, Copy::wrap(std::move(batch))};
+	}
+
+	/// Multiply batch_count matrices laid out with constant strides (elements) in the array views:
+	/// C_i = alpha*A_i*B_i + beta*C_i, where A_i starts at stride_a*i of the view a, etc.
+	/// All products run in a single dispatch.
+	template<class Array1, class Array2, class Array3>
+	auto gemm_strided_batched(uint32_t m, uint32_t n, uint32_t k, float alpha
+	                          , const ArrayView<Array1>& a, uint32_t lda, uint32_t stride_a
+	                          , const ArrayView<Array2>& b, uint32_t ldb, uint32_t stride_b
+	                          , float beta, const ArrayView<Array3>& c, uint32_t ldc, uint32_t stride_c
+	                          , uint32_t batch_count)-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("gemm_strided_batched", "compute");
+		auto& device = c.device();
+		assert(a.device() == device && b.device() == device);
+		const auto& variant = detail::gemm_variant(device, m, n);
+		auto batch = detail::Batch(device);
+		detail::record_gemm(batch, device, variant, m, n, k, alpha, detail::gemm_operand(a, lda, stride_a)
+		                    , detail::gemm_operand(b, ldb, stride_b), beta
+		                    , detail::gemm_operand(c, ldc, stride_c), batch_count);
+		auto fence = batch.submit();
+		return vuh::Delayed<Copy>{fence, device, Copy::wrap(std::move(batch))};
+	}
+
+	/// Multiply the matrices of the same dimensions at arbitrary places: C_i = alpha*A_i*B_i + beta*C_i.
+	/// Products are recorded to a single command buffer and submitted at once.
+	template<class Array1, class Array2, class Array3>
+	auto gemm_batched(uint32_t m, uint32_t n, uint32_t k, float alpha
+	                  , const std::vector<ArrayView<Array1>>& a, uint32_t lda
+	                  , const std::vector<ArrayView<Array2>>& b, uint32_t ldb
+	                  , float beta, const std::vector<ArrayView<Array3>>& c, uint32_t ldc
+	                  )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("gemm_batched", "compute");
+		assert(!c.empty() && a.size() == c.size() && b.size() == c.size());
+		auto& device = c.front().device();
+		const auto& variant = detail::gemm_variant(device, m, n);
+		auto batch = detail::Batch(device);
+		for(size_t i = 0; i < c.size(); ++i){
+			assert(a[i].device() == device && b[i].device() == device && c[i].device() == device);
+			detail::record_gemm(batch, device, variant, m, n, k, alpha, detail::gemm_operand(a[i], lda)
+			                    , detail::gemm_operand(b[i], ldb), beta, detail::gemm_operand(c[i], ldc), 1);
+		}
+		auto fence = batch.submit();
+		return vuh::Delayed<Copy>{fence, device, Copy::wrap(std::move(batch))};
+	}
+} // namespace vuh
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "kernel.h"
+
+#include <vuh/arr/arrayView.hpp>
+#include <vuh/arr/copy_async.hpp>
+#include <vuh/delayed.hpp>
+#include <vuh/trace.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace vuh {
+	namespace detail {
+		/// Maps the element type to the bundled histogram kernel.
+		template<class T> struct HistogramKernel;
+		template<> struct HistogramKernel<float>   { static constexpr auto id = KernelId::HistogramF32; };
+		template<> struct HistogramKernel<int32_t> { static constexpr auto id = KernelId::HistogramI32; };
+		template<> struct HistogramKernel<uint32_t>{ static constexpr auto id = KernelId::HistogramU32; };
+
+		constexpr auto histogram_group_size = uint32_t(256);  ///< workgroup size of the histogram kernels
+		constexpr auto histogram_max_groups = uint32_t(1024); ///< max number of private histograms
+		constexpr auto histogram_min_items = uint32_t(16);    ///< min number of elements per invocation
+
+		/// Push constants of the histogram kernels.
+		struct HistogramPush {
+			uint32_t n;          ///< number of elements
+			uint32_t src_offset; ///< offset (elements) of the input within the bound range
+			uint32_t dst_offset; ///< offset (elements) of the first bin within the bound range
+			uint32_t bins;       ///< number of bins
+			uint32_t lower;      ///< bits of the lower boundary of the first bin
+			uint32_t upper;      ///< bits of the upper boundary of the last bin
+		};
+
+		/// Record the histogram of n elements at src_offset (bytes) of src to bins at dst_offset of dst.
+		/// Bins are cleared first, so the result does not depend on their previous content.
+		/// @throws vuh::BufferRangeExceeded if n or the number of bins does not fit in 32 bits
+		template<class T>
+		auto record_histogram(Batch& batch, vuh::Device& device, vk::Buffer src, size_t src_offset
+		                      , size_t n, vk::Buffer dst, size_t dst_offset, size_t bins
+		                      , T lower, T upper)-> void
+		{
+			assert(bins > 0);
+			requireCount("histogram", n);
+			requireCount("histogram bins", bins);
+			batch.fill(dst, dst_offset, bins*sizeof(uint32_t), 0u);
+			if(n == 0){
+				return;
+			}
+			const auto& k = kernel(device, HistogramKernel<T>::id, 2, sizeof(HistogramPush)
+			                       , {histogram_group_size});
+			const auto per_group = size_t(histogram_group_size)*histogram_min_items;
+			const auto groups = uint32_t(std::min((n + per_group - 1)/per_group, size_t(histogram_max_groups)));
+			const auto in = binding(device, src, src_offset, n*sizeof(T), sizeof(T));
+			const auto out = binding(device, dst, dst_offset, bins*sizeof(uint32_t), sizeof(uint32_t));
+			auto push = HistogramPush{uint32_t(n), in.offset, out.offset, uint32_t(bins), 0, 0};
+			std::memcpy(&push.lower, &lower, sizeof(T));
+			std::memcpy(&push.upper, &upper, sizeof(T));
+			batch.dispatch(k, {in.info, out.info}, &push, groups);
+		}
+	} // namespace detail
+
+	/// Histogram of the view over the bins of equal width covering [lower, upper).
+	/// The number of bins is the size of the bins view (uint32_t elements), elements outside of
+	/// the range are not counted. Each workgroup counts in a private histogram in shared memory
+	/// (up to 2048 bins, global atomics are used for larger histograms) and merges it to the result.
+	/// Bin boundaries are computed in single precision.
+	/// Supported element types are float, int32_t and uint32_t.
+	template<class Array1, class Array2>
+	auto histogram(const ArrayView<Array1>& src, const ArrayView<Array2>& bins
+	               , typename Array1::value_type lower, typename Array1::value_type upper
+	               )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("histogram", "compute");
+		using T = typename Array1::value_type;
+		static_assert(std::is_same<uint32_t, typename Array2::value_type>::value
+		              , "bins should be a view of uint32_t array");
+		assert(lower < upper);
+		auto& device = src.device();
+		assert(bins.device() == device);
+		auto batch = detail::Batch(device);
+		detail::record_histogram<T>(batch, device, src.array(), src.offset_bytes(), src.size()
+		                            , bins.array(), bins.offset_bytes(), bins.size(), lower, upper);
+		auto fence = batch.submit();
+		return vuh::Delayed<Copy>{fence, device, Copy::wrap(std::move(batch))};
+	}
+} // namespace vuh
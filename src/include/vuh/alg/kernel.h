@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vuh/device.h>
+#include <vuh/arr/allocDevice.hpp>
+#include <vuh/arr/deviceArray.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace vuh {
+namespace detail {
+	/// Bundled precompiled kernels of the parallel algorithms.
+	/// Each kernel comes in a shared memory variant (Vulkan 1.0), kernels over 32-bit types also
+	/// in a subgroup variant (Vulkan 1.1).
+	enum class KernelId {
+		ReduceF32,
+		ReduceI32,
+		ReduceU32,
+		ScanF32,
+		ScanI32,
+		ScanU32,
+		ScanF64,
+		ScanI64,
+		ScanU64,
+		Radix,   ///< radix sort pass over keys of any type
+		CompactF32,
+		CompactI32,
+		CompactU32,
+		HistogramF32,
+		HistogramI32,
+		HistogramU32,
+		GemmF32,
+	};
+
+	/// Pointer to SPIR-V code with its size in bytes.
+	struct SpirvCode {
+		const uint32_t* code; ///< null if there is no such variant
+		size_t size_bytes;    ///< code size (bytes)
+	};
+
+	auto spirv(KernelId id, bool subgroup)-> SpirvCode;
+
+	/// Compute pipeline of the algorithm kernel.
+	/// Kernel takes storage buffers at bindings 0..n_buffers-1 of the descriptor set 0,
+	/// push constants of at most push_bytes and 32-bit specialization constants numbered from 0.
+	/// Refers to the vk::Device handle only, so it can be cached in vuh::Device.
+	class Kernel {
+	public:
+		Kernel(vuh::Device& device, SpirvCode code, uint32_t n_buffers, uint32_t push_bytes
+		       , const std::vector<uint32_t>& specs);
+		~Kernel() noexcept;
+
+		Kernel(const Kernel&) = delete;
+		auto operator=(const Kernel&)-> Kernel& = delete;
+
+		auto pipeline() const-> vk::Pipeline { return _pipeline; }
+		auto layout() const-> vk::PipelineLayout { return _pipelayout; }
+		auto descriptorLayout() const-> vk::DescriptorSetLayout { return _dsclayout; }
+		auto buffers() const-> uint32_t { return _n_buffers; }
+		auto pushBytes() const-> uint32_t { return _push_bytes; }
+	private: // helpers
+		auto release() noexcept-> void;
+	private: // data
+		vk::Device _device;                 ///< device handle the pipeline belongs to
+		vk::ShaderModule _shader;           ///< kernel code
+		vk::DescriptorSetLayout _dsclayout; ///< storage buffers at bindings 0..n_buffers-1
+		vk::PipelineLayout _pipelayout;     ///< pipeline layout
+		vk::Pipeline _pipeline;             ///< specialized compute pipeline
+		uint32_t _n_buffers;                ///< number of bound buffers
+		uint32_t _push_bytes;               ///< size of push constants
+	}; // class Kernel
+
+	auto hasSubgroupArithmetic(vuh::Device& device)-> bool;
+	auto kernel(vuh::Device& device, KernelId id, uint32_t n_buffers, uint32_t push_bytes
+	            , const std::vector<uint32_t>& specs)-> const Kernel&;
+	auto kernel(vuh::Device& device, const std::vector<char>& code, uint32_t n_buffers
+	            , uint32_t push_bytes, const std::vector<uint32_t>& specs)-> const Kernel&;
+
+	/// Buffer range bound to the kernel.
+	/// The range is widened down to the device offset alignment, the element offset of the
+	/// requested range start within the bound range is passed to the kernel in push constants.
+	struct Binding {
+		vk::DescriptorBufferInfo info;
+		uint32_t offset; ///< offset (elements) of the range start within the bound range
+	};
+
+	auto binding(const vuh::Device& device, vk::Buffer buffer, size_t offset_bytes, size_t size_bytes
+	             , size_t element_bytes)-> Binding;
+	auto requireFeatures(const vuh::Device& device, bool int64, bool float64)-> void;
+	auto requireCount(const char* algorithm, size_t n)-> void;
+	auto requireRoom(const char* algorithm, const char* what, size_t available, size_t n)-> void;
+	auto requireSameDevice(const char* algorithm, const vuh::Device& a, const vuh::Device& b)-> void;
+
+	/// Sequence of kernel dispatches and transfers recorded to a single command buffer
+	/// and submitted to the compute queue at once.
+	/// Commands are separated by memory barriers, so each command sees the results of the previous ones.
+	/// Holds the descriptor sets and resources passed to keep() till destruction, so it is used
+	/// as an action of Delayed<> to keep those alive till the batch completes. Delayed action is a noop.
+	class Batch {
+	public:
+		Batch() = default;
+		explicit Batch(vuh::Device& device);
+		Batch(Batch&&) noexcept;
+		auto operator=(Batch&&) noexcept-> Batch&;
+		~Batch() noexcept;
+
+		auto dispatch(const Kernel& kernel, std::initializer_list<vk::DescriptorBufferInfo> buffers
+		              , const void* push, uint32_t groups_x, uint32_t groups_y=1, uint32_t groups_z=1)-> void;
+		auto fill(vk::Buffer buffer, size_t offset_bytes, size_t size_bytes, uint32_t pattern)-> void;
+		auto copy(vk::Buffer src, size_t src_offset, vk::Buffer dst, size_t dst_offset
+		          , size_t size_bytes)-> void;
+		auto keep(std::shared_ptr<void> resource)-> void;
+		auto submit()-> vk::Fence;
+
+		/// delayed operation is a noop
+		constexpr auto operator()() const noexcept-> void {}
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _impl;
+	}; // class Batch
+
+	/// Record the dispatch of n_groups workgroups of the kernel.
+	/// Dispatches are split to respect the device limit on the number of workgroups.
+	/// Push should have the first_group field, set to the index of the first workgroup of each part.
+	template<class Push>
+	auto dispatch_groups(Batch& batch, const vuh::Device& device, const Kernel& kernel
+	                     , std::initializer_list<vk::DescriptorBufferInfo> buffers, Push push
+	                     , size_t n_groups)-> void
+	{
+		const auto max_groups = size_t(device.limits().maxComputeWorkGroupCount[0]);
+		for(size_t first = 0; first < n_groups; first += max_groups){
+			push.first_group = uint32_t(first);
+			batch.dispatch(kernel, buffers, &push, uint32_t(std::min(max_groups, n_groups - first)));
+		}
+	}
+
+	/// Device-only array holding intermediate results of the algorithms.
+	template<class T>
+	using ScratchArray = arr::DeviceOnlyArray<T, arr::AllocDevice<arr::properties::DeviceOnly>>;
+
+	/// @return scratch array of n elements kept alive by the batch
+	template<class T>
+	auto scratch(Batch& batch, vuh::Device& device, size_t n)-> ScratchArray<T>& {
+		auto r = std::make_shared<ScratchArray<T>>(device, n);
+		batch.keep(r);
+		return *r;
+	}
+} // namespace detail
+} // namespace vuh
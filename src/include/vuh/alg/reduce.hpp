@@ -0,0 +1,232 @@
+#pragma once
+
+#include "kernel.h"
+
+#include <vuh/arr/allocDevice.hpp>
+#include <vuh/arr/arrayIter.hpp>
+#include <vuh/arr/arrayView.hpp>
+#include <vuh/arr/hostArray.hpp>
+#include <vuh/arr/copy_async.hpp>
+#include <vuh/delayed.hpp>
+#include <vuh/trace.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace vuh {
+	/// Operations of the bundled reduction kernels.
+	enum class ReduceOp: uint32_t {
+		Sum = 0,
+		Min = 1,
+		Max = 2,
+		Product = 3,
+	};
+
+	namespace detail {
+		/// Maps the element type to the bundled reduction kernel.
+		template<class T> struct ReduceKernel;
+		template<> struct ReduceKernel<float>   { static constexpr auto id = KernelId::ReduceF32; };
+		template<> struct ReduceKernel<int32_t> { static constexpr auto id = KernelId::ReduceI32; };
+		template<> struct ReduceKernel<uint32_t>{ static constexpr auto id = KernelId::ReduceU32; };
+
+		constexpr auto reduce_group_size = uint32_t(256);  ///< workgroup size of the reduction kernels
+		constexpr auto reduce_max_groups = uint32_t(1024); ///< max number of partial results of a pass
+		constexpr auto reduce_min_items = uint32_t(4);     ///< min number of elements per invocation
+
+		/// Push constants of the reduction kernels.
+		struct ReducePush {
+			uint32_t n;          ///< number of elements to reduce
+			uint32_t chunk;      ///< number of elements reduced by one workgroup
+			uint32_t src_offset; ///< offset (elements) of the input within the bound range
+			uint32_t dst_offset; ///< offset (elements) of the output within the bound range
+		};
+
+		/// @return identity element of the operation
+		template<class T>
+		auto reduce_identity(ReduceOp op)-> T {
+			switch(op){
+			case ReduceOp::Sum: return T(0);
+			case ReduceOp::Min: return std::numeric_limits<T>::has_infinity
+			                           ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+			case ReduceOp::Max: return std::numeric_limits<T>::has_infinity
+			                           ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+			case ReduceOp::Product: return T(1);
+			}
+			return T(0);
+		}
+
+		/// Record the reduction passes of n elements at src_offset (bytes) of src to a single
+		/// element at dst_offset (bytes) of dst. Passes with more than one workgroup write
+		/// partial results to the scratch array kept alive by the batch.
+		/// Empty input results in the identity element.
+		/// @throws vuh::BufferRangeExceeded if n does not fit in 32 bits
+		template<class T>
+		auto record_reduce(Batch& batch, vuh::Device& device, const Kernel& kernel, T identity
+		                   , vk::Buffer src, size_t src_offset, size_t n
+		                   , vk::Buffer dst, size_t dst_offset)-> void
+		{
+			requireCount("reduce", n);
+			if(n == 0){
+				auto pattern = uint32_t(0);
+				std::memcpy(&pattern, &identity, sizeof(T));
+				batch.fill(dst, dst_offset, sizeof(T), pattern);
+				return;
+			}
+			const auto per_group = size_t(reduce_group_size)*reduce_min_items;
+			auto groups = uint32_t(std::min((n + per_group - 1)/per_group, size_t(reduce_max_groups)));
+			// two halves of the scratch hold partial results of subsequent passes
+			auto partials = groups > 1 ? vk::Buffer(scratch<T>(batch, device, 2*reduce_max_groups))
+			                           : vk::Buffer();
+			auto in = binding(device, src, src_offset, n*sizeof(T), sizeof(T));
+			for(size_t pass = 0; ; ++pass){
+				const auto chunk = uint32_t((n + groups - 1)/groups);
+				groups = uint32_t((n + chunk - 1)/chunk);
+				const auto out = groups == 1
+				                 ? binding(device, dst, dst_offset, sizeof(T), sizeof(T))
+				                 : binding(device, partials, (pass % 2)*reduce_max_groups*sizeof(T)
+				                           , groups*sizeof(T), sizeof(T));
+				const auto push = ReducePush{uint32_t(n), chunk, in.offset, out.offset};
+				batch.dispatch(kernel, {in.info, out.info}, &push, groups);
+				if(groups == 1){
+					break;
+				}
+				in = out;
+				n = groups;
+				groups = uint32_t(std::min((n + per_group - 1)/per_group, size_t(reduce_max_groups)));
+			}
+		}
+	} // namespace detail
+
+	/// Result of the reduction.
+	/// Keeps the batch of reduction passes and the host-visible result buffer alive till
+	/// the reduction completes. Delayed action reads the result.
+	template<class T>
+	class Reduced {
+	public:
+		using ResultArray = arr::HostArray<T, arr::AllocDevice<arr::properties::HostCached>>;
+
+		Reduced() = default;
+
+		/// Constructor. Takes ownership of the batch writing the result to the array.
+		Reduced(detail::Batch batch, std::unique_ptr<ResultArray> result)
+		   : _batch(std::move(batch)), _result(std::move(result))
+		{}
+
+		/// Read the result to host.
+		auto operator()() noexcept-> void {
+			if(_result){
+				_result->invalidate_mapped_cache(0, sizeof(T));
+				_value = *_result->data();
+			}
+		}
+
+		/// @return reduction result.
+		/// @pre the reduction should be complete (Delayed::wait() returned true).
+		auto value() const-> T { return _value; }
+	private: // data
+		detail::Batch _batch;                 ///< reduction passes
+		std::unique_ptr<ResultArray> _result; ///< host-visible buffer the last pass writes to
+		T _value = T(0);                      ///< result, available after the action was triggered
+	}; // class Reduced
+
+	namespace detail {
+		/// @return bundled reduction kernel for the element type and operation
+		template<class T>
+		auto reduce_kernel(vuh::Device& device, ReduceOp op)-> const Kernel& {
+			return kernel(device, ReduceKernel<T>::id, 2, sizeof(ReducePush), {reduce_group_size, uint32_t(op)});
+		}
+
+		/// @return reduction kernel compiled from the user SPIR-V code
+		template<class T>
+		auto reduce_kernel(vuh::Device& device, const std::vector<char>& code)-> const Kernel& {
+			static_assert(sizeof(T) == 4, "custom reductions support 32-bit types");
+			return kernel(device, code, 2, sizeof(ReducePush), {reduce_group_size, 0u});
+		}
+
+		/// Submit the reduction of the view to the host-visible result buffer.
+		template<class Array, class T=typename Array::value_type>
+		auto reduce_to_host(const ArrayView<Array>& view, const Kernel& kernel, T identity
+		                    )-> vuh::Delayed<Reduced<T>>
+		{
+			auto& device = view.device();
+			auto result = std::make_unique<typename Reduced<T>::ResultArray>(device, 1);
+			auto batch = Batch(device);
+			record_reduce(batch, device, kernel, identity, view.array(), view.offset_bytes(), view.size()
+			              , *result, 0);
+			auto fence = batch.submit();
+			return vuh::Delayed<Reduced<T>>{fence, device, Reduced<T>(std::move(batch), std::move(result))};
+		}
+
+		/// Submit the reduction of the view to the device array element at dst.
+		template<class Array1, class Array2, class T=typename Array1::value_type>
+		auto reduce_to_device(const ArrayView<Array1>& view, ArrayIter<Array2> dst, const Kernel& kernel
+		                      , T identity)-> vuh::Delayed<Copy>
+		{
+			auto& device = view.device();
+			assert(dst.array().device() == device);
+			auto batch = Batch(device);
+			record_reduce(batch, device, kernel, identity, view.array(), view.offset_bytes(), view.size()
+			              , dst.array(), dst.offset()*sizeof(T));
+			auto fence = batch.submit();
+			return vuh::Delayed<Copy>{fence, device, Copy::wrap(std::move(batch))};
+		}
+	} // namespace detail
+
+	/// Reduce the array view with one of the bundled operations.
+	/// Runs the multi-pass reduction on the device of the view (using subgroup operations when
+	/// the device supports them, see doc/algorithms.md), only the result is transferred to host.
+	/// Supported element types are float, int32_t and uint32_t.
+	/// @return synchronization token, result is available with action().value() after wait().
+	template<class Array>
+	auto reduce(const ArrayView<Array>& view, ReduceOp op=ReduceOp::Sum
+	            )-> vuh::Delayed<Reduced<typename Array::value_type>>
+	{
+		VUH_TRACE_SCOPE("reduce", "compute");
+		using T = typename Array::value_type;
+		return detail::reduce_to_host(view, detail::reduce_kernel<T>(view.device(), op)
+		                              , detail::reduce_identity<T>(op));
+	}
+
+	/// Reduce the array view with the custom operation.
+	/// code is the SPIR-V of a shader including vuh/alg/shaders/reduce.glsl with the operation
+	/// defined (see doc/algorithms.md), identity is the identity element of the operation.
+	template<class Array>
+	auto reduce(const ArrayView<Array>& view, const std::vector<char>& code
+	            , typename Array::value_type identity
+	            )-> vuh::Delayed<Reduced<typename Array::value_type>>
+	{
+		VUH_TRACE_SCOPE("reduce", "compute");
+		using T = typename Array::value_type;
+		return detail::reduce_to_host(view, detail::reduce_kernel<T>(view.device(), code), identity);
+	}
+
+	/// Reduce the array view with one of the bundled operations and write the result to the
+	/// device array element at dst, without the host readback.
+	/// Arrays should be on the same device.
+	template<class Array1, class Array2>
+	auto reduce_async(const ArrayView<Array1>& view, ArrayIter<Array2> dst, ReduceOp op=ReduceOp::Sum
+	                  )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("reduce_async", "compute");
+		using T = typename Array1::value_type;
+		return detail::reduce_to_device(view, dst, detail::reduce_kernel<T>(view.device(), op)
+		                                , detail::reduce_identity<T>(op));
+	}
+
+	/// Reduce the array view with the custom operation and write the result to the device array
+	/// element at dst, without the host readback.
+	template<class Array1, class Array2>
+	auto reduce_async(const ArrayView<Array1>& view, ArrayIter<Array2> dst
+	                  , const std::vector<char>& code, typename Array1::value_type identity
+	                  )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("reduce_async", "compute");
+		using T = typename Array1::value_type;
+		return detail::reduce_to_device(view, dst, detail::reduce_kernel<T>(view.device(), code), identity);
+	}
+} // namespace vuh
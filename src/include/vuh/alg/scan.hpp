@@ -0,0 +1,149 @@
+#pragma once
+
+#include "kernel.h"
+
+#include <vuh/arr/arrayIter.hpp>
+#include <vuh/arr/arrayView.hpp>
+#include <vuh/arr/copy_async.hpp>
+#include <vuh/delayed.hpp>
+#include <vuh/trace.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+namespace vuh {
+	namespace detail {
+		/// Maps the element type to the bundled scan kernel.
+		template<class T> struct ScanKernel;
+		template<> struct ScanKernel<float>   { static constexpr auto id = KernelId::ScanF32; };
+		template<> struct ScanKernel<int32_t> { static constexpr auto id = KernelId::ScanI32; };
+		template<> struct ScanKernel<uint32_t>{ static constexpr auto id = KernelId::ScanU32; };
+		template<> struct ScanKernel<double>  { static constexpr auto id = KernelId::ScanF64; };
+		template<> struct ScanKernel<int64_t> { static constexpr auto id = KernelId::ScanI64; };
+		template<> struct ScanKernel<uint64_t>{ static constexpr auto id = KernelId::ScanU64; };
+
+		constexpr auto scan_group_size = uint32_t(256);            ///< workgroup size of the scan kernels
+		constexpr auto scan_block = size_t(scan_group_size)*4;     ///< elements scanned by one workgroup
+
+		/// Flags of the scan pass, see scan.glsl
+		enum ScanFlags: uint32_t {
+			scan_exclusive = 1u, ///< write exclusive prefix sums
+			scan_carry = 2u,     ///< add carries of the preceding blocks
+			scan_reduce = 4u,    ///< only write the block sums
+		};
+
+		/// Push constants of the scan kernels.
+		struct ScanPush {
+			uint32_t n;            ///< number of elements
+			uint32_t src_offset;   ///< offset (elements) of the input within the bound range
+			uint32_t dst_offset;   ///< offset (elements) of the output within the bound range
+			uint32_t carry_offset; ///< offset (elements) of the block carries within the bound range
+			uint32_t first_group;  ///< index of the first block of the dispatch
+			uint32_t flags;        ///< ScanFlags
+		};
+
+		/// @return scan kernel for the element type. 64-bit types need device support.
+		/// @throws vuh::DeviceFeatureMissing
+		template<class T>
+		auto scan_kernel(vuh::Device& device)-> const Kernel& {
+			requireFeatures(device, std::is_integral<T>::value && sizeof(T) == 8
+			                , std::is_floating_point<T>::value && sizeof(T) == 8);
+			return kernel(device, ScanKernel<T>::id, 3, sizeof(ScanPush), {scan_group_size});
+		}
+
+		/// Record the scan pass over n_groups blocks.
+		inline auto dispatch_scan(Batch& batch, const vuh::Device& device, const Kernel& kernel
+		                          , const Binding& src, const Binding& dst, const Binding& carry
+		                          , ScanPush push, size_t n_groups)-> void
+		{
+			dispatch_groups(batch, device, kernel, {src.info, dst.info, carry.info}, push, n_groups);
+		}
+
+		/// Record the reduce-then-scan of n elements at src_offset (bytes) of src to dst_offset of dst.
+		/// Source and destination ranges may coincide.
+		/// Block sums go to the scratch array kept alive by the batch and are scanned recursively,
+		/// then each block is scanned with the sum of the preceding blocks as a carry-in.
+		/// @throws vuh::BufferRangeExceeded if n does not fit in 32 bits
+		template<class T>
+		auto record_scan(Batch& batch, vuh::Device& device, const Kernel& kernel
+		                 , vk::Buffer src, size_t src_offset, vk::Buffer dst, size_t dst_offset
+		                 , size_t n, bool exclusive)-> void
+		{
+			requireCount("scan", n);
+			if(n == 0){
+				return;
+			}
+			const auto flags = exclusive ? uint32_t(scan_exclusive) : 0u;
+			const auto n_blocks = (n + scan_block - 1)/scan_block;
+			const auto in = binding(device, src, src_offset, n*sizeof(T), sizeof(T));
+			const auto out = binding(device, dst, dst_offset, n*sizeof(T), sizeof(T));
+			if(n_blocks == 1){
+				dispatch_scan(batch, device, kernel, in, out, in, {uint32_t(n), in.offset, out.offset, 0, 0, flags}, 1);
+				return;
+			}
+			auto& sums = scratch<T>(batch, device, n_blocks);
+			const auto carry = binding(device, sums, 0, n_blocks*sizeof(T), sizeof(T));
+			dispatch_scan(batch, device, kernel, in, carry, in
+			              , {uint32_t(n), in.offset, carry.offset, 0, 0, scan_reduce}, n_blocks);
+			record_scan<T>(batch, device, kernel, sums, 0, sums, 0, n_blocks, true);
+			dispatch_scan(batch, device, kernel, in, out, carry
+			              , {uint32_t(n), in.offset, out.offset, carry.offset, 0, flags | scan_carry}, n_blocks);
+		}
+
+		/// Submit the scan of the view to the destination range starting at dst.
+		/// @throws vuh::BufferRangeExceeded if dst has less room than the size of the view
+		/// @throws vuh::DeviceMismatch if the arrays are on different devices
+		template<class Array1, class Array2>
+		auto scan_async(const ArrayView<Array1>& src, ArrayIter<Array2> dst, bool exclusive
+		                )-> vuh::Delayed<Copy>
+		{
+			using T = typename Array1::value_type;
+			static_assert(std::is_same<T, typename ArrayIter<Array2>::value_type>::value
+			              , "array value types should be the same");
+			auto& device = src.device();
+			requireSameDevice("scan", dst.array().device(), device);
+			requireRoom("scan", "the destination", dst.array().size() - dst.offset(), src.size());
+			const auto& k = scan_kernel<T>(device);
+			auto batch = Batch(device);
+			record_scan<T>(batch, device, k, src.array(), src.offset_bytes()
+			               , dst.array(), dst.offset()*sizeof(T), src.size(), exclusive);
+			auto fence = batch.submit();
+			return vuh::Delayed<Copy>{fence, device, Copy::wrap(std::move(batch))};
+		}
+	} // namespace detail
+
+	/// Inclusive prefix sum of the view written to the range starting at dst.
+	/// dst may point to the beginning of the view itself (in-place scan).
+	/// Supported element types are float, int32_t, uint32_t and, on devices with shaderInt64
+	/// and shaderFloat64 features, int64_t, uint64_t and double.
+	/// @throws vuh::DeviceFeatureMissing
+	/// @throws vuh::BufferRangeExceeded if dst has less room than the size of the view
+	template<class Array1, class Array2>
+	auto inclusive_scan(const ArrayView<Array1>& src, ArrayIter<Array2> dst)-> vuh::Delayed<Copy> {
+		VUH_TRACE_SCOPE("inclusive_scan", "compute");
+		return detail::scan_async(src, dst, false);
+	}
+
+	/// In-place inclusive prefix sum of the view.
+	template<class Array>
+	auto inclusive_scan(const ArrayView<Array>& view)-> vuh::Delayed<Copy> {
+		return inclusive_scan(view, view.device_begin());
+	}
+
+	/// Exclusive prefix sum (starting from 0) of the view written to the range starting at dst.
+	/// dst may point to the beginning of the view itself (in-place scan).
+	/// @throws vuh::DeviceFeatureMissing
+	/// @throws vuh::BufferRangeExceeded if dst has less room than the size of the view
+	template<class Array1, class Array2>
+	auto exclusive_scan(const ArrayView<Array1>& src, ArrayIter<Array2> dst)-> vuh::Delayed<Copy> {
+		VUH_TRACE_SCOPE("exclusive_scan", "compute");
+		return detail::scan_async(src, dst, true);
+	}
+
+	/// In-place exclusive prefix sum of the view.
+	template<class Array>
+	auto exclusive_scan(const ArrayView<Array>& view)-> vuh::Delayed<Copy> {
+		return exclusive_scan(view, view.device_begin());
+	}
+} // namespace vuh
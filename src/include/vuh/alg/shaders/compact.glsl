@@ -0,0 +1,104 @@
+// Pass of the stream compaction (copy_if) over 32-bit elements.
+// Workgroup g handles the block of ITEMS*gl_WorkGroupSize.x elements starting at g*block.
+// COUNT mode writes the number of selected elements of the block to sums[g].
+// SCATTER mode takes the inclusive scan of those counts in sums and copies the selected elements
+// of the block to dst in their original order. The last block writes the total count, followed
+// by the VkDispatchIndirectCommand for workgroups of group_size if INDIRECT is set.
+//
+// Custom predicates are compiled from a shader defining the element type (see types.glsl)
+// and VUH_PREDICATE (name of the function bool(T)) and including this file.
+
+#include "types.glsl"
+
+layout(local_size_x_id = 0) in;              // workgroup size
+layout(constant_id = 1) const uint OP = 0u;  // comparison with p.value: 0 <, 1 <=, 2 >, 3 >=, 4 ==, 5 !=
+const uint ITEMS = 4u;                       // elements per invocation
+const uint SCATTER = 1u;
+const uint INDIRECT = 2u;
+
+layout(push_constant) uniform Parameters {
+   uint n;             // number of elements
+   uint src_offset;    // offset (elements) of the first element in src
+   uint dst_offset;    // offset (elements) of the first element in dst
+   uint sums_offset;   // offset (elements) of the block counts in sums
+   uint count_offset;  // offset (elements) of the total count in count
+   uint first_group;   // index of the first block handled by this dispatch
+   uint flags;         // SCATTER, INDIRECT
+   uint value;         // bits of the value the elements are compared with
+   uint group_size;    // workgroup size of the indirect dispatch
+} p;
+
+layout(std430, binding = 0) readonly buffer Src { T src[]; };
+layout(std430, binding = 1) writeonly buffer Dst { T dst[]; };
+layout(std430, binding = 2) buffer Sums { uint sums[]; };
+layout(std430, binding = 3) writeonly buffer Count { uint count[]; };
+
+shared uint partial[gl_WorkGroupSize.x];
+
+#ifdef VUH_PREDICATE
+bool selected(T x){ return VUH_PREDICATE(x); }
+#else
+#  ifdef VUH_F32
+T value(){ return uintBitsToFloat(p.value); }
+#  else
+T value(){ return T(p.value); }
+#  endif
+
+bool selected(T x){
+   const T v = value();
+   return OP == 0u ? x < v : OP == 1u ? x <= v : OP == 2u ? x > v
+        : OP == 3u ? x >= v : OP == 4u ? x == v : x != v;
+}
+#endif
+
+/// @return exclusive sum of x over the workgroup, total sum goes to the last invocation's inclusive value
+uint workgroup_exclusive_sum(uint x){
+   const uint lid = gl_LocalInvocationID.x;
+   partial[lid] = x;
+   barrier();
+   for(uint s = 1u; s < gl_WorkGroupSize.x; s <<= 1){
+      const uint y = lid >= s ? partial[lid - s] : 0u;
+      barrier();
+      partial[lid] += y;
+      barrier();
+   }
+   return partial[lid] - x;
+}
+
+void main(){
+   const uint lid = gl_LocalInvocationID.x;
+   const uint group = p.first_group + gl_WorkGroupID.x;
+   const uint first = group*gl_WorkGroupSize.x*ITEMS + lid*ITEMS;
+   uint mask = 0u;                            // selected items of this invocation
+   uint c = 0u;
+   for(uint i = 0u; i < ITEMS; ++i){
+      if(first + i < p.n && selected(src[p.src_offset + first + i])){
+         mask |= 1u << i;
+         ++c;
+      }
+   }
+   const uint before = workgroup_exclusive_sum(c);
+   if((p.flags & SCATTER) == 0u){
+      if(lid == gl_WorkGroupSize.x - 1u){
+         sums[p.sums_offset + group] = before + c;
+      }
+      return;
+   }
+   const uint carry = group > 0u ? sums[p.sums_offset + group - 1u] : 0u;
+   uint pos = carry + before;
+   for(uint i = 0u; i < ITEMS; ++i){
+      if((mask & (1u << i)) != 0u){
+         dst[p.dst_offset + pos] = src[p.src_offset + first + i];
+         ++pos;
+      }
+   }
+   const uint n_blocks = (p.n + gl_WorkGroupSize.x*ITEMS - 1u)/(gl_WorkGroupSize.x*ITEMS);
+   if(group == n_blocks - 1u && lid == gl_WorkGroupSize.x - 1u){
+      count[p.count_offset] = pos;
+      if((p.flags & INDIRECT) != 0u){
+         count[p.count_offset + 1u] = (pos + p.group_size - 1u)/p.group_size;
+         count[p.count_offset + 2u] = 1u;
+         count[p.count_offset + 3u] = 1u;
+      }
+   }
+}
@@ -0,0 +1,95 @@
+// Tiled single precision matrix multiply C = alpha*A*B + beta*C of row-major matrices,
+// A is m x k, B is k x n, C is m x n.
+// Workgroup (x, y, z) computes the TILE_M x TILE_N tile of C starting at row y*TILE_M, column x*TILE_N
+// of the matrix z of the batch. Tiles of A and B along k are staged in shared memory,
+// each invocation accumulates TM x TN elements of the tile strided by the workgroup size.
+// Tile sizes are specialization constants, the host picks the variant tuned for the device.
+
+layout(local_size_x_id = 0, local_size_y_id = 1) in;
+layout(constant_id = 2) const uint TILE_K = 16u;  // depth of the staged tiles
+layout(constant_id = 3) const uint TM = 1u;       // rows of C per invocation, at most MAX_TM
+layout(constant_id = 4) const uint TN = 1u;       // columns of C per invocation, at most MAX_TN
+const uint MAX_TM = 8u;
+const uint MAX_TN = 8u;
+const uint TILE_M = gl_WorkGroupSize.y*TM;
+const uint TILE_N = gl_WorkGroupSize.x*TN;
+
+layout(push_constant) uniform Parameters {
+   uint m;
+   uint n;
+   uint k;
+   uint lda;           // row strides (elements) of the matrices
+   uint ldb;
+   uint ldc;
+   uint a_offset;      // offsets (elements) of the first matrices of the batch
+   uint b_offset;
+   uint c_offset;
+   uint stride_a;      // offsets (elements) between the matrices of the batch
+   uint stride_b;
+   uint stride_c;
+   uint first_batch;   // index of the batch matrix of the first workgroup layer of the dispatch
+   float alpha;
+   float beta;
+} p;
+
+layout(std430, binding = 0) readonly buffer A { float a[]; };
+layout(std430, binding = 1) readonly buffer B { float b[]; };
+layout(std430, binding = 2) buffer C { float c[]; };
+
+shared float tile_a[TILE_K*TILE_M];          // k-major, so the rows of the invocations are adjacent
+shared float tile_b[TILE_K*TILE_N];
+
+void main(){
+   const uint tx = gl_LocalInvocationID.x;
+   const uint ty = gl_LocalInvocationID.y;
+   const uint lid = ty*gl_WorkGroupSize.x + tx;
+   const uint threads = gl_WorkGroupSize.x*gl_WorkGroupSize.y;
+   const uint batch = p.first_batch + gl_WorkGroupID.z;
+   const uint row0 = gl_WorkGroupID.y*TILE_M;
+   const uint col0 = gl_WorkGroupID.x*TILE_N;
+   const uint a0 = p.a_offset + batch*p.stride_a;
+   const uint b0 = p.b_offset + batch*p.stride_b;
+   const uint c0 = p.c_offset + batch*p.stride_c;
+
+   float acc[MAX_TM*MAX_TN];
+   for(uint i = 0u; i < TM*TN; ++i){
+      acc[i] = 0.0;
+   }
+   for(uint k0 = 0u; k0 < p.k; k0 += TILE_K){
+      for(uint i = lid; i < TILE_M*TILE_K; i += threads){
+         const uint r = i/TILE_K;
+         const uint kk = i%TILE_K;
+         tile_a[kk*TILE_M + r] = row0 + r < p.m && k0 + kk < p.k ? a[a0 + (row0 + r)*p.lda + k0 + kk] : 0.0;
+      }
+      for(uint i = lid; i < TILE_K*TILE_N; i += threads){
+         const uint kk = i/TILE_N;
+         const uint col = i%TILE_N;
+         tile_b[i] = k0 + kk < p.k && col0 + col < p.n ? b[b0 + (k0 + kk)*p.ldb + col0 + col] : 0.0;
+      }
+      barrier();
+      for(uint kk = 0u; kk < TILE_K; ++kk){
+         float bk[MAX_TN];
+         for(uint j = 0u; j < TN; ++j){
+            bk[j] = tile_b[kk*TILE_N + tx + j*gl_WorkGroupSize.x];
+         }
+         for(uint i = 0u; i < TM; ++i){
+            const float ak = tile_a[kk*TILE_M + ty + i*gl_WorkGroupSize.y];
+            for(uint j = 0u; j < TN; ++j){
+               acc[i*TN + j] += ak*bk[j];
+            }
+         }
+      }
+      barrier();
+   }
+   for(uint i = 0u; i < TM; ++i){
+      const uint row = row0 + ty + i*gl_WorkGroupSize.y;
+      for(uint j = 0u; j < TN; ++j){
+         const uint col = col0 + tx + j*gl_WorkGroupSize.x;
+         if(row < p.m && col < p.n){
+            const uint idx = c0 + row*p.ldc + col;
+            // C is not read when beta is 0, so it may hold garbage (NaNs)
+            c[idx] = p.beta == 0.0 ? p.alpha*acc[i*TN + j] : p.alpha*acc[i*TN + j] + p.beta*c[idx];
+         }
+      }
+   }
+}
@@ -0,0 +1,76 @@
+// Histogram of 32-bit elements over bins of equal width in [lower, upper).
+// Elements outside of the range (and NaNs) are not counted. Counts are added to dst.
+// Each workgroup counts its share of the input in a private copy of the histogram in shared memory
+// and adds it to dst with one atomic per non-empty bin. Histograms with more than LOCAL_BINS bins
+// are counted with global atomics directly.
+
+#include "types.glsl"
+
+layout(local_size_x_id = 0) in;              // workgroup size
+const uint LOCAL_BINS = 2048u;               // max number of bins of the private histogram
+
+layout(push_constant) uniform Parameters {
+   uint n;             // number of elements
+   uint src_offset;    // offset (elements) of the first element in src
+   uint dst_offset;    // offset (elements) of the first bin in dst
+   uint bins;          // number of bins
+   uint lower;         // bits of the lower boundary of the first bin
+   uint upper;         // bits of the upper boundary of the last bin
+} p;
+
+layout(std430, binding = 0) readonly buffer Src { T src[]; };
+layout(std430, binding = 1) buffer Dst { uint dst[]; };
+
+shared uint local_bins[LOCAL_BINS];
+
+#ifdef VUH_F32
+T from_bits(uint b){ return uintBitsToFloat(b); }
+#else
+T from_bits(uint b){ return T(b); }
+#endif
+
+/// @return bin of the element, p.bins if it is outside of the range
+uint bin_of(T x){
+   const T lo = from_bits(p.lower);
+   const T hi = from_bits(p.upper);
+   if(!(x >= lo && x < hi)){
+      return p.bins;
+   }
+#ifdef VUH_F32
+   const float f = float(p.bins)*(x - lo)/(hi - lo);
+#else
+   const float f = float(uint(x) - uint(lo))*float(p.bins)/float(uint(hi) - uint(lo));
+#endif
+   return min(uint(f), p.bins - 1u);
+}
+
+void main(){
+   const uint lid = gl_LocalInvocationID.x;
+   const uint stride = gl_NumWorkGroups.x*gl_WorkGroupSize.x;
+   const bool private_bins = p.bins <= LOCAL_BINS;
+   if(private_bins){
+      for(uint b = lid; b < p.bins; b += gl_WorkGroupSize.x){
+         local_bins[b] = 0u;
+      }
+      barrier();
+   }
+   for(uint i = gl_GlobalInvocationID.x; i < p.n; i += stride){
+      const uint b = bin_of(src[p.src_offset + i]);
+      if(b < p.bins){
+         if(private_bins){
+            atomicAdd(local_bins[b], 1u);
+         } else {
+            atomicAdd(dst[p.dst_offset + b], 1u);
+         }
+      }
+   }
+   if(private_bins){
+      barrier();
+      for(uint b = lid; b < p.bins; b += gl_WorkGroupSize.x){
+         const uint c = local_bins[b];
+         if(c != 0u){
+            atomicAdd(dst[p.dst_offset + b], c);
+         }
+      }
+   }
+}
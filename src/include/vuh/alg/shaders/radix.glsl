@@ -0,0 +1,140 @@
+// Pass of the LSD radix sort over one 4-bit digit.
+// Keys and values are handled as arrays of 32-bit words, so one binary serves all key types:
+// KEY_WORDS and VAL_WORDS give the element sizes, KEY_KIND selects the order-preserving transform.
+// Workgroup g handles the block of ITEMS*gl_WorkGroupSize.x keys starting at g*block.
+// COUNT mode writes the digit histogram of the block to counts[digit*n_blocks + g].
+// SCATTER mode moves the keys (and values) of the block to the positions given by the
+// exclusive scan of counts and the stable rank of the key within the block.
+
+layout(local_size_x_id = 0) in;                // workgroup size
+layout(constant_id = 1) const uint KEY_WORDS = 1u;
+layout(constant_id = 2) const uint KEY_KIND = 0u;  // 0 - unsigned, 1 - signed, 2 - floating point
+layout(constant_id = 3) const uint VAL_WORDS = 0u; // 0 if sorting keys only
+const uint ITEMS = 4u;                         // keys per invocation
+const uint RADIX = 16u;                        // number of digit values
+const uint SCATTER = 1u;
+
+layout(push_constant) uniform Parameters {
+   uint n;             // number of keys
+   uint n_blocks;      // number of blocks
+   uint shift;         // position of the digit in the key
+   uint first_group;   // index of the first block handled by this dispatch
+   uint src_offset;    // offset (elements) of the first key in src_keys
+   uint dst_offset;    // offset (elements) of the first key in dst_keys
+   uint val_src_offset;
+   uint val_dst_offset;
+   uint counts_offset; // offset (elements) of the histogram in counts
+   uint flags;         // SCATTER
+} p;
+
+layout(std430, binding = 0) readonly buffer SrcKeys { uint src_keys[]; };
+layout(std430, binding = 1) writeonly buffer DstKeys { uint dst_keys[]; };
+layout(std430, binding = 2) readonly buffer SrcVals { uint src_vals[]; };
+layout(std430, binding = 3) writeonly buffer DstVals { uint dst_vals[]; };
+layout(std430, binding = 4) buffer Counts { uint counts[]; };
+
+shared uint hist[RADIX];                       // block histogram (COUNT) or digit offsets (SCATTER)
+shared uvec4 scan_lo[gl_WorkGroupSize.x];      // packed per-invocation counts of digits 0..7
+shared uvec4 scan_hi[gl_WorkGroupSize.x];      // packed per-invocation counts of digits 8..15
+
+/// @return word w of the key with the order-preserving transform applied
+uint key_word(uint key, uint w){
+   const uint msw = (src_keys[(p.src_offset + key)*KEY_WORDS + KEY_WORDS - 1u] & 0x80000000u) != 0u ? 1u : 0u;
+   uint word = src_keys[(p.src_offset + key)*KEY_WORDS + w];
+   if(KEY_KIND == 2u && msw != 0u){
+      return ~word;                            // negative floats sort in reverse
+   }
+   if(KEY_KIND != 0u && w == KEY_WORDS - 1u){
+      word ^= 0x80000000u;
+   }
+   return word;
+}
+
+/// @return digit of the key at position p.shift
+uint digit(uint key){
+   return (key_word(key, p.shift/32u) >> (p.shift % 32u)) & (RADIX - 1u);
+}
+
+// Digit counts are packed as 16-bit fields, two digits per uvec4 component.
+uint get_count(uvec4 lo, uvec4 hi, uint d){
+   const uvec4 v = d < 8u ? lo : hi;
+   return (v[(d & 7u) >> 1u] >> ((d & 1u)*16u)) & 0xffffu;
+}
+
+void add_count(inout uvec4 lo, inout uvec4 hi, uint d){
+   const uint one = 1u << ((d & 1u)*16u);
+   if(d < 8u){ lo[(d & 7u) >> 1u] += one; } else { hi[(d & 7u) >> 1u] += one; }
+}
+
+void count_pass(uint group, uint first){
+   const uint lid = gl_LocalInvocationID.x;
+   if(lid < RADIX){
+      hist[lid] = 0u;
+   }
+   barrier();
+   for(uint i = 0u; i < ITEMS; ++i){
+      const uint k = first + lid*ITEMS + i;
+      if(k < p.n){
+         atomicAdd(hist[digit(k)], 1u);
+      }
+   }
+   barrier();
+   if(lid < RADIX){
+      counts[p.counts_offset + lid*p.n_blocks + group] = hist[lid];
+   }
+}
+
+void scatter_pass(uint group, uint first){
+   const uint lid = gl_LocalInvocationID.x;
+   if(lid < RADIX){
+      hist[lid] = counts[p.counts_offset + lid*p.n_blocks + group];
+   }
+   uvec4 lo = uvec4(0u);
+   uvec4 hi = uvec4(0u);
+   uint d[ITEMS];
+   uint rank[ITEMS];                           // rank among the same digits of this invocation
+   for(uint i = 0u; i < ITEMS; ++i){
+      const uint k = first + lid*ITEMS + i;
+      d[i] = k < p.n ? digit(k) : RADIX;
+      if(d[i] < RADIX){
+         rank[i] = get_count(lo, hi, d[i]);
+         add_count(lo, hi, d[i]);
+      }
+   }
+   // exclusive scan of the packed counts over the invocations (Hillis-Steele)
+   scan_lo[lid] = lo;
+   scan_hi[lid] = hi;
+   barrier();
+   for(uint s = 1u; s < gl_WorkGroupSize.x; s <<= 1){
+      const uvec4 y_lo = lid >= s ? scan_lo[lid - s] : uvec4(0u);
+      const uvec4 y_hi = lid >= s ? scan_hi[lid - s] : uvec4(0u);
+      barrier();
+      scan_lo[lid] += y_lo;
+      scan_hi[lid] += y_hi;
+      barrier();
+   }
+   const uvec4 before_lo = scan_lo[lid] - lo;
+   const uvec4 before_hi = scan_hi[lid] - hi;
+   for(uint i = 0u; i < ITEMS; ++i){
+      if(d[i] < RADIX){
+         const uint src = first + lid*ITEMS + i;
+         const uint dst = hist[d[i]] + get_count(before_lo, before_hi, d[i]) + rank[i];
+         for(uint w = 0u; w < KEY_WORDS; ++w){
+            dst_keys[(p.dst_offset + dst)*KEY_WORDS + w] = src_keys[(p.src_offset + src)*KEY_WORDS + w];
+         }
+         for(uint w = 0u; w < VAL_WORDS; ++w){
+            dst_vals[(p.val_dst_offset + dst)*VAL_WORDS + w] = src_vals[(p.val_src_offset + src)*VAL_WORDS + w];
+         }
+      }
+   }
+}
+
+void main(){
+   const uint group = p.first_group + gl_WorkGroupID.x;
+   const uint first = group*gl_WorkGroupSize.x*ITEMS;
+   if((p.flags & SCATTER) != 0u){
+      scatter_pass(group, first);
+   } else {
+      count_pass(group, first);
+   }
+}
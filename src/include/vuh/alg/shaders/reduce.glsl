@@ -0,0 +1,82 @@
+// Single pass of the device-wide reduction.
+// Workgroup i reduces elements [i*chunk, min((i + 1)*chunk, n)) of src to dst[i].
+// The host repeats passes over the partial results till a single value remains.
+//
+// Custom operations are compiled from a shader defining the element type (see types.glsl),
+// VUH_REDUCE_OP (name of the associative function T(T, T)) and VUH_REDUCE_IDENTITY
+// and including this file. Custom operations always use the shared memory tree.
+
+#include "types.glsl"
+
+layout(local_size_x_id = 0) in;              // workgroup size, should be a power of 2
+layout(constant_id = 1) const uint OP = 0u;  // 0 - sum, 1 - min, 2 - max, 3 - product
+layout(push_constant) uniform Parameters {
+   uint n;            // number of elements to reduce
+   uint chunk;        // number of elements reduced by one workgroup
+   uint src_offset;   // offset (elements) of the first element in src
+   uint dst_offset;   // offset (elements) of the first result in dst
+} p;
+
+layout(std430, binding = 0) readonly buffer Src { T src[]; };
+layout(std430, binding = 1) writeonly buffer Dst { T dst[]; };
+
+shared T partial[gl_WorkGroupSize.x];        // per-subgroup or per-invocation partial results
+
+#ifdef VUH_REDUCE_OP
+T identity(){ return T(VUH_REDUCE_IDENTITY); }
+T combine(T a, T b){ return VUH_REDUCE_OP(a, b); }
+#else
+T identity(){
+   return OP == 0u ? T(0) : OP == 1u ? T_MAX : OP == 2u ? T_LOWEST : T(1);
+}
+
+T combine(T a, T b){
+   return OP == 0u ? a + b : OP == 1u ? min(a, b) : OP == 2u ? max(a, b) : a*b;
+}
+#endif
+
+#if defined(VUH_SUBGROUP) && !defined(VUH_REDUCE_OP)
+T subgroup_combine(T x){
+   return OP == 0u ? subgroupAdd(x) : OP == 1u ? subgroupMin(x)
+        : OP == 2u ? subgroupMax(x) : subgroupMul(x);
+}
+#endif
+
+void main(){
+   const uint lid = gl_LocalInvocationID.x;
+   const uint first = gl_WorkGroupID.x*p.chunk;
+   const uint last = min(first + p.chunk, p.n);
+   T acc = identity();
+   for(uint i = first + lid; i < last; i += gl_WorkGroupSize.x){ // coalesced strided loads
+      acc = combine(acc, src[p.src_offset + i]);
+   }
+#if defined(VUH_SUBGROUP) && !defined(VUH_REDUCE_OP)
+   acc = subgroup_combine(acc);
+   if(subgroupElect()){
+      partial[gl_SubgroupID] = acc;
+   }
+   barrier();
+   if(gl_SubgroupID == 0u){
+      acc = identity();
+      for(uint i = gl_SubgroupInvocationID; i < gl_NumSubgroups; i += gl_SubgroupSize){
+         acc = combine(acc, partial[i]);
+      }
+      acc = subgroup_combine(acc);
+      if(subgroupElect()){
+         dst[p.dst_offset + gl_WorkGroupID.x] = acc;
+      }
+   }
+#else
+   partial[lid] = acc;
+   barrier();
+   for(uint s = gl_WorkGroupSize.x/2u; s > 0u; s >>= 1){
+      if(lid < s){
+         partial[lid] = combine(partial[lid], partial[lid + s]);
+      }
+      barrier();
+   }
+   if(lid == 0u){
+      dst[p.dst_offset + gl_WorkGroupID.x] = partial[0];
+   }
+#endif
+}
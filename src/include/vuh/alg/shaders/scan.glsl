@@ -0,0 +1,101 @@
+// Pass of the device-wide reduce-then-scan prefix sum.
+// Workgroup g handles the block of ITEMS*gl_WorkGroupSize.x elements starting at g*block.
+// With REDUCE flag the block sum is written to dst[g], otherwise the block is scanned to dst,
+// with CARRY flag carry[g] (exclusive scan of the block sums) is added to the block results.
+// Decoupled look-back is not used since Vulkan gives no forward progress guarantee between workgroups.
+
+#include "types.glsl"
+
+layout(local_size_x_id = 0) in;              // workgroup size
+const uint ITEMS = 4u;                       // elements per invocation
+const uint EXCLUSIVE = 1u;
+const uint CARRY = 2u;
+const uint REDUCE = 4u;
+
+layout(push_constant) uniform Parameters {
+   uint n;             // number of elements
+   uint src_offset;    // offset (elements) of the first element in src
+   uint dst_offset;    // offset (elements) of the first result in dst
+   uint carry_offset;  // offset (elements) of the block carries in carry
+   uint first_group;   // index of the first block handled by this dispatch
+   uint flags;         // EXCLUSIVE | CARRY | REDUCE
+} p;
+
+layout(std430, binding = 0) readonly buffer Src { T src[]; };
+layout(std430, binding = 1) writeonly buffer Dst { T dst[]; };
+layout(std430, binding = 2) readonly buffer Carry { T carry[]; };
+
+shared T tile[gl_WorkGroupSize.x*ITEMS];     // block staged for coalesced loads and stores
+shared T partial[gl_WorkGroupSize.x];        // per-subgroup or per-invocation sums
+
+/// @return sum of x over the invocations of the workgroup with lower index
+T workgroup_exclusive_sum(T x){
+#ifdef VUH_SUBGROUP
+   const T ex = subgroupExclusiveAdd(x);
+   if(gl_SubgroupInvocationID == gl_SubgroupSize - 1u){ // workgroup size is a multiple of subgroup size
+      partial[gl_SubgroupID] = ex + x;
+   }
+   barrier();
+   if(gl_SubgroupID == 0u){
+      T carry_in = T(0);
+      for(uint i = 0u; i < gl_NumSubgroups; i += gl_SubgroupSize){
+         const uint k = i + gl_SubgroupInvocationID;
+         const T s = k < gl_NumSubgroups ? partial[k] : T(0);
+         if(k < gl_NumSubgroups){
+            partial[k] = carry_in + subgroupExclusiveAdd(s);
+         }
+         carry_in += subgroupAdd(s);
+      }
+   }
+   barrier();
+   return ex + partial[gl_SubgroupID];
+#else
+   const uint lid = gl_LocalInvocationID.x;
+   partial[lid] = x;
+   barrier();
+   for(uint s = 1u; s < gl_WorkGroupSize.x; s <<= 1){ // Hillis-Steele inclusive scan
+      const T y = lid >= s ? partial[lid - s] : T(0);
+      barrier();
+      partial[lid] += y;
+      barrier();
+   }
+   return partial[lid] - x;
+#endif
+}
+
+void main(){
+   const uint lid = gl_LocalInvocationID.x;
+   const uint group = p.first_group + gl_WorkGroupID.x;
+   const uint block = gl_WorkGroupSize.x*ITEMS;
+   const uint first = group*block;
+   for(uint i = lid; i < block; i += gl_WorkGroupSize.x){
+      tile[i] = first + i < p.n ? src[p.src_offset + first + i] : T(0);
+   }
+   barrier();
+
+   T v[ITEMS];
+   T acc = T(0);
+   for(uint i = 0u; i < ITEMS; ++i){
+      v[i] = tile[lid*ITEMS + i];
+      acc += v[i];
+   }
+   T prefix = workgroup_exclusive_sum(acc);
+   if((p.flags & REDUCE) != 0u){
+      if(lid == gl_WorkGroupSize.x - 1u){
+         dst[p.dst_offset + group] = prefix + acc;
+      }
+      return;
+   }
+   if((p.flags & CARRY) != 0u){
+      prefix += carry[p.carry_offset + group];
+   }
+   for(uint i = 0u; i < ITEMS; ++i){
+      const T inclusive = prefix + v[i];
+      tile[lid*ITEMS + i] = (p.flags & EXCLUSIVE) != 0u ? prefix : inclusive;
+      prefix = inclusive;
+   }
+   barrier();
+   for(uint i = lid; i < block && first + i < p.n; i += gl_WorkGroupSize.x){
+      dst[p.dst_offset + first + i] = tile[i];
+   }
+}
@@ -0,0 +1,30 @@
+// Element type of the bundled algorithm kernels, selected with one of VUH_F32, VUH_I32, VUH_U32,
+// VUH_F64, VUH_I64, VUH_U64. 64-bit integers need GL_ARB_gpu_shader_int64 enabled by the includer.
+// T_MAX and T_LOWEST are the largest and the lowest values of the type (identities of min and max).
+#if defined(VUH_F32)
+#  define T float
+#  define T_MAX uintBitsToFloat(0x7f800000u)
+#  define T_LOWEST uintBitsToFloat(0xff800000u)
+#elif defined(VUH_I32)
+#  define T int
+#  define T_MAX 0x7fffffff
+#  define T_LOWEST (-0x7fffffff - 1)
+#elif defined(VUH_U32)
+#  define T uint
+#  define T_MAX 0xffffffffu
+#  define T_LOWEST 0u
+#elif defined(VUH_F64)
+#  define T double
+#  define T_MAX packDouble2x32(uvec2(0u, 0x7ff00000u))
+#  define T_LOWEST packDouble2x32(uvec2(0u, 0xfff00000u))
+#elif defined(VUH_I64)
+#  define T int64_t
+#  define T_MAX 0x7fffffffffffffffl
+#  define T_LOWEST (-0x7fffffffffffffffl - 1l)
+#elif defined(VUH_U64)
+#  define T uint64_t
+#  define T_MAX 0xfffffffffffffffful
+#  define T_LOWEST 0ul
+#else
+#  error "element type is not defined, use one of VUH_F32, VUH_I32, VUH_U32, VUH_F64, VUH_I64, VUH_U64"
+#endif
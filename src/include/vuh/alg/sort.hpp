@@ -0,0 +1,168 @@
+#pragma once
+
+#include "kernel.h"
+#include "scan.hpp"
+
+#include <vuh/arr/arrayView.hpp>
+#include <vuh/arr/copy_async.hpp>
+#include <vuh/arr/deviceArray.hpp>
+#include <vuh/delayed.hpp>
+#include <vuh/trace.h>
+
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include <type_traits>
+
+namespace vuh {
+	namespace detail {
+		constexpr auto radix_group_size = uint32_t(256);        ///< workgroup size of the radix kernel
+		constexpr auto radix_block = size_t(radix_group_size)*4; ///< keys handled by one workgroup
+		constexpr auto radix_bits = uint32_t(4);                 ///< bits of the key sorted per pass
+		constexpr auto radix_digits = size_t(1) << radix_bits;   ///< number of digit values
+
+		/// Mode of the radix pass, see radix.glsl
+		enum RadixFlags: uint32_t {
+			radix_count = 0u,   ///< write the digit histograms of the blocks
+			radix_scatter = 1u, ///< move keys to the scanned histogram offsets
+		};
+
+		/// Push constants of the radix kernel.
+		struct RadixPush {
+			uint32_t n;              ///< number of keys
+			uint32_t n_blocks;       ///< number of blocks
+			uint32_t shift;          ///< position of the digit in the key
+			uint32_t first_group;    ///< index of the first block of the dispatch
+			uint32_t src_offset;     ///< offset (elements) of the source keys within the bound range
+			uint32_t dst_offset;     ///< offset (elements) of the destination keys within the bound range
+			uint32_t val_src_offset; ///< offset (elements) of the source values within the bound range
+			uint32_t val_dst_offset; ///< offset (elements) of the destination values within the bound range
+			uint32_t counts_offset;  ///< offset (elements) of the histograms within the bound range
+			uint32_t flags;          ///< RadixFlags
+		};
+
+		/// @return order-preserving transform of the key type applied by the radix kernel:
+		/// 0 - unsigned, 1 - signed integer, 2 - floating point
+		template<class K>
+		constexpr auto radix_key_kind()-> uint32_t {
+			return std::is_floating_point<K>::value ? 2u : (std::is_signed<K>::value ? 1u : 0u);
+		}
+
+		/// @return radix kernel for the key and value types (void for keys only).
+		template<class K, class V>
+		auto radix_kernel(vuh::Device& device)-> const Kernel& {
+			static_assert(std::is_arithmetic<K>::value && (sizeof(K) == 4 || sizeof(K) == 8)
+			              , "sort supports 32- and 64-bit arithmetic keys");
+			const auto val_words = std::is_void<V>::value ? 0u : uint32_t(sizeof(V)/4);
+			return kernel(device, KernelId::Radix, 5, sizeof(RadixPush)
+			              , {radix_group_size, uint32_t(sizeof(K)/4), radix_key_kind<K>(), val_words});
+		}
+
+		/// Record the LSD radix sort of n keys (and values) at given offsets (bytes) of the buffers.
+		/// Each pass sorts by 4 bits of the key: the count pass writes the digit histogram of each block,
+		/// histograms are scanned in digit-major order, so the scatter pass gets for each block and digit
+		/// the position of its first key. Scatter is stable, so passes from the least significant digit
+		/// up sort the whole key. Keys and values ping-pong between the input and the scratch arrays,
+		/// the number of passes is even so the result ends up in the input.
+		/// Values buffer is ignored when val_bytes is 0.
+		/// @throws vuh::BufferRangeExceeded if n does not fit in 32 bits
+		template<class K>
+		auto record_sort(Batch& batch, vuh::Device& device, const Kernel& kernel
+		                 , vk::Buffer keys, size_t keys_offset, vk::Buffer vals, size_t vals_offset
+		                 , size_t val_bytes, size_t n)-> void
+		{
+			requireCount("sort", n);
+			if(n < 2){
+				return;
+			}
+			const auto n_blocks = (n + radix_block - 1)/radix_block;
+			const auto n_counts = radix_digits*n_blocks;
+			const auto& scan = scan_kernel<uint32_t>(device);
+			auto& counts = scratch<uint32_t>(batch, device, n_counts);
+			auto& keys_tmp = scratch<K>(batch, device, n);
+			auto vals_tmp = val_bytes == 0 ? vk::Buffer()
+			                               : vk::Buffer(scratch<uint32_t>(batch, device, n*val_bytes/4));
+			const auto cnt = binding(device, counts, 0, n_counts*sizeof(uint32_t), sizeof(uint32_t));
+			const auto key_bind = [&](vk::Buffer b, size_t offset){
+				return binding(device, b, offset, n*sizeof(K), sizeof(K));
+			};
+			const auto val_bind = [&](vk::Buffer b, size_t offset){
+				return val_bytes == 0 ? Binding{} : binding(device, b, offset, n*val_bytes, val_bytes);
+			};
+			Binding key_io[] = {key_bind(keys, keys_offset), key_bind(keys_tmp, 0)};
+			Binding val_io[] = {val_bind(vals, vals_offset), val_bind(vals_tmp, 0)};
+			for(uint32_t shift = 0; shift < 8*sizeof(K); shift += radix_bits){
+				const auto pass = (shift/radix_bits) % 2;
+				const auto& src = key_io[pass];
+				const auto& dst = key_io[1 - pass];
+				// keys are bound in place of the values when sorting keys only
+				const auto& vsrc = val_bytes == 0 ? src : val_io[pass];
+				const auto& vdst = val_bytes == 0 ? dst : val_io[1 - pass];
+				auto push = RadixPush{uint32_t(n), uint32_t(n_blocks), shift, 0, src.offset, dst.offset
+				                      , vsrc.offset, vdst.offset, cnt.offset, radix_count};
+				const auto buffers = {src.info, dst.info, vsrc.info, vdst.info, cnt.info};
+				dispatch_groups(batch, device, kernel, buffers, push, n_blocks);
+				record_scan<uint32_t>(batch, device, scan, counts, 0, counts, 0, n_counts, true);
+				push.flags = radix_scatter;
+				dispatch_groups(batch, device, kernel, buffers, push, n_blocks);
+			}
+		}
+	} // namespace detail
+
+	/// Sort the keys of the array view in ascending order.
+	/// Runs the multi-pass radix sort on the device of the view, scratch buffers are allocated
+	/// internally and released when the returned token is destroyed.
+	/// Supported key types are 32- and 64-bit integers and floating point numbers.
+	/// Floating point keys are ordered by their bits: -0 goes before 0, NaNs go to the ends.
+	template<class Array>
+	auto sort(const ArrayView<Array>& keys)-> vuh::Delayed<Copy> {
+		VUH_TRACE_SCOPE("sort", "compute");
+		using K = typename Array::value_type;
+		auto& device = keys.device();
+		const auto& k = detail::radix_kernel<K, void>(device);
+		auto batch = detail::Batch(device);
+		detail::record_sort<K>(batch, device, k, keys.array(), keys.offset_bytes()
+		                       , vk::Buffer(), 0, 0, keys.size());
+		auto fence = batch.submit();
+		return vuh::Delayed<Copy>{fence, device, Copy::wrap(std::move(batch))};
+	}
+
+	/// Sort the whole device array in ascending order.
+	template<class T, class Alloc>
+	auto sort(arr::DeviceArray<T, Alloc>& keys)-> vuh::Delayed<Copy> {
+		return sort(array_view(keys, 0, keys.size()));
+	}
+
+	/// Sort the keys in ascending order and reorder the values along with them.
+	/// Sort is stable, values of equal keys keep their relative order.
+	/// Values are 32- or 64-bit of any type, views should be of the same size and on the same device.
+	/// @throws vuh::BufferRangeExceeded if the views differ in size
+	/// @throws vuh::DeviceMismatch if the views are on different devices
+	template<class Array1, class Array2>
+	auto sort_by_key(const ArrayView<Array1>& keys, const ArrayView<Array2>& values)-> vuh::Delayed<Copy> {
+		VUH_TRACE_SCOPE("sort_by_key", "compute");
+		using K = typename Array1::value_type;
+		using V = typename Array2::value_type;
+		static_assert(sizeof(V) == 4 || sizeof(V) == 8, "sort_by_key supports 32- and 64-bit values");
+		auto& device = keys.device();
+		detail::requireSameDevice("sort_by_key", values.device(), device);
+		if(values.size() != keys.size()){
+			throw BufferRangeExceeded("sort_by_key of " + std::to_string(keys.size()) + " keys got "
+			                          + std::to_string(values.size()) + " values");
+		}
+		const auto& k = detail::radix_kernel<K, V>(device);
+		auto batch = detail::Batch(device);
+		detail::record_sort<K>(batch, device, k, keys.array(), keys.offset_bytes()
+		                       , values.array(), values.offset_bytes(), sizeof(V), keys.size());
+		auto fence = batch.submit();
+		return vuh::Delayed<Copy>{fence, device, Copy::wrap(std::move(batch))};
+	}
+
+	/// Sort the whole device array of keys and reorder the array of values along with them.
+	template<class K, class Alloc1, class V, class Alloc2>
+	auto sort_by_key(arr::DeviceArray<K, Alloc1>& keys, arr::DeviceArray<V, Alloc2>& values
+	                 )-> vuh::Delayed<Copy>
+	{
+		return sort_by_key(array_view(keys, 0, keys.size()), array_view(values, 0, values.size()));
+	}
+} // namespace vuh
@@ -3,6 +3,7 @@
 #include <vuh/device.h>
 #include <vuh/error.h>
 #include <vuh/instance.h>
+#include <vuh/trace.h>
 
 #include <vulkan/vulkan.hpp>
 
@@ -30,21 +31,35 @@ public:
 		return device.createBuffer({ {}, size_bytes, flags_combined});
 	}
 
-	/// Allocate memory for the buffer.
+	/// Allocate memory for the buffer or image.
+	template<class Handle>
 	auto allocMemory(vuh::Device& device  ///< device to allocate memory
-	                 , vk::Buffer buffer  ///< buffer to allocate memory for
+	                 , const Handle& buffer ///< buffer (or image) to allocate memory for
 	                 , vk::MemoryPropertyFlags flags_memory={} ///< additional (to the ones defined in Props) memory property flags
 	                 )-> vk::DeviceMemory 
 	{
-		_memid = findMemory(device, buffer, flags_memory);
+		return allocMemory(device, memoryRequirements(device, buffer), flags_memory);
+	}
+
+	/// Allocate memory satisfying given requirements.
+	/// Requirements are passed down the fallback chain as is, so they are only queried once.
+	auto allocMemory(vuh::Device& device  ///< device to allocate memory
+	                 , const vk::MemoryRequirements& reqs ///< memory requirements of the buffer (or image)
+	                 , vk::MemoryPropertyFlags flags_memory={} ///< additional (to the ones defined in Props) memory property flags
+	                 )-> vk::DeviceMemory
+	{
+		VUH_TRACE_SCOPE("AllocDevice::allocMemory", "memory");
+		_memid = findMemory(device, reqs, flags_memory);
 		auto mem = vk::DeviceMemory{};
 		try{
-			mem = device.allocateMemory({device.getBufferMemoryRequirements(buffer).size, _memid});
+			mem = device.allocMemory(_memid, reqs.size);
+		} catch (MemoryBudgetExceeded&){ // hard limit set by the user, do not spill to other heaps
+			throw;
 		} catch (vk::Error& e){
 			auto allocFallback = AllocFallback{};
 			device.instance().report("AllocDevice failed to allocate memory, using fallback", e.what()
 			                         , VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT);
-			mem = allocFallback.allocMemory(device, buffer, flags_memory);
+			mem = allocFallback.allocMemory(device, reqs, flags_memory);
 			_memid = allocFallback.memId();
 		}
 		return mem;
@@ -68,12 +83,23 @@ public:
 	/// was originally requested but not available on a given device.
 	/// This would only be reported through reporter associated with Instance, and no error
 	/// raised.
+	template<class Handle>
 	static auto findMemory(const vuh::Device& device ///< device on which to search for suitable memory
-	                       , vk::Buffer buffer       ///< buffer to find suitable memory for
+	                       , const Handle& buffer    ///< buffer (or image) to find suitable memory for
 	                       , vk::MemoryPropertyFlags flags_memory={} ///< additional memory flags
 	                       )-> uint32_t 
 	{
-		auto memid = device.selectMemory(buffer
+		return findMemory(device, memoryRequirements(device, buffer), flags_memory);
+	}
+
+	/// @return id of the first memory matching given requirements and Props.
+	/// Same as above, but requirements are queried by the caller.
+	static auto findMemory(const vuh::Device& device ///< device on which to search for suitable memory
+	                       , const vk::MemoryRequirements& reqs ///< memory requirements of the buffer (or image)
+	                       , vk::MemoryPropertyFlags flags_memory={} ///< additional memory flags
+	                       )-> uint32_t
+	{
+		auto memid = device.selectMemoryType(reqs.memoryTypeBits
 		                           , vk::MemoryPropertyFlags(vk::MemoryPropertyFlags(Props::memory)
 		                             | flags_memory));
 		if(memid != uint32_t(-1)){
@@ -81,7 +107,17 @@ public:
 		}
 		device.instance().report("AllocDevice could not find desired memory type, using fallback", " "
 		                         , VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT);
-		return AllocFallback::findMemory(device, buffer, flags_memory);
+		return AllocFallback::findMemory(device, reqs, flags_memory);
+	}
+private: // helpers
+	/// @return memory requirements of the buffer
+	static auto memoryRequirements(const vuh::Device& device, vk::Buffer buffer)-> vk::MemoryRequirements {
+		return device.getBufferMemoryRequirements(buffer);
+	}
+
+	/// @return memory requirements of the image
+	static auto memoryRequirements(const vuh::Device& device, vk::Image image)-> vk::MemoryRequirements {
+		return device.getImageMemoryRequirements(image);
 	}
 private: // data
 	uint32_t _memid = uint32_t(-1); ///< allocated memory id
@@ -96,13 +132,15 @@ public:
 	using properties_t = void;
 	
 	/// @throws vk::OutOfDeviceMemoryError
-	auto allocMemory(vuh::Device&, vk::Buffer, vk::MemoryPropertyFlags)-> vk::DeviceMemory {
+	template<class Handle>
+	auto allocMemory(vuh::Device&, const Handle&, vk::MemoryPropertyFlags)-> vk::DeviceMemory {
 		throw vk::OutOfDeviceMemoryError("failed to allocate device memory"
 		                                 " and no fallback available");
 	}
 	
 	/// @throws vuh::NoSuitableMemoryFound
-	static auto findMemory(const vuh::Device&, vk::Buffer, vk::MemoryPropertyFlags flags
+	template<class Handle>
+	static auto findMemory(const vuh::Device&, const Handle&, vk::MemoryPropertyFlags flags
 	                       )-> uint32_t
 	{
 		throw NoSuitableMemoryFound("no memory with flags " + std::to_string(uint32_t(flags))
@@ -12,5 +12,23 @@ namespace arr {
 	             , size_t src_offset=0
 	             , size_t dst_offset=0
 	             )-> void;
+
+	auto imageRegion(vk::Extent2D extent)-> vk::BufferImageCopy;
+
+	auto imageBarrier(vk::CommandBuffer cmd_buf, vk::Image image
+	                  , vk::ImageLayout old_layout, vk::ImageLayout new_layout
+	                  )-> void;
+
+	auto initImageLayout(vuh::Device& device, vk::Image image, vk::ImageLayout layout)-> void;
+
+	auto copyBufToImage(vuh::Device& device
+	                    , vk::Buffer src, vk::Image dst
+	                    , vk::Extent2D extent
+	                    )-> void;
+
+	auto copyImageToBuf(vuh::Device& device
+	                    , vk::Image src, vk::Buffer dst
+	                    , vk::Extent2D extent
+	                    )-> void;
 } // namespace arr
 } // namespace vuh
@@ -1,11 +1,17 @@
 #pragma once
 
+#include "arrayIter.hpp"
+
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 
 namespace vuh {
 	/// Read-write view into the continuous portion of some vuh::Array
 	/// Maybe used in place of array references in copy routines and kernel invocations
 	/// to pass parts of the array data.
+	/// When bound to a kernel the view offset (bytes) should be a multiple of the device
+	/// minStorageBufferOffsetAlignment (minUniformBufferOffsetAlignment for uniform buffers).
 	template<class Array>
 	class ArrayView {
 	public:
@@ -16,16 +22,57 @@ namespace vuh {
 		/// Constructor
 		explicit ArrayView(Array& array, std::size_t offset_begin, std::size_t offset_end)
 		   : _array(&array), _offset_begin(offset_begin), _offset_end(offset_end)
-		{}
+		{
+			assert(offset_begin <= offset_end);
+		}
 
 		/// @return reference to Vulkan buffer of the corresponding array
 		auto buffer()-> vk::Buffer& { return *_array; }
+		/// @return reference to the underlying array
+		auto array() const-> Array& { return *_array; }
+		/// @return reference to device on which the underlying array is allocated
+		auto device() const-> vuh::Device& { return _array->device(); }
 		/// @return offset (number of elements) of the beggining of the span wrt to buffer
 		auto offset() const-> std::size_t {return _offset_begin;}
+		/// @return offset (bytes) of the beggining of the span wrt to buffer
+		auto offset_bytes() const-> std::size_t {return _offset_begin*sizeof(value_type);}
 		/// @return number of elements in the view
 		auto size() const-> std::size_t {return _offset_end - _offset_begin;}
 		/// @return number of bytes in the view
 		auto size_bytes() const-> std::size_t {return size()*sizeof(value_type);}
+
+		/// @return view of the [first, last) elements of this view
+		auto subview(std::size_t first, std::size_t last) const-> ArrayView {
+			assert(first <= last && last <= size());
+			return ArrayView(*_array, _offset_begin + first, _offset_begin + last);
+		}
+
+		/// @return iterator to the beginning of the view, used in device-side copies
+		auto device_begin() const-> ArrayIter<Array> { return ArrayIter<Array>(*_array, _offset_begin); }
+		/// @return iterator to the end of the view, used in device-side copies
+		auto device_end() const-> ArrayIter<Array> { return ArrayIter<Array>(*_array, _offset_end); }
+
+		/// Copy data from host range to the view. At most size() elements are copied.
+		template<class It1, class It2>
+		auto fromHost(It1 begin, It2 end)-> void {
+			const auto n = std::min(std::size_t(std::distance(begin, end)), size());
+			_array->fromHost(begin, std::next(begin, std::ptrdiff_t(n)), _offset_begin);
+		}
+
+		/// Copy the view data to host location indicated by iterator.
+		template<class DstIter>
+		auto toHost(DstIter dst_begin) const-> void {
+			_array->rangeToHost(_offset_begin, _offset_end, dst_begin);
+		}
+
+		/// @return host container with a copy of the view data.
+		template<class C>
+		auto toHost() const-> C {
+			auto r = C(size());
+			using std::begin;
+			toHost(begin(r));
+			return r;
+		}
 	private: // data
 		Array* _array;             ///< referes to underlying array object
 		std::size_t _offset_begin; ///< offset (number of array elements) of the beginning of the span
@@ -37,4 +84,12 @@ namespace vuh {
 	auto array_view(Array& array, std::size_t offset_begin, size_t offset_end)-> ArrayView<Array>{
 		return ArrayView<Array>(array, offset_begin, offset_end);
 	}
+
+	/// @return iterator to the beginning of the view
+	template<class Array>
+	auto device_begin(const ArrayView<Array>& view)-> ArrayIter<Array> { return view.device_begin(); }
+
+	/// @return iterator to the end of the view
+	template<class Array>
+	auto device_end(const ArrayView<Array>& view)-> ArrayIter<Array> { return view.device_end(); }
 } // namespace vuh
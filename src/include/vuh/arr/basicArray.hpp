@@ -11,6 +11,13 @@
 namespace vuh {
 namespace arr {
 
+/// Host mapping policy of the host-visible arrays.
+enum class MapPolicy {
+	Lazy,       ///< map on the first host access and keep mapped till the array is destroyed
+	Persistent, ///< map once at construction (or policy change) and keep mapped for the array lifetime
+	Transient   ///< map for each host transfer and unmap right after it
+};
+
 /// Covers basic array functionality. Wraps the SBO buffer.
 /// Keeps the data, handles initialization, copy/move, common interface,
 /// binding memory to buffer objects, etc...
@@ -28,8 +35,21 @@ BasicArray() : _dev(*__nulldevice) { }
 	           , size_t size_bytes                     ///< desired size in bytes
 	           , vk::MemoryPropertyFlags properties ///< additional memory property flags. These are 'added' to flags defind by allocator.
 	           , vk::BufferUsageFlags usage         ///< additional usage flagsws. These are 'added' to flags defined by allocator.
-	           , Alloc *)
-	   : vk::Buffer(Alloc::makeBuffer(device, size_bytes, descriptor_flags | usage))
+	           , Alloc *alloc)
+	   : BasicArray(alloc, device, size_bytes, properties, descriptor_flags | usage)
+	{}
+protected:
+	/// Construct array of given size in device memory with exactly given usage flags
+	/// (on top of those defined by allocator).
+	/// Used by arrays binding as descriptors other than storage buffers.
+    template<class Alloc>
+	BasicArray(Alloc *                              ///< allocator type tag
+	           , vuh::Device& device                ///< device to allocate array
+	           , size_t size_bytes                  ///< desired size in bytes
+	           , vk::MemoryPropertyFlags properties ///< additional memory property flags. These are 'added' to flags defind by allocator.
+	           , vk::BufferUsageFlags usage         ///< buffer usage flags, incl. the descriptor usage
+	           )
+	   : vk::Buffer(Alloc::makeBuffer(device, size_bytes, usage))
        , _size_bytes(size_bytes)
 	   , _dev(device)
    {
@@ -43,7 +63,7 @@ BasicArray() : _dev(*__nulldevice) { }
          throw;
       }
 	}
-
+public:
 	/// Release resources associated with current object.
 	~BasicArray() noexcept {release();}
    
@@ -53,8 +73,10 @@ BasicArray() : _dev(*__nulldevice) { }
 	/// Move constructor. Passes the underlying buffer ownership.
 	BasicArray(BasicArray&& other) noexcept
 	   : vk::Buffer(other), _size_bytes(other._size_bytes), _mem(other._mem), _flags(other._flags), _dev(other._dev)
+	   , _mapped(other._mapped), _map_policy(other._map_policy)
 	{
 		static_cast<vk::Buffer&>(other) = nullptr;
+		other._mapped = nullptr;
 	}
 
 	/// @return underlying buffer
@@ -81,33 +103,76 @@ BasicArray() : _dev(*__nulldevice) { }
 		return bool(_flags & vk::MemoryPropertyFlagBits::eHostCoherent);
 	}
 
-    bool flush_mapped_writes() {
+	/// Make host writes to the mapped memory range visible to device.
+	/// Noop for host-coherent memory. Range is extended to the nonCoherentAtomSize boundaries.
+	/// @return true on success
+	bool flush_mapped_writes(size_t offset_bytes=0               ///< offset of the written range
+	                         , size_t size_bytes=VK_WHOLE_SIZE   ///< size of the written range, VK_WHOLE_SIZE for the rest of array
+	                         ) const
+	{
 		assert(isHostVisible());
-        if (!isHostCoherent()) {
-            vk::MappedMemoryRange memr(_mem, 0, VK_WHOLE_SIZE);
-            return vk::Result::eSuccess == _dev.get().invalidateMappedMemoryRanges(1, &memr);
-        }
-        return true;
+		if (!isHostCoherent()) {
+			const auto memr = mapped_range(offset_bytes, size_bytes);
+			return vk::Result::eSuccess == _dev.get().flushMappedMemoryRanges(1, &memr);
+		}
+		return true;
 	}
-    bool invalidate_mapped_cache() const
-    {
-        if (!isHostCoherent()) {
-            vk::MappedMemoryRange memr(_mem, 0, VK_WHOLE_SIZE);
-            return vk::Result::eSuccess == _dev.get().flushMappedMemoryRanges(1, &memr);
-        }
-        return true;
-    }
+
+	/// Make device writes to the memory range visible to host through the mapped pointer.
+	/// Noop for host-coherent memory. Range is extended to the nonCoherentAtomSize boundaries.
+	/// @return true on success
+	bool invalidate_mapped_cache(size_t offset_bytes=0             ///< offset of the range to be read
+	                             , size_t size_bytes=VK_WHOLE_SIZE ///< size of the range, VK_WHOLE_SIZE for the rest of array
+	                             ) const
+	{
+		assert(isHostVisible());
+		if (!isHostCoherent()) {
+			const auto memr = mapped_range(offset_bytes, size_bytes);
+			return vk::Result::eSuccess == _dev.get().invalidateMappedMemoryRanges(1, &memr);
+		}
+		return true;
+	}
+	/// @return host pointer to the array memory. Maps the memory if it is not mapped yet.
+	/// Pointer stays valid till unmapMemory() is called (explicitly or by a transfer of
+	/// an array with Transient map policy).
     template<typename T>
     T* mapMemory() const
     {
         assert(isHostVisible());
-        return static_cast<T*>(_dev.get().mapMemory(_mem, 0, size_bytes()));
+        if(!_mapped){
+            _mapped = _dev.get().mapMemory(_mem, 0, size_bytes());
+        }
+        return static_cast<T*>(_mapped);
     }
+	/// Unmap the array memory. Noop if it is not mapped.
     void unmapMemory() const
     {
-        _dev.get().unmapMemory(_mem);
+        if(_mapped){
+            _dev.get().unmapMemory(_mem);
+            _mapped = nullptr;
+        }
     }
 
+	/// @return true if array memory is currently mapped to host
+	auto isMapped() const-> bool { return _mapped != nullptr; }
+
+	/// @return host mapping policy
+	auto map_policy() const-> MapPolicy { return _map_policy; }
+
+	/// Set the host mapping policy. Persistent maps the host-visible memory right away,
+	/// Transient unmaps it if currently mapped (invalidating pointers obtained before).
+	auto set_map_policy(MapPolicy policy)-> void {
+		_map_policy = policy;
+		if(!isHostVisible()){
+			return;
+		}
+		if(policy == MapPolicy::Persistent){
+			mapMemory<void>();
+		} else if(policy == MapPolicy::Transient){
+			unmapMemory();
+		}
+	}
+
 	/// Move assignment. 
 	/// Resources associated with current array are released immidiately (and not when moved from
 	/// object goes out of scope).
@@ -117,6 +182,9 @@ BasicArray() : _dev(*__nulldevice) { }
 		_mem = other._mem;
 		_flags = other._flags;
 		_dev = other._dev;
+		_mapped = other._mapped;
+		_map_policy = other._map_policy;
+		other._mapped = nullptr;
 		reinterpret_cast<vk::Buffer&>(*this) = reinterpret_cast<vk::Buffer&>(other);
 		reinterpret_cast<vk::Buffer&>(other) = nullptr;
 		return *this;
@@ -130,13 +198,31 @@ BasicArray() : _dev(*__nulldevice) { }
 		swap(_mem, other._mem);
 		swap(_flags, other._flags);
 		swap(_dev, other._dev);
+		swap(_mapped, other._mapped);
+		swap(_map_policy, other._map_policy);
 	}
 
 private: // helpers
+	/// @return memory range covering given byte range of the array,
+	/// extended to the nonCoherentAtomSize boundaries as required for flush/invalidate.
+	auto mapped_range(size_t offset_bytes, size_t size_bytes) const-> vk::MappedMemoryRange {
+		const auto atom = size_t(_dev.get().limits().nonCoherentAtomSize);
+		const auto begin = offset_bytes/atom*atom;
+		if(size_bytes == VK_WHOLE_SIZE || offset_bytes + size_bytes >= _size_bytes){
+			return vk::MappedMemoryRange(_mem, begin, VK_WHOLE_SIZE);
+		}
+		const auto end = (offset_bytes + size_bytes + atom - 1)/atom*atom;
+		if(end >= _size_bytes){ // allocation size is unknown here, so can not round past the array end
+			return vk::MappedMemoryRange(_mem, begin, VK_WHOLE_SIZE);
+		}
+		return vk::MappedMemoryRange(_mem, begin, end - begin);
+	}
+
 	/// release resources associated with current BasicArray object
 	auto release() noexcept-> void {
 		if(static_cast<vk::Buffer&>(*this)){
-            _dev.get().freeMemory(_mem);
+            unmapMemory();
+            _dev.get().releaseMemory(_mem);
             _dev.get().destroyBuffer(*this);
 		}
 	}
@@ -145,7 +231,15 @@ protected: // data
 	vk::DeviceMemory _mem;           ///< associated chunk of device memory
 	vk::MemoryPropertyFlags _flags;  ///< actual flags of allocated memory (may differ from those requested)
     std::reference_wrapper<vuh::Device> _dev;               ///< referes underlying logical device
-    bool require_unmap_flush = false;
+    mutable void* _mapped = nullptr;           ///< host pointer to the mapped memory, null if not mapped
+    MapPolicy _map_policy = MapPolicy::Lazy;   ///< host mapping policy
+protected: // helpers
+	/// Unmap memory after the host transfer if the map policy is Transient.
+	auto unmap_transient() const-> void {
+		if(_map_policy == MapPolicy::Transient){
+			unmapMemory();
+		}
+	}
 }; // class BasicArray
 } // namespace arr
 } // namespace vuh
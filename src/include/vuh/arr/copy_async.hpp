@@ -1,40 +1,53 @@
 #pragma once
 
 #include "arrayIter.hpp"
+#include "arrayView.hpp"
 #include "deviceArray.hpp"
+#include "image2D.hpp"
 #include <vuh/delayed.hpp>
+#include <vuh/error.h>
+#include <vuh/profile.hpp>
 #include <vuh/traits.hpp>
 #include <vuh/resource.hpp>
+#include <vuh/trace.h>
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace vuh {
 	namespace detail {
 		/// Command buffer data packed with allocation and deallocation methods.
 		struct _CmdBuffer {
 			/// Constructor. Creates the new command buffer on a provided device and manages its resources.
-			_CmdBuffer(vuh::Device& device): device(&device){
-				auto bufferAI = vk::CommandBufferAllocateInfo(device.transferCmdPool()
-																			 , vk::CommandBufferLevel::ePrimary, 1);
+			_CmdBuffer(vuh::Device& device): _CmdBuffer(device, device.transferCmdPool()){}
+
+			/// Constructor. Creates the new command buffer in a given pool of the provided device.
+			_CmdBuffer(vuh::Device& device, vk::CommandPool pool): pool(pool), device(&device){
+				auto bufferAI = vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1);
 				cmd_buffer = device.allocateCommandBuffers(bufferAI)[0];
 			}
 
 			/// Constructor. Takes ownership over the provided buffer.
-			/// @pre buffer should belong to the provided device. No check is made even in a debug build.
+			/// @pre buffer should belong to the transfer pool of the provided device.
+			/// No check is made even in a debug build.
 			_CmdBuffer(vuh::Device& device, vk::CommandBuffer buffer)
-				: cmd_buffer(buffer), device(&device)
+				: cmd_buffer(buffer), pool(device.transferCmdPool()), device(&device)
 			{}
 
 			/// Release the buffer resources
 			auto release() noexcept-> void {
 				if(device){
-					device->freeCommandBuffers(device->transferCmdPool(), 1, &cmd_buffer);
+					device->freeCommandBuffers(pool, 1, &cmd_buffer);
 				}
 			}
 		public: // data
 			vk::CommandBuffer cmd_buffer; ///< command buffer managed by this wrapper class
+			vk::CommandPool pool;         ///< pool the command buffer is allocated from
 			std::unique_ptr<vuh::Device, util::NoopDeleter<vuh::Device>> device; ///< device holding the buffer
 		}; // struct _CmdBuffer
 
@@ -46,11 +59,15 @@ namespace vuh {
 		/// Used to keep that alive till async copy is over.
 		/// The delayed action associated with operator() is a noop.
 		struct CopyDevice: private CmdBuffer {
-			CopyDevice(vuh::Device& device): CmdBuffer(device){}
+			CopyDevice(vuh::Device& device): CmdBuffer(device), timer(device, true){}
 
 			/// delayed operation is a noop
 			constexpr auto operator()() const-> void {}
 
+			/// @return GPU time of the copy (ns), 0 if not profiling.
+			/// @pre copy should be complete.
+			auto elapsed_ns() const-> double { return timer.elapsed_ns(); }
+
 			template<class Array1, class Array2>
 			auto copy_async(ArrayIter<Array1> src_begin, ArrayIter<Array1> src_end
 			                , ArrayIter<Array2> dst_begin
@@ -64,10 +81,22 @@ namespace vuh {
 				              , "array value types should be the same");
 				static constexpr auto tsize = sizeof(value_type_src);
 
-				cmd_buffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
 				auto region = vk::BufferCopy(tsize*src_begin.offset(), tsize*dst_begin.offset()
 				                            , tsize*(src_end - src_begin));
-				cmd_buffer.copyBuffer(src_begin.array(), dst_begin.array(), 1, &region);
+				return copy_async(src_begin.array(), dst_begin.array(), 1, &region);
+			}
+
+			/// Copy all regions between the buffers with a single copy command.
+			/// @pre regions should not overlap in the destination buffer
+			auto copy_async(vk::Buffer src, vk::Buffer dst
+			                , uint32_t n_regions, const vk::BufferCopy* regions
+			                )-> Delayed<>
+			{
+				assert(device);
+				cmd_buffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+				timer.begin(cmd_buffer);
+				cmd_buffer.copyBuffer(src, dst, n_regions, regions);
+				timer.end(cmd_buffer);
 				cmd_buffer.end();
 
 				auto queue = device->transferQueue();
@@ -77,20 +106,182 @@ namespace vuh {
 
 				return Delayed<>{fence, *device};
 			}
+		private: // data
+			TimestampQuery timer; ///< timestamps bracketing the copy, inactive if not profiling
 		}; // struct CopyDevice
 
+		/// Implements the actual async copy between the buffer and the image.
+		/// Commands are recorded to the transient command buffer from the compute pool and
+		/// submitted to the compute queue, so that images never change the queue family ownership.
+		/// The delayed action associated with operator() is a noop.
+		struct CopyImage: private CmdBuffer {
+			CopyImage(vuh::Device& device): CmdBuffer(device, device.computeCmdPool()), timer(device){}
+
+			/// delayed operation is a noop
+			constexpr auto operator()() const-> void {}
+
+			/// @return GPU time of the copy (ns), 0 if not profiling.
+			/// @pre copy should be complete.
+			auto elapsed_ns() const-> double { return timer.elapsed_ns(); }
+
+			/// Copy tightly packed buffer data to the whole image in general layout.
+			auto copy_async(vk::Buffer src, vk::Image dst, vk::Extent2D extent)-> Delayed<> {
+				const auto region = arr::imageRegion(extent);
+				cmd_buffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+				timer.begin(cmd_buffer);
+				arr::imageBarrier(cmd_buffer, dst, vk::ImageLayout::eGeneral, vk::ImageLayout::eGeneral);
+				cmd_buffer.copyBufferToImage(src, dst, vk::ImageLayout::eGeneral, 1, &region);
+				arr::imageBarrier(cmd_buffer, dst, vk::ImageLayout::eGeneral, vk::ImageLayout::eGeneral);
+				timer.end(cmd_buffer);
+				cmd_buffer.end();
+				return submit();
+			}
+
+			/// Copy the whole image in general layout to the buffer, tightly packed.
+			auto copy_async(vk::Image src, vk::Extent2D extent, vk::Buffer dst)-> Delayed<> {
+				const auto region = arr::imageRegion(extent);
+				cmd_buffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+				timer.begin(cmd_buffer);
+				arr::imageBarrier(cmd_buffer, src, vk::ImageLayout::eGeneral, vk::ImageLayout::eGeneral);
+				cmd_buffer.copyImageToBuffer(src, vk::ImageLayout::eGeneral, dst, 1, &region);
+				timer.end(cmd_buffer);
+				cmd_buffer.end();
+				return submit();
+			}
+		private:
+			/// Submit recorded commands to the compute queue.
+			auto submit()-> Delayed<> {
+				assert(device);
+				auto queue = device->computeQueue();
+				auto submit_info = vk::SubmitInfo(0, nullptr, nullptr, 1, &cmd_buffer);
+				auto fence = device->createFence(vk::FenceCreateInfo());
+				queue.submit({submit_info}, fence);
+				return Delayed<>{fence, *device};
+			}
+		private: // data
+			TimestampQuery timer; ///< timestamps bracketing the copy, inactive if not profiling
+		}; // struct CopyImage
+
+		/// Maximal size (bytes) of the data written by a single vkCmdUpdateBuffer.
+		constexpr auto max_update_bytes = size_t(65536);
+
+		/// @return 32-bit pattern filling the buffer with the repeated value
+		template<class T>
+		auto fill_pattern(const T& value)-> uint32_t {
+			static_assert(std::is_trivially_copyable<T>::value, "fill value should be trivially copyable");
+			static_assert(sizeof(uint32_t) % sizeof(T) == 0, "fill value should be 1, 2 or 4 bytes wide");
+			auto r = uint32_t(0);
+			for(size_t i = 0; i < sizeof(r); i += sizeof(T)){
+				std::memcpy(reinterpret_cast<char*>(&r) + i, &value, sizeof(T));
+			}
+			return r;
+		}
+
+		/// Implements the device side fill and update of the buffer range.
+		/// Data never goes through the staging buffers: fill pattern is a command parameter and
+		/// the update data is copied to the command buffer at recording.
+		/// Owns the transient transfer command buffer. The delayed action is a noop.
+		struct FillDevice: private CmdBuffer {
+			/// Constructor. Commands go to the compute queue: vkCmdFillBuffer needs graphics or
+			/// compute capable queue on Vulkan 1.0 (without VK_KHR_maintenance1).
+			FillDevice(vuh::Device& device): CmdBuffer(device, device.computeCmdPool()), timer(device){}
+
+			/// delayed operation is a noop
+			constexpr auto operator()() const-> void {}
+
+			/// @return GPU time of the fill (ns), 0 if not profiling.
+			/// @pre fill should be complete.
+			auto elapsed_ns() const-> double { return timer.elapsed_ns(); }
+
+			/// Fill the buffer range with the repeated 32-bit pattern.
+			/// @pre size_bytes > 0
+			/// @throws vuh::BufferOffsetMisaligned if offset_bytes or size_bytes is not a multiple of 4
+			auto fill_async(vk::Buffer dst, size_t offset_bytes, size_t size_bytes, uint32_t pattern
+			                )-> Delayed<>
+			{
+				checkAligned(offset_bytes, size_bytes);
+				cmd_buffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+				timer.begin(cmd_buffer);
+				cmd_buffer.fillBuffer(dst, offset_bytes, size_bytes, pattern);
+				timer.end(cmd_buffer);
+				cmd_buffer.end();
+				return submit();
+			}
+
+			/// Write host data to the buffer range. Data larger than max_update_bytes is split
+			/// to several update commands within the same command buffer.
+			/// @pre size_bytes > 0
+			/// @throws vuh::BufferOffsetMisaligned if offset_bytes or size_bytes is not a multiple of 4
+			auto update_async(const void* src, size_t size_bytes, vk::Buffer dst, size_t offset_bytes
+			                  )-> Delayed<>
+			{
+				checkAligned(offset_bytes, size_bytes);
+				auto p = static_cast<const char*>(src);
+				cmd_buffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+				timer.begin(cmd_buffer);
+				for(size_t done = 0; done < size_bytes; done += max_update_bytes){
+					const auto m = std::min(max_update_bytes, size_bytes - done);
+					cmd_buffer.updateBuffer(dst, offset_bytes + done, m, p + done);
+				}
+				timer.end(cmd_buffer);
+				cmd_buffer.end();
+				return submit();
+			}
+		private:
+			/// Fill and update commands need both offset and size to be multiples of 4.
+			static auto checkAligned(size_t offset_bytes, size_t size_bytes)-> void {
+				if(offset_bytes % 4 != 0 || size_bytes % 4 != 0){
+					throw BufferOffsetMisaligned("device-side fill/update of " + std::to_string(size_bytes)
+					                             + " bytes at offset " + std::to_string(offset_bytes)
+					                             + " is not aligned to 4 bytes");
+				}
+			}
+
+			/// Submit recorded commands to the compute queue.
+			auto submit()-> Delayed<> {
+				assert(device);
+				auto queue = device->computeQueue();
+				auto submit_info = vk::SubmitInfo(0, nullptr, nullptr, 1, &cmd_buffer);
+				auto fence = device->createFence(vk::FenceCreateInfo());
+				queue.submit({submit_info}, fence);
+				return Delayed<>{fence, *device};
+			}
+		private: // data
+			TimestampQuery timer; ///< timestamps bracketing the commands, inactive if not profiling
+		}; // struct FillDevice
+
+		/// Ring of host-visible bounce buffers on two devices used for the pipelined copies
+		/// between arrays on different devices.
+		/// Keeps the bounce buffers alive till the transfer completes, delayed action is a noop.
+		class PeerStage {
+		public:
+			PeerStage(vuh::Device& src, vuh::Device& dst);
+			PeerStage(PeerStage&&) noexcept;
+			auto operator=(PeerStage&&) noexcept-> PeerStage&;
+			~PeerStage() noexcept;
+
+			auto copy(vk::Buffer src, size_t src_offset, vk::Buffer dst, size_t dst_offset
+			          , size_t size_bytes)-> vk::Fence;
+
+			/// delayed operation is a noop
+			constexpr auto operator()() const-> void {}
+		private:
+			struct Impl;
+			std::unique_ptr<Impl> _impl;
+		}; // class PeerStage
+
 		/// Keeps the staging array and transfer command buffer alive till async copy completes.
 		/// Delayed action is a noop.
 		/// At construction copies the data from host to the staging buffer.
-		template<class T>
-		struct CopyStageFromHost: public CopyDevice {
+		template<class T, class Copier=CopyDevice>
+		struct CopyStageFromHost: public Copier {
 			using StageArray = arr::HostArray<T, arr::AllocDevice<arr::properties::HostCoherent>>;
 			StageArray array; ///< staging buffer
 
 			/// Constructor. Copies data from host to the internal staging buffer.
 			template<class Iter1, class Iter2>
 			CopyStageFromHost(vuh::Device& device, Iter1 src_begin, Iter2 src_end)
-				: CopyDevice(device), array(device, src_begin, src_end)
+				: Copier(device), array(device, src_begin, src_end)
 			{}
 		}; // struct CopyStageFromHost
 
@@ -111,20 +302,22 @@ namespace vuh {
 
 		/// Keeps the staging buffer and the transfer command buffer alive till async copy completes.
 		/// Delayed action copies data from staging buffer to the host.
-		template<class T, class IterDst>
-		struct CopyStageToHost: CopyDevice {
+		template<class T, class IterDst, class Copier=CopyDevice>
+		struct CopyStageToHost: Copier {
 			using StageArray = arr::HostArray<T, arr::AllocDevice<arr::properties::HostCached>>;
 			StageArray array;      ///< staging buffer
 			IterDst    dst_begin;  ///< iterator to beginning of the host destination range
 
 			/// Constructor.
 			explicit CopyStageToHost(vuh::Device& device, std::size_t array_size, IterDst dst_begin)
-			   : CopyDevice(device), array(device, array_size), dst_begin(dst_begin)
+			   : Copier(device), array(device, array_size), dst_begin(dst_begin)
 			{}
 
 			/// Delayed action. Copies data from staging buffer to the host.
 			auto operator()() const-> void {
+				VUH_TRACE_SCOPE("stage to host", "transfer");
 				using std::begin; using std::end;
+				array.invalidate_mapped_cache(0, array.size_bytes());
 				std::copy(begin(array), end(array), dst_begin);
 			}
 		}; // struct StagedCopy
@@ -150,20 +343,93 @@ namespace vuh {
 		class ICopy{
 		public:
 			virtual auto operator()() const-> void = 0;
+			virtual auto elapsed_ns() const-> double = 0;
 			virtual ~ICopy() = default;
 		};
 
+		/// @return GPU time measured by the copy object, if it provides one
+		template<class T>
+		auto elapsed_ns_impl(const T& t, int)-> decltype(t.elapsed_ns()) { return t.elapsed_ns(); }
+		template<class T>
+		auto elapsed_ns_impl(const T&, ...)-> double { return 0.; }
+
 		/// Wraps movable classes with non-virtual operator()(void) const-> void interface to
 		/// a class with ICopy virtual interface.
 		template<class T>
 		class CopyWrapper: public ICopy, private T {
 		public:
 			CopyWrapper(T&& t): T(std::move(t)) {}
-			auto operator()() const-> void override { return T::operator()();}
+			auto operator()() const-> void override {
+				VUH_TRACE_GPU("copy", "transfer", elapsed_ns(), true);
+				return T::operator()();
+			}
+			auto elapsed_ns() const-> double override {
+				return elapsed_ns_impl(static_cast<const T&>(*this), 0);
+			}
 			~CopyWrapper() override = default;
 		};
 	} // namespace detail
 
+	/// Region of the multi-region copy. All values are in elements.
+	struct CopyRegion {
+		size_t src_offset; ///< offset of the region in the source
+		size_t dst_offset; ///< offset of the region in the destination
+		size_t count;      ///< number of elements to copy
+	};
+
+	namespace detail {
+		/// @return true if count elements starting at offset fit in size elements.
+		/// Safe against overflow of offset + count.
+		inline auto range_fits(size_t offset, size_t count, size_t size)-> bool {
+			return offset <= size && count <= size - offset;
+		}
+
+		/// @throw vuh::BufferRangeExceeded if the copy region does not fit in the array of the
+		/// given size (elements) after its offset
+		inline auto check_region(const char* side, size_t offset, size_t count, size_t size)-> void {
+			if(!range_fits(offset, count, size)){
+				throw BufferRangeExceeded(std::string("copy region of ") + std::to_string(count)
+				                          + " elements at " + side + " offset " + std::to_string(offset)
+				                          + " exceeds the " + std::to_string(size) + " elements of the array");
+			}
+		}
+
+		/// @throw vuh::BufferRangeExceeded if n_rows rows of row_size elements, pitch elements
+		/// apart, do not fit in the array of the given size (elements)
+		inline auto check_pitched(const char* side, size_t pitch, size_t row_size, size_t n_rows
+		                          , size_t size)-> void
+		{
+			if(row_size > pitch){
+				throw BufferRangeExceeded("row of " + std::to_string(row_size) + " elements exceeds the "
+				                          + side + " pitch of " + std::to_string(pitch) + " elements");
+			}
+			if(n_rows == 0 || row_size == 0){
+				return;
+			}
+			if(row_size > size || (n_rows - 1) > (size - row_size)/pitch){
+				throw BufferRangeExceeded(std::to_string(n_rows) + " rows with the " + side + " pitch of "
+				                          + std::to_string(pitch) + " elements exceed the "
+				                          + std::to_string(size) + " elements of the array");
+			}
+		}
+	} // namespace detail
+
+	/// @return regions copying n_rows rows of row_size elements between the 2D layouts with
+	/// given row pitches (elements). Rows adjacent in both layouts are merged.
+	inline auto pitch_regions(size_t src_pitch, size_t dst_pitch, size_t row_size, size_t n_rows
+	                          )-> std::vector<CopyRegion>
+	{
+		if(row_size == src_pitch && row_size == dst_pitch){
+			return {CopyRegion{0, 0, row_size*n_rows}};
+		}
+		auto r = std::vector<CopyRegion>{};
+		r.reserve(n_rows);
+		for(size_t i = 0; i < n_rows; ++i){
+			r.push_back({i*src_pitch, i*dst_pitch, row_size});
+		}
+		return r;
+	}
+
 	/// Type erasure over movable classes providing operator()(void) const-> void.
 	/// Used to trigger some action (encoded in that operator()()) and/or extend resources
 	/// lifetime at/till the synchrnonization point.
@@ -184,24 +450,109 @@ namespace vuh {
 			assert(_obj);
 			(*_obj)();
 		}
+
+		/// @return GPU time of the device side of the copy (ns).
+		/// 0 if not profiling (see Device::enableProfiling()) or no device transfer was involved.
+		/// @pre the copy should be complete.
+		auto elapsed_ns() const-> double {
+			assert(_obj);
+			return _obj->elapsed_ns();
+		}
 	private:
 		explicit Copy(std::unique_ptr<detail::ICopy>&& ptr): _obj(std::move(ptr)) {}
 	private:
 		std::unique_ptr<detail::ICopy> _obj; ///< doc me
 	};
 
-	/// Async copy between arrays allocated on the same device
+	/// Async copy between arrays.
+	/// Arrays on different devices are copied in chunks through a ring of host-visible bounce
+	/// buffers, one on each device, so that transfers on both devices and the host copy
+	/// between them overlap. In that case the call blocks till the last chunk is copied
+	/// on host, and only the last upload to the destination device is async.
 	template<class Array1, class Array2>
 	auto copy_async(ArrayIter<Array1> src_begin, ArrayIter<Array1> src_end
 	                , ArrayIter<Array2> dst_begin
 	                )-> vuh::Delayed<Copy>
 	{
+		VUH_TRACE_SCOPE("copy_async", "transfer");
 		auto& src_device = src_begin.array().device();
+		auto& dst_device = dst_begin.array().device();
+		if(src_device != dst_device){
+			using T = typename ArrayIter<Array1>::value_type;
+			static_assert(std::is_same<T, typename ArrayIter<Array2>::value_type>::value
+			              , "array value types should be the same");
+			auto stage = detail::PeerStage(src_device, dst_device);
+			auto fence = stage.copy(src_begin.array(), src_begin.offset()*sizeof(T)
+			                        , dst_begin.array(), dst_begin.offset()*sizeof(T)
+			                        , (src_end - src_begin)*sizeof(T));
+			return Delayed<Copy>{Delayed<>{fence, dst_device}, Copy::wrap(std::move(stage))};
+		}
 		auto copyDevice = detail::CopyDevice(src_device);
 		return Delayed<Copy>{copyDevice.copy_async(src_begin, src_end, dst_begin)
 		                    , Copy::wrap(std::move(copyDevice))};
 	}
 
+	/// Async copy of the list of regions between arrays allocated on the same device.
+	/// Region offsets are counted (in elements) from src_begin and dst_begin.
+	/// All regions are recorded to a single copy command.
+	/// @pre regions should not overlap in the destination array
+	/// @throws vuh::BufferRangeExceeded if any region does not fit in the source or destination array
+	/// @throws vuh::DeviceMismatch if the arrays are allocated on different devices
+	template<class Array1, class Array2>
+	auto copy_async(ArrayIter<Array1> src_begin, ArrayIter<Array2> dst_begin
+	                , const std::vector<CopyRegion>& regions
+	                )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("copy_async regions", "transfer");
+		using T = typename ArrayIter<Array1>::value_type;
+		static_assert(std::is_same<T, typename ArrayIter<Array2>::value_type>::value
+		              , "array value types should be the same");
+		auto& device = src_begin.array().device();
+		if(dst_begin.array().device() != device){
+			throw DeviceMismatch("multi-region copy needs both arrays on the same device");
+		}
+		const auto src_size = src_begin.array().size() - src_begin.offset();
+		const auto dst_size = dst_begin.array().size() - dst_begin.offset();
+		auto buf_regions = std::vector<vk::BufferCopy>{};
+		buf_regions.reserve(regions.size());
+		for(const auto& r: regions){
+			detail::check_region("source", r.src_offset, r.count, src_size);
+			detail::check_region("destination", r.dst_offset, r.count, dst_size);
+			if(r.count > 0){
+				buf_regions.emplace_back((src_begin.offset() + r.src_offset)*sizeof(T)
+				                         , (dst_begin.offset() + r.dst_offset)*sizeof(T)
+				                         , r.count*sizeof(T));
+			}
+		}
+		if(buf_regions.empty()){
+			return Delayed<Copy>{device, Copy::wrap(detail::Noop{})};
+		}
+		auto copyDevice = detail::CopyDevice(device);
+		auto cpy = copyDevice.copy_async(src_begin.array(), dst_begin.array()
+		                                 , uint32_t(buf_regions.size()), buf_regions.data());
+		return Delayed<Copy>{std::move(cpy), Copy::wrap(std::move(copyDevice))};
+	}
+
+	/// Async copy of the 2D block between arrays allocated on the same device.
+	/// Block consists of n_rows rows of row_size elements, consecutive rows are
+	/// src_pitch (dst_pitch) elements apart in the source (destination) array.
+	/// Recorded as a single multi-region copy command.
+	/// @throws vuh::BufferRangeExceeded if row_size exceeds a pitch or the block does not fit
+	/// in the source or destination array
+	/// @throws vuh::DeviceMismatch if the arrays are allocated on different devices
+	template<class Array1, class Array2>
+	auto copy_async_2d(ArrayIter<Array1> src_begin, size_t src_pitch
+	                   , ArrayIter<Array2> dst_begin, size_t dst_pitch
+	                   , size_t row_size, size_t n_rows
+	                   )-> vuh::Delayed<Copy>
+	{
+		detail::check_pitched("source", src_pitch, row_size, n_rows
+		                      , src_begin.array().size() - src_begin.offset());
+		detail::check_pitched("destination", dst_pitch, row_size, n_rows
+		                      , dst_begin.array().size() - dst_begin.offset());
+		return copy_async(src_begin, dst_begin, pitch_regions(src_pitch, dst_pitch, row_size, n_rows));
+	}
+
 	/// Async copy data from host memory to device-local array.
 	/// Blocks while for the duration of initial copy from host memory to host-visible
 	/// staging array.
@@ -214,6 +565,7 @@ namespace vuh {
 	                               , vuh::Delayed<Copy>
 	                               >
 	{
+		VUH_TRACE_SCOPE("copy_async", "transfer");
 		auto& array = dst_begin.array();
 		if(array.isHostVisible()){ // normal copy, the function blocks till the copying is complete
 			array.fromHost(src_begin, src_end, dst_begin.offset());
@@ -235,6 +587,7 @@ namespace vuh {
 	           , vuh::ArrayIter<arr::DeviceArray<T, Alloc>> dst_begin
 	           ) -> vuh::Delayed<Copy>
 	{
+		VUH_TRACE_SCOPE("copy_async", "transfer");
 		auto& array = dst_begin.array();
 		if(array.isHostVisible()){ // normal copy, the function blocks till the copying is complete
 			array.fromHost(fun, dst_begin.offset(), size);
@@ -260,6 +613,7 @@ namespace vuh {
 	                                   , vuh::Delayed<Copy>
 	                                   >
 	{
+		VUH_TRACE_SCOPE("copy_async", "transfer");
 		auto& array = src_begin.array();
 		if(!array.isHostVisible()){ // device array is not host-visible
 			auto stage = detail::CopyStageToHost<T, DstIter>(array.device(), src_end - src_begin, dst_begin);
@@ -271,4 +625,121 @@ namespace vuh {
 			                    , Copy::wrap(detail::StdCopy<SrcIter, DstIter>(src_begin, src_end, dst_begin))};
 		}
 	}
+
+	/// Async copy data from host memory (row-major, tightly packed) to the image.
+	/// Blocks for the duration of initial copy from host memory to host-visible staging buffer.
+	/// Only the transfer between staging buffer and the image is actually async.
+	/// @throws vuh::BufferRangeExceeded if the range size differs from the image size
+	template<class SrcIter1, class SrcIter2, class T, class Alloc>
+	auto copy_async(SrcIter1 src_begin, SrcIter2 src_end
+	                , arr::Image2D<T, Alloc>& dst
+	                )-> std::enable_if_t<traits::are_comparable_host_iterators<SrcIter1, SrcIter2>::value
+	                                    , vuh::Delayed<Copy>
+	                                    >
+	{
+		VUH_TRACE_SCOPE("copy_async", "transfer");
+		dst.checkHostSize(size_t(std::distance(src_begin, src_end)));
+		auto stage = detail::CopyStageFromHost<T, detail::CopyImage>(dst.device(), src_begin, src_end);
+		auto cpy = stage.copy_async(stage.array, dst, dst.extent());
+		return Delayed<Copy>{std::move(cpy), Copy::wrap(std::move(stage))};
+	}
+
+	/// Async copy the image content to host memory (row-major, tightly packed).
+	/// Initiates async copy from the image to the staging buffer and immidiately returns.
+	/// The copy between staging buffer and host is only triggered at the synchronization point.
+	template<class T, class Alloc, class DstIter>
+	auto copy_async(const arr::Image2D<T, Alloc>& src, DstIter dst_begin
+	                )-> std::enable_if_t<traits::is_host_iterator<DstIter>::value
+	                                    , vuh::Delayed<Copy>
+	                                    >
+	{
+		VUH_TRACE_SCOPE("copy_async", "transfer");
+		auto stage = detail::CopyStageToHost<T, DstIter, detail::CopyImage>(src.device(), src.size()
+		                                                                      , dst_begin);
+		auto cpy = stage.copy_async(src, src.extent(), stage.array);
+		return Delayed<Copy>{std::move(cpy), Copy::wrap(std::move(stage))};
+	}
+
+	/// Async fill of the array range with the value on the device side.
+	/// No data is transferred from host. Value should be 1, 2 or 4 bytes wide.
+	/// @throws vuh::BufferOffsetMisaligned if range offset or size (bytes) is not a multiple of 4
+	template<class Array>
+	auto fill_async(ArrayIter<Array> begin, ArrayIter<Array> end
+	                , const typename ArrayIter<Array>::value_type& value
+	                )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("fill_async", "transfer");
+		using T = typename ArrayIter<Array>::value_type;
+		auto& array = begin.array();
+		if(begin == end){
+			return Delayed<Copy>{array.device(), Copy::wrap(detail::Noop{})};
+		}
+		auto fill = detail::FillDevice(array.device());
+		auto cpy = fill.fill_async(array, begin.offset()*sizeof(T), (end - begin)*sizeof(T)
+		                           , detail::fill_pattern(value));
+		return Delayed<Copy>{std::move(cpy), Copy::wrap(std::move(fill))};
+	}
+
+	/// Async fill of the array view with the value on the device side.
+	template<class Array>
+	auto fill_async(ArrayView<Array> view, const typename Array::value_type& value
+	                )-> vuh::Delayed<Copy>
+	{
+		auto& array = view.array();
+		return fill_async(ArrayIter<Array>(array, view.offset())
+		                  , ArrayIter<Array>(array, view.offset() + view.size()), value);
+	}
+
+	/// Async zero-fill of the array range on the device side. Works for any value type.
+	/// @throws vuh::BufferOffsetMisaligned if range offset or size (bytes) is not a multiple of 4
+	template<class Array>
+	auto zero_async(ArrayIter<Array> begin, ArrayIter<Array> end)-> vuh::Delayed<Copy> {
+		VUH_TRACE_SCOPE("zero_async", "transfer");
+		using T = typename ArrayIter<Array>::value_type;
+		auto& array = begin.array();
+		if(begin == end){
+			return Delayed<Copy>{array.device(), Copy::wrap(detail::Noop{})};
+		}
+		auto fill = detail::FillDevice(array.device());
+		auto cpy = fill.fill_async(array, begin.offset()*sizeof(T), (end - begin)*sizeof(T), 0u);
+		return Delayed<Copy>{std::move(cpy), Copy::wrap(std::move(fill))};
+	}
+
+	/// Async zero-fill of the array view on the device side.
+	template<class Array>
+	auto zero_async(ArrayView<Array> view)-> vuh::Delayed<Copy> {
+		auto& array = view.array();
+		return zero_async(ArrayIter<Array>(array, view.offset())
+		                  , ArrayIter<Array>(array, view.offset() + view.size()));
+	}
+
+	/// Async update of the array range with the small amount of host data.
+	/// Data is embedded to the command buffer at the call, so the source may be released
+	/// immediately and no staging buffer is involved. Intended for parameter blocks, small
+	/// lookup tables and the like: large updates are better done with copy_async().
+	/// @throws vuh::BufferOffsetMisaligned if destination offset or data size (bytes) is not a multiple of 4
+	template<class Array>
+	auto update_async(const typename ArrayIter<Array>::value_type* src_begin
+	                  , const typename ArrayIter<Array>::value_type* src_end
+	                  , ArrayIter<Array> dst_begin
+	                  )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("update_async", "transfer");
+		using T = typename ArrayIter<Array>::value_type;
+		static_assert(std::is_trivially_copyable<T>::value, "array value type should be trivially copyable");
+		auto& array = dst_begin.array();
+		if(src_begin == src_end){
+			return Delayed<Copy>{array.device(), Copy::wrap(detail::Noop{})};
+		}
+		auto fill = detail::FillDevice(array.device());
+		auto cpy = fill.update_async(src_begin, size_t(src_end - src_begin)*sizeof(T)
+		                             , array, dst_begin.offset()*sizeof(T));
+		return Delayed<Copy>{std::move(cpy), Copy::wrap(std::move(fill))};
+	}
+
+	/// Async update of the array view with view.size() elements of host data.
+	template<class Array>
+	auto update_async(ArrayView<Array> dst, const typename Array::value_type* src)-> vuh::Delayed<Copy> {
+		return update_async(src, src + dst.size(), ArrayIter<Array>(dst.array(), dst.offset()));
+	}
 } // namespace vuh
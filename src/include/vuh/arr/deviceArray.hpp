@@ -6,11 +6,13 @@
 #include "allocDevice.hpp"
 #include "basicArray.hpp"
 #include "hostArray.hpp"
+#include "hostCopy.hpp"
 
 #include <vuh/traits.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 
 namespace vuh {
 namespace arr {
@@ -37,8 +39,10 @@ public:
 
    using Base::size_bytes;
 
+	/// @return number of elements
+	auto size() const-> size_t {return _size;}
 private:
-	uint32_t  _size; ///< number of elements
+	size_t _size; ///< number of elements
 }; // class DeviceOnlyArray
 
 /// Array with host data exchange interface suitable for memory allocated in device-local space.
@@ -53,6 +57,8 @@ class DeviceArray: public BasicArray{
 	using Base = BasicArray;
 public:
 	using value_type = T;
+	/// Upper bound on the staging buffer size used by the host transfers.
+	static constexpr size_t max_stage_bytes = size_t(64) << 20;
     DeviceArray() {}
 	/// Create an instance of DeviceArray with given number of elements. Memory is uninitialized.
 	DeviceArray( vuh::Device& device   ///< device to create array on
@@ -96,24 +102,15 @@ public:
 	           , vk::BufferUsageFlags flags_buffer={})	  ///< additional (to defined by allocator) buffer usage flags
 	   : DeviceArray(device, n_elements, flags_memory, flags_buffer)
 	{
-		using std::begin;
-		auto stage_buffer = HostArray<T, AllocDevice<properties::HostCoherent>>(Base::_dev, n_elements);
-		auto stage_it = begin(stage_buffer);
-		for(size_t i = 0; i < n_elements; ++i, ++stage_it){
-			*stage_it = fun(i);
-		}
-		copyBuf(Base::_dev, stage_buffer, *this, size_bytes());
+		stagedWrite(n_elements, 0, [&](T* dst, size_t first, size_t m){
+			for(size_t i = 0; i < m; ++i){
+				dst[i] = fun(first + i);
+			}
+		});
 	}
 
-    /// Destroy array, and release all associated resources.
-    ~DeviceArray() noexcept {
-       if(ptr) {
-          Base::unmapMemory();
-       }
-    }
-
     /// Move constructor.
-    DeviceArray(DeviceArray&& o): Base(std::move(o)), ptr(o.ptr), _size(o._size) {o.ptr = nullptr;}
+    DeviceArray(DeviceArray&& o): Base(std::move(o)), _size(o._size) {}
      /// Move operator.
     auto operator=(DeviceArray&& o)-> DeviceArray& {
          this->swap(o);
@@ -123,7 +120,6 @@ public:
      auto swap(DeviceArray& o) noexcept-> void {
          using std::swap;
          swap(static_cast<Base&>(*this), static_cast<Base&>(o));
-       swap(ptr, o.ptr);
        swap(_size, o._size);
      }
 
@@ -132,27 +128,33 @@ public:
 	template<class It1, class It2>
 	auto fromHost(It1 begin, It2 end)-> void {
 		if(Base::isHostVisible()){
-			std::copy(begin, end, host_data());
-            Base::flush_mapped_writes();
+			const auto n = size_t(std::distance(begin, end));
+			host_copy_n(begin, n, host_data());
+            Base::flush_mapped_writes(0, n*sizeof(T));
             unmap_host_data();
 		} else { // memory is not host visible, use staging buffer
-			auto stage_buf = HostArray<T, AllocDevice<properties::HostCoherent>>(Base::_dev, begin, end);
-			copyBuf(Base::_dev, stage_buf, *this, size_bytes());
+			stagedFromHost(begin, size_t(std::distance(begin, end)), 0);
 		}
 	}
     /// Copy data from host range to array memory.
     template<class It1, class It2, typename F>
     auto fromHost(It1 begin, It2 end, F&& fun)-> void {
         if(Base::isHostVisible()){
-            std::transform(begin, end, host_data(), fun);
-            Base::flush_mapped_writes();
+            const auto n = size_t(std::distance(begin, end));
+            host_transform_n(begin, n, host_data(), fun);
+            Base::flush_mapped_writes(0, n*sizeof(T));
             unmap_host_data();
         } else { // memory is not host visible, use staging buffer
-            auto stage_buf = HostArray<T, AllocDevice<properties::HostCoherent>>(Base::_dev, begin, end, fun);
-            copyBuf(Base::_dev, stage_buf, *this, size_bytes());
+            stagedWrite(size_t(std::distance(begin, end)), 0, [&](T* dst, size_t, size_t m){
+                host_transform_n(begin, m, dst, fun);
+                std::advance(begin, std::ptrdiff_t(m));
+            });
         }
     }
     /// Call fun to fill data to array memory.
+    /// fun gets the pointer to size_ elements (up to the end of array when 0) starting at offset.
+    /// The range is passed in one piece, so unlike the other host transfers this one is not split
+    /// in chunks of max_stage_bytes: the staging buffer spans the whole range.
     template<typename F>
     auto fromHost(F&& fun, size_t offset = 0, size_t size_ = 0)-> void {
         if (offset >= size())
@@ -160,15 +162,12 @@ public:
 
         if(Base::isHostVisible()){
             fun(host_data() + offset);
-            Base::flush_mapped_writes();
+            Base::flush_mapped_writes(offset*sizeof(T), size_ ? size_*sizeof(T) : VK_WHOLE_SIZE);
             unmap_host_data();
         } else { // memory is not host visible, use staging buffer
-            auto stage_buf = HostArray<T, AllocDevice<properties::HostCoherent>>(Base::_dev, size_ ? size_ : size(), fun);
-            auto offset_bytes = offset*sizeof(T);
-            auto size = size_bytes() - offset_bytes;
-            if (size_ != 0)
-                size = std::min(size_*sizeof(T), stage_buf.size_bytes());
-            copyBuf(Base::_dev, stage_buf, *this, size, 0u, offset_bytes);
+            const auto n = size_ ? std::min(size_, size() - offset) : size() - offset;
+            auto stage_buf = HostArray<T, AllocDevice<properties::HostCoherent>>(Base::_dev, n, fun);
+            copyBuf(Base::_dev, stage_buf, *this, n*sizeof(T), 0u, offset*sizeof(T));
         }
     }
    
@@ -179,15 +178,11 @@ public:
             return;
 
 		if(Base::isHostVisible()){
-			std::copy(begin, end, host_data() + offset);
-            Base::flush_mapped_writes();
+			auto last = std::copy(begin, end, host_data() + offset);
+            Base::flush_mapped_writes(offset*sizeof(T), size_t(last - host_data() - offset)*sizeof(T));
             unmap_host_data();
 		} else { // memory is not host visible, use staging buffer
-			auto stage_buf = HostArray<T, AllocDevice<properties::HostCoherent>>(Base::_dev, begin, end);
-            auto offset_bytes = offset*sizeof(T);
-            auto size = size_bytes() - offset_bytes;
-            size = std::min(size, stage_buf.size_bytes());
-			copyBuf(Base::_dev, stage_buf, *this, size, 0u, offset_bytes);
+			stagedFromHost(begin, std::min(size_t(std::distance(begin, end)), size() - offset), offset);
 		}
 	}
 
@@ -199,14 +194,11 @@ public:
    auto toHost(It copy_to) const-> void {
       if(Base::isHostVisible()){
           auto copy_from = host_data();
-          Base::invalidate_mapped_cache();
+          Base::invalidate_mapped_cache(0, size_bytes());
          std::copy_n(copy_from, size(), copy_to);
          unmap_host_data();
       } else {
-         using std::begin; using std::end;
-         auto stage_buf = HostArray<T, AllocDevice<properties::HostCached>>(Base::_dev, size());
-         copyBuf(Base::_dev, *this, stage_buf, size_bytes());
-         std::copy(begin(stage_buf), end(stage_buf), copy_to);
+         stagedToHost(0, size(), copy_to);
       }
    }
    
@@ -226,17 +218,19 @@ public:
 	{
 		if(Base::isHostVisible()){
 			auto copy_from = host_data();
-            Base::invalidate_mapped_cache();
+            Base::invalidate_mapped_cache(0, size*sizeof(T));
 			std::transform(copy_from, copy_from + size, copy_to, std::forward<F>(fun));
             unmap_host_data();
 		} else {
-			using std::begin; using std::end;
-			auto stage_buf = HostArray<T, AllocDevice<properties::HostCached>>(Base::_dev, size);
-			copyBuf(Base::_dev, *this, stage_buf, size_bytes());
-			std::transform(begin(stage_buf), end(stage_buf), copy_to, std::forward<F>(fun));
+			stagedRead(0, size, [&](const T* src, size_t m){
+				copy_to = std::transform(src, src + m, copy_to, fun);
+			});
 		}
 	}
    /// Call back fun on data of array.
+   /// fun gets the pointer to the elements from offset to the end of array.
+   /// The range is passed in one piece, so unlike the other host transfers this one is not split
+   /// in chunks of max_stage_bytes: the staging buffer spans the whole range.
    template<class F, typename=typename std::enable_if_t<std::is_invocable_v<F, float*>> >
    auto toHost( F&& fun     ///< transform function
 	           , size_t offset = 0) const-> void
@@ -246,14 +240,15 @@ public:
 
 		if(Base::isHostVisible()){
 			auto copy_from = host_data();
-            Base::invalidate_mapped_cache();
+            Base::invalidate_mapped_cache(offset*sizeof(T));
             fun(copy_from + offset);
             unmap_host_data();
 		} else {
-			using std::begin; using std::end;
-			auto stage_buf = HostArray<T, AllocDevice<properties::HostCached>>(Base::_dev, size());
-			copyBuf(Base::_dev, *this, stage_buf, size_bytes());
-            fun(begin(stage_buf) + offset);
+			const auto n = size() - offset;
+			auto stage_buf = HostArray<T, AllocDevice<properties::HostCached>>(Base::_dev, n);
+			copyBuf(Base::_dev, *this, stage_buf, n*sizeof(T), offset*sizeof(T), 0u);
+			stage_buf.invalidate_mapped_cache(0, n*sizeof(T));
+            fun(stage_buf.begin());
 		}
 	}
 
@@ -262,15 +257,11 @@ public:
 	auto rangeToHost(size_t offset_begin, size_t offset_end, DstIter dst_begin) const-> void {
 		if(Base::isHostVisible()){
 			auto copy_from = host_data();
-            Base::invalidate_mapped_cache();
+            Base::invalidate_mapped_cache(offset_begin*sizeof(T), (offset_end - offset_begin)*sizeof(T));
 			std::copy(copy_from + offset_begin, copy_from + offset_end, dst_begin);
             unmap_host_data();
 		} else {
-			using std::begin; using std::end;
-			auto stage_buf = HostArray<T, AllocDevice<properties::HostCached>>(Base::_dev
-			                                                          , offset_end - offset_begin);
-			copyBuf(Base::_dev, *this, stage_buf, size_bytes(), offset_begin, 0u);
-			std::copy(begin(stage_buf), end(stage_buf), dst_begin);
+			stagedToHost(offset_begin, offset_end, dst_begin);
 		}
 	}
 	
@@ -295,34 +286,73 @@ public:
 	auto device_end()-> ArrayIter<DeviceArray> {return ArrayIter<DeviceArray>(*this, _size);}
 	auto device_end() const-> ArrayIter<DeviceArray> {return ArrayIter<DeviceArray>(*this, _size);}
 private: // helpers
+	/// Write n elements to the array starting at offset via the staging buffer.
+	/// fill(dst, first, m) should write to dst the m elements of the transfer starting from first.
+	/// Large transfers are split into chunks of at most max_stage_bytes so that the staging
+	/// buffer size stays bounded for arrays of any size.
+	template<class Fill>
+	auto stagedWrite(size_t n, size_t offset, Fill&& fill)-> void {
+		const auto chunk = std::min(n, std::max(max_stage_bytes/sizeof(T), size_t(1)));
+		if(chunk == 0){
+			return;
+		}
+		auto stage_buf = HostArray<T, AllocDevice<properties::HostCoherent>>(Base::_dev, chunk);
+		for(size_t done = 0; done < n; done += chunk){
+			const auto m = std::min(chunk, n - done);
+			fill(stage_buf.begin(), done, m);
+			stage_buf.flush_mapped_writes(0, m*sizeof(T));
+			copyBuf(Base::_dev, stage_buf, *this, m*sizeof(T), 0u, (offset + done)*sizeof(T));
+		}
+	}
+
+	/// Read the range of elements via the staging buffer, in chunks of at most max_stage_bytes.
+	/// read(src, m) gets the next m elements of the range.
+	template<class Read>
+	auto stagedRead(size_t offset_begin, size_t offset_end, Read&& read) const-> void {
+		const auto n = offset_end - offset_begin;
+		const auto chunk = std::min(n, std::max(max_stage_bytes/sizeof(T), size_t(1)));
+		if(chunk == 0){
+			return;
+		}
+		auto stage_buf = HostArray<T, AllocDevice<properties::HostCached>>(Base::_dev, chunk);
+		for(size_t done = 0; done < n; done += chunk){
+			const auto m = std::min(chunk, n - done);
+			copyBuf(Base::_dev, *this, stage_buf, m*sizeof(T), (offset_begin + done)*sizeof(T), 0u);
+			stage_buf.invalidate_mapped_cache(0, m*sizeof(T));
+			read(static_cast<const T*>(stage_buf.begin()), m);
+		}
+	}
+
+	/// Copy n elements from the host range to the array starting at offset via the staging buffer.
+	template<class It>
+	auto stagedFromHost(It begin, size_t n, size_t offset)-> void {
+		stagedWrite(n, offset, [&](T* dst, size_t, size_t m){
+			host_copy_n(begin, m, dst);
+			std::advance(begin, std::ptrdiff_t(m));
+		});
+	}
+
+	/// Copy the range of elements to the host via the staging buffer.
+	template<class DstIter>
+	auto stagedToHost(size_t offset_begin, size_t offset_end, DstIter dst_begin) const-> void {
+		stagedRead(offset_begin, offset_end, [&](const T* src, size_t m){
+			dst_begin = std::copy(src, src + m, dst_begin);
+		});
+	}
+
 	auto host_data()-> T* {
 		assert(Base::isHostVisible());
-        if (!ptr) {
-            ptr = Base::template mapMemory<T>();
-            Base::invalidate_mapped_cache();
-        }
-        return ptr;
+        return Base::template mapMemory<T>();
 	}
 
 	auto host_data() const-> const T* {
 		assert(Base::isHostVisible());
-        if (!ptr) {
-            ptr = Base::template mapMemory<T>();
-            Base::invalidate_mapped_cache();
-        }
-        return ptr;
+        return Base::template mapMemory<T>();
 	}
 
-    void unmap_host_data() const
-    {
-        if (Base::require_unmap_flush) {
-            Base::unmapMemory();
-            ptr = nullptr;
-        }
-    }
+    void unmap_host_data() const { Base::unmap_transient(); }
 private: // data
 	size_t _size; ///< number of elements. Actual allocated memory may be a bit bigger than necessary.
-    mutable T* ptr = nullptr;
 }; // class DeviceArray
 
 /// doc me
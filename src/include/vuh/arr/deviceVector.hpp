@@ -0,0 +1,157 @@
+#pragma once
+
+#include "arrayUtils.h"
+#include "deviceArray.hpp"
+
+#include <vuh/device.h>
+
+#include <vulkan/vulkan.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace vuh {
+namespace arr {
+
+/// Resizable array in device memory.
+/// Elements live in a DeviceArray of some capacity, which is replaced by a bigger one
+/// (at least twice the old capacity) when the capacity is exceeded.
+/// Old content is then copied over on the device side, so appending is amortized O(1)
+/// in the number of appended elements.
+/// As with std::vector, growth invalidates the underlying buffer, so the vector should be
+/// (re)bound to a Program after the operations that may reallocate.
+/// Vector binds to kernels as a storage buffer covering its current size, it should not be
+/// bound when empty.
+template<class T, class Alloc>
+class DeviceVector {
+public:
+	using value_type = T;
+	using array_type = DeviceArray<T, Alloc>;
+	static constexpr auto descriptor_class = vk::DescriptorType::eStorageBuffer;
+
+	/// Create vector of given size. Content is uninitialized.
+	explicit DeviceVector(vuh::Device& device  ///< device to create vector on
+	                      , size_t n_elements=0 ///< number of elements
+	                      , vk::MemoryPropertyFlags flags_memory={} ///< additional (to defined by allocator) memory usage flags
+	                      , vk::BufferUsageFlags flags_buffer={}    ///< additional (to defined by allocator) buffer usage flags
+	                      )
+	   : _dev(&device), _flags_memory(flags_memory)
+	   , _flags_buffer(flags_buffer | vk::BufferUsageFlagBits::eTransferSrc
+	                                | vk::BufferUsageFlagBits::eTransferDst)
+	{
+		resize(n_elements);
+	}
+
+	/// Create vector and initialize it with the content of the host range.
+	template<class It1, class It2>
+	DeviceVector(vuh::Device& device ///< device to create vector on
+	             , It1 begin         ///< beginning of initialization range
+	             , It2 end           ///< end of initialization range
+	             , vk::MemoryPropertyFlags flags_memory={} ///< additional (to defined by allocator) memory usage flags
+	             , vk::BufferUsageFlags flags_buffer={}    ///< additional (to defined by allocator) buffer usage flags
+	             )
+	   : DeviceVector(device, 0, flags_memory, flags_buffer)
+	{
+		push_back_range(begin, end);
+	}
+
+	/// Make sure the capacity is at least n_elements. Never shrinks.
+	auto reserve(size_t n_elements)-> void {
+		if(n_elements <= capacity()){
+			return;
+		}
+		auto array = std::make_unique<array_type>(*_dev, n_elements, _flags_memory, _flags_buffer);
+		if(_size > 0){
+			copyBuf(*_dev, *_array, *array, _size*sizeof(T));
+		}
+		_array = std::move(array);
+	}
+
+	/// Change the number of elements. Elements past the old size are uninitialized.
+	/// Capacity grows geometrically.
+	auto resize(size_t n_elements)-> void {
+		grow(n_elements);
+		_size = n_elements;
+	}
+
+	/// Append the content of the host range (forward iterators) to the end of the vector.
+	template<class It1, class It2>
+	auto push_back_range(It1 begin, It2 end)-> void {
+		const auto n = size_t(std::distance(begin, end));
+		if(n == 0){
+			return;
+		}
+		grow(_size + n);
+		_array->fromHost(begin, end, _size);
+		_size += n;
+	}
+
+	/// Remove all elements. Capacity is not changed.
+	auto clear()-> void { _size = 0; }
+
+	/// Release the unused capacity.
+	auto shrink_to_fit()-> void {
+		if(_size == capacity()){
+			return;
+		}
+		if(_size == 0){
+			_array.reset();
+			return;
+		}
+		auto array = std::make_unique<array_type>(*_dev, _size, _flags_memory, _flags_buffer);
+		copyBuf(*_dev, *_array, *array, _size*sizeof(T));
+		_array = std::move(array);
+	}
+
+	/// Copy vector content to the host location indicated by iterator.
+	template<class It>
+	auto toHost(It copy_to) const-> void {
+		if(_size > 0){
+			_array->rangeToHost(0, _size, copy_to);
+		}
+	}
+
+	/// @return host container with a copy of vector data.
+	template<class C=std::vector<T>>
+	auto toHost() const-> C {
+		auto r = C(_size);
+		using std::begin;
+		toHost(begin(r));
+		return r;
+	}
+
+	/// @return number of elements
+	auto size() const-> size_t { return _size; }
+	/// @return number of elements the vector can hold without reallocation
+	auto capacity() const-> size_t { return _array ? _array->size() : 0u; }
+	/// @return true if the vector is empty
+	auto empty() const-> bool { return _size == 0; }
+	/// @return size of the vector data in bytes
+	auto size_bytes() const-> size_t { return _size*sizeof(T); }
+	/// @return offset of the vector data in the underlying buffer, always 0
+	auto offset_bytes() const-> size_t { return 0; }
+	/// @return underlying buffer. Invalidated by reallocation.
+	auto buffer()-> vk::Buffer { assert(_array); return _array->buffer(); }
+	/// @return underlying array holding capacity() elements. Invalidated by reallocation.
+	auto array()-> array_type& { assert(_array); return *_array; }
+	/// @return reference to device on which the vector is allocated
+	auto device() const-> vuh::Device& { return *_dev; }
+private: // helpers
+	/// Make sure capacity is at least n_elements, growing geometrically.
+	auto grow(size_t n_elements)-> void {
+		if(n_elements > capacity()){
+			reserve(std::max(n_elements, 2*capacity()));
+		}
+	}
+private: // data
+	std::unique_ptr<array_type> _array;    ///< storage, null while capacity is 0
+	size_t _size = 0;                      ///< number of elements
+	vuh::Device* _dev;                     ///< device the vector is allocated on
+	vk::MemoryPropertyFlags _flags_memory; ///< additional memory flags used for allocations
+	vk::BufferUsageFlags _flags_buffer;    ///< buffer usage flags used for allocations
+}; // class DeviceVector
+} // namespace arr
+} // namespace vuh
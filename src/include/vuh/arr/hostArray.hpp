@@ -2,6 +2,7 @@
 
 #include "basicArray.hpp"
 #include "arrayIter.hpp"
+#include "hostCopy.hpp"
 
 #include <algorithm>
 
@@ -13,17 +14,19 @@ namespace arr {
 /// Such allocator is expected to allocate memory in host-visible GPU memory, mappable
 /// for host access.
 /// Provides Forward iterator + random-access interface.
-/// Memory remains mapped during the whole lifetime of an object of this type.
+/// Memory is mapped at construction and by default (MapPolicy::Persistent) remains mapped
+/// during the whole lifetime of an object of this type.
 ///
 /// !!!!!
 /// Flush/invalidate is a user responsibility!!!
+/// Use flush_mapped_writes()/invalidate_mapped_cache() with the touched byte range.
 /// !!!!!
 template<class T, class Alloc>
 class HostArray: public BasicArray {
 	using Base = BasicArray;
 public:
 	using value_type = T;
-    HostArray() : _data(nullptr) {}
+    HostArray() : _size(0) {}
 	/// Construct object of the class on given device.
 	/// Memory is not initialized with any data.
 	HostArray(vuh::Device& device  ///< device to create array on
@@ -32,9 +35,10 @@ public:
 	          , vk::BufferUsageFlags flags_buffer={}    ///< additional (to defined by allocator) buffer usage flags
 	          )
 	   : BasicArray(device, n_elements*sizeof(T), flags_memory, flags_buffer, (Alloc *)nullptr)
-       , _data(Base::template mapMemory<T>())
 	   , _size(n_elements)
-	{}
+	{
+		Base::set_map_policy(MapPolicy::Persistent);
+	}
 
 	/// Construct array on given device and initialize with a provided value.
 	HostArray( vuh::Device& device ///< device to create array on
@@ -46,7 +50,7 @@ public:
 	   : HostArray(device, n_elements, flags_memory, flags_buffer)
 	{
 		std::fill_n(begin(), n_elements, value);
-        Base::flush_mapped_writes();
+        Base::flush_mapped_writes(0, size_bytes());
         unmap_host_data();
 	}
 
@@ -60,8 +64,8 @@ public:
 	         )
 	   : HostArray(device, std::distance(begin, end), flags_memory, flags_buffer)
 	{
-		std::copy(begin, end, this->begin());
-        Base::flush_mapped_writes();
+		host_copy_n(begin, size(), this->begin());
+        Base::flush_mapped_writes(0, size_bytes());
         unmap_host_data();
 	}
     /// Construct array on given device and call fun to fill it
@@ -75,7 +79,7 @@ public:
 	   : HostArray(device, size, flags_memory, flags_buffer)
 	{
 		fun(this->begin());
-        Base::flush_mapped_writes();
+        Base::flush_mapped_writes(0, size_bytes());
         unmap_host_data();
 	}
     /// Construct array on given device and initialize it from range of values
@@ -89,31 +93,23 @@ public:
              )
        : HostArray(device, std::distance(begin, end), flags_memory, flags_buffer)
     {
-        std::transform(begin, end, this->begin(), fun);
-        Base::flush_mapped_writes();
+        host_transform_n(begin, size(), this->begin(), fun);
+        Base::flush_mapped_writes(0, size_bytes());
         unmap_host_data();
     }
 
    /// Move constructor.
-   HostArray(HostArray&& o): Base(std::move(o)), _data(o._data), _size(o._size) {o._data = nullptr;}
+   HostArray(HostArray&& o): Base(std::move(o)), _size(o._size) {}
 	/// Move operator.
    auto operator=(HostArray&& o)-> HostArray& {
 		this->swap(o);
 		return *this;
    }
-   
-   /// Destroy array, and release all associated resources.
-   ~HostArray() noexcept {
-      if(_data) {
-         Base::unmapMemory();
-      }
-   }
 
 	/// doc me
 	auto swap(HostArray& o) noexcept-> void {
 		using std::swap;
 		swap(static_cast<Base&>(*this), static_cast<Base&>(o));
-      swap(_data, o._data);
       swap(_size, o._size);
 	}
 
@@ -157,7 +153,7 @@ public:
            return;
 
        fun(host_data() + offset);
-       Base::flush_mapped_writes();
+       Base::flush_mapped_writes(offset*sizeof(T), size_ ? size_*sizeof(T) : VK_WHOLE_SIZE);
        unmap_host_data();
    }
 
@@ -169,40 +165,26 @@ public:
            return;
 
        auto copy_from = host_data();
-       Base::invalidate_mapped_cache();
+       Base::invalidate_mapped_cache(offset*sizeof(T));
        fun(copy_from + offset);
        unmap_host_data();
 	}
 
-   void unmap_host_data() const
-   {
-       if (Base::require_unmap_flush) {
-           Base::unmapMemory();
-           _data = nullptr;
-       }
-   }
+   /// Unmap memory after the host transfer if the map policy is Transient.
+   void unmap_host_data() const { Base::unmap_transient(); }
 
 private:
    auto host_data()-> T* {
        assert(Base::isHostVisible());
-       if (!_data) {
-           _data = Base::template mapMemory<T>();
-           Base::invalidate_mapped_cache();
-       }
-       return _data;
+       return Base::template mapMemory<T>();
    }
 
    auto host_data() const-> const T* {
        assert(Base::isHostVisible());
-       if (!_data) {
-           _data = Base::template mapMemory<T>();
-           Base::invalidate_mapped_cache();
-       }
-       return _data;
+       return Base::template mapMemory<T>();
    }
 
 private: // data
-   mutable T* _data;       ///< host accessible pointer to the beginning of corresponding memory chunk.
    size_t _size;  ///< Number of elements. Actual allocated memory may be a bit bigger then necessary.
 }; // class HostArray
 } // namespace arr
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace vuh {
+	auto setHostCopyThreads(uint32_t n_threads)-> void;
+	auto hostCopyThreads() noexcept-> uint32_t;
+
+namespace arr {
+	/// Minimal amount of data (bytes) per thread worth splitting the host copy for.
+	constexpr auto host_copy_min_chunk_bytes = size_t(1) << 20;
+
+	auto parallel_for(size_t n_items, size_t granule, size_t min_items
+	                  , const std::function<void(size_t, size_t)>& fun)-> void;
+	auto stream_copy(void* dst, const void* src, size_t size_bytes) noexcept-> void;
+	auto host_copy(void* dst, const void* src, size_t size_bytes)-> void;
+
+	namespace detail {
+		/// @return number of elements of size elem_size making a whole number of cache lines.
+		constexpr auto cache_line_granule(size_t elem_size)-> size_t {
+			constexpr auto line = size_t(64);
+			return line/std::gcd(elem_size, line);
+		}
+
+		template<class It>
+		constexpr auto is_random_access = std::is_base_of<std::random_access_iterator_tag
+		                                     , typename std::iterator_traits<It>::iterator_category>::value;
+
+		/// True for iterators known to point to contiguous memory: pointers and std::vector iterators
+		/// (other than those of std::vector<bool>).
+		template<class It, class V=std::remove_cv_t<typename std::iterator_traits<It>::value_type>>
+		constexpr auto is_contiguous = std::is_pointer<It>::value
+		                               || (!std::is_same<V, bool>::value
+		                                   && (std::is_same<It, typename std::vector<V>::iterator>::value
+		                                       || std::is_same<It, typename std::vector<V>::const_iterator>::value));
+	} // namespace detail
+
+	/// Copy n elements from the host range to the host (possibly mapped write-combined) memory.
+	/// Contiguous ranges of trivially copyable types go through host_copy(), other
+	/// random access ranges are copied in parallel chunks, the rest is copied serially.
+	/// Parallelism is controlled by vuh::setHostCopyThreads().
+	template<class It, class T>
+	auto host_copy_n(It begin, size_t n, T* dst)-> T* {
+		using Src = typename std::iterator_traits<It>::value_type;
+		if constexpr(detail::is_contiguous<It> && std::is_same<std::decay_t<Src>, T>::value
+		             && std::is_trivially_copyable<T>::value)
+		{
+			if(n > 0){ // begin may not be dereferenced for the empty range
+				host_copy(dst, std::addressof(*begin), n*sizeof(T));
+			}
+		} else if constexpr(detail::is_random_access<It>){
+			parallel_for(n, detail::cache_line_granule(sizeof(T))
+			             , std::max(host_copy_min_chunk_bytes/sizeof(T), size_t(1))
+			             , [&](size_t first, size_t last){
+				std::copy(begin + first, begin + last, dst + first);
+			});
+		} else {
+			std::copy_n(begin, n, dst);
+		}
+		return dst + n;
+	}
+
+	/// Transform n elements from the host range to the host (possibly mapped) memory.
+	/// Random access ranges are processed in parallel cache-line aligned chunks, so fun should be
+	/// safe to call concurrently.
+	template<class It, class T, class F>
+	auto host_transform_n(It begin, size_t n, T* dst, F&& fun)-> T* {
+		if constexpr(detail::is_random_access<It>){
+			parallel_for(n, detail::cache_line_granule(sizeof(T))
+			             , std::max(host_copy_min_chunk_bytes/sizeof(T), size_t(1))
+			             , [&](size_t first, size_t last){
+				std::transform(begin + first, begin + last, dst + first, fun);
+			});
+		} else {
+			std::transform(begin, std::next(begin, std::ptrdiff_t(n)), dst, fun);
+		}
+		return dst + n;
+	}
+} // namespace arr
+} // namespace vuh
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "allocDevice.hpp"
+#include "arrayProperties.h"
+#include "arrayUtils.h"
+#include "hostArray.hpp"
+
+#include <vuh/device.h>
+#include <vuh/error.h>
+#include <vuh/traits.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace vuh {
+namespace arr {
+
+/// Maps image element type to the vulkan format.
+/// Specializations are provided for the types matching the most common storage image formats
+/// (r32f, r32i, r32ui, rgba8, rgba32f). Specialize for other types as needed.
+template<class T> struct ImageFormat;
+
+template<> struct ImageFormat<float>{
+	static constexpr auto value = vk::Format::eR32Sfloat;
+};
+template<> struct ImageFormat<int32_t>{
+	static constexpr auto value = vk::Format::eR32Sint;
+};
+template<> struct ImageFormat<uint32_t>{
+	static constexpr auto value = vk::Format::eR32Uint;
+};
+template<> struct ImageFormat<std::array<uint8_t, 4>>{
+	static constexpr auto value = vk::Format::eR8G8B8A8Unorm;
+};
+template<> struct ImageFormat<std::array<float, 4>>{
+	static constexpr auto value = vk::Format::eR32G32B32A32Sfloat;
+};
+
+/// Two-dimensional image with the host data exchange interface.
+/// Binds to kernels as a storage image (image2D in glsl), use vuh::sampled() to bind it
+/// as a combined image sampler (sampler2D) and get the texture-cache reads with hardware
+/// filtering and boundary handling.
+/// Image is created with optimal tiling and stays in general layout for its whole lifetime.
+/// All transfers to and from the image run on the compute queue so that the image never
+/// changes the queue family ownership.
+/// Memory allocation is managed by the allocator defined by a template parameter, only its
+/// memory properties are relevant.
+/// Data exchange with host always goes through the staging buffer, as optimal tiling
+/// layout is implementation-defined.
+template<class T, class Alloc>
+class Image2D: public vk::Image {
+public:
+	using value_type = T;
+	static constexpr auto descriptor_class = vk::DescriptorType::eStorageImage;
+
+	/// Create an image of given dimensions. Content is uninitialized.
+	Image2D(vuh::Device& device     ///< device to create image on
+	        , uint32_t width        ///< image width (number of elements in a row)
+	        , uint32_t height       ///< image height (number of rows)
+	        , vk::MemoryPropertyFlags flags_memory={} ///< additional (to defined by allocator) memory usage flags
+	        , vk::ImageUsageFlags flags_usage={}      ///< additional image usage flags
+	        )
+	   : vk::Image(device.createImage(imageInfo(width, height, flags_usage)))
+	   , _dev(&device)
+	   , _extent{width, height}
+	{
+		try{
+			auto alloc = Alloc();
+			_mem = alloc.allocMemory(device, static_cast<vk::Image&>(*this), flags_memory);
+			device.bindImageMemory(*this, _mem, 0);
+			_view = device.createImageView({{}, *this, vk::ImageViewType::e2D, format(), {}
+			                               , {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}});
+			_sampler = device.createSampler(samplerInfo(device));
+			initImageLayout(device, *this, vk::ImageLayout::eGeneral);
+		} catch(std::runtime_error&){ // release what was created if something failed
+			release();
+			throw;
+		}
+	}
+
+	/// Create an image and initialize it with content of the host range (row-major).
+	template<class It1, class It2>
+	Image2D(vuh::Device& device  ///< device to create image on
+	        , uint32_t width     ///< image width
+	        , uint32_t height    ///< image height
+	        , It1 begin          ///< beginning of initialization range
+	        , It2 end            ///< end of initialization range
+	        , vk::MemoryPropertyFlags flags_memory={} ///< additional (to defined by allocator) memory usage flags
+	        , vk::ImageUsageFlags flags_usage={}      ///< additional image usage flags
+	        )
+	   : Image2D(device, width, height, flags_memory, flags_usage)
+	{
+		fromHost(begin, end);
+	}
+
+	Image2D(const Image2D&) = delete;
+	auto operator=(const Image2D&)-> Image2D& = delete;
+
+	/// Move constructor. Passes the underlying image ownership.
+	Image2D(Image2D&& other) noexcept
+	   : vk::Image(other), _mem(other._mem), _view(other._view), _sampler(other._sampler)
+	   , _dev(other._dev), _extent(other._extent)
+	{
+		static_cast<vk::Image&>(other) = nullptr;
+		other._view = nullptr;
+		other._sampler = nullptr;
+		other._mem = nullptr;
+	}
+
+	/// Move assignment.
+	/// Resources associated with current image are released immidiately.
+	auto operator=(Image2D&& other) noexcept-> Image2D& {
+		release();
+		static_cast<vk::Image&>(*this) = static_cast<vk::Image&>(other);
+		_mem = other._mem;
+		_view = other._view;
+		_sampler = other._sampler;
+		_dev = other._dev;
+		_extent = other._extent;
+		static_cast<vk::Image&>(other) = nullptr;
+		other._view = nullptr;
+		other._sampler = nullptr;
+		other._mem = nullptr;
+		return *this;
+	}
+
+	/// Release resources associated with the image.
+	~Image2D() noexcept { release(); }
+
+	/// Copy data from the host range (row-major, tightly packed) to the image.
+	/// Sync operation, goes through the host-visible staging buffer.
+	/// @throws vuh::BufferRangeExceeded if the range size differs from the image size
+	template<class It1, class It2>
+	auto fromHost(It1 begin, It2 end)-> void {
+		checkHostSize(size_t(std::distance(begin, end)));
+		using Stage = HostArray<T, AllocDevice<properties::HostCoherent>>;
+		auto stage = Stage(*_dev, begin, end);
+		copyBufToImage(*_dev, stage, *this, _extent);
+	}
+
+	/// Copy the image content to the host range (row-major, tightly packed).
+	/// Sync operation, goes through the host-visible staging buffer.
+	template<class It>
+	auto toHost(It copy_to) const-> void {
+		using Stage = HostArray<T, AllocDevice<properties::HostCached>>;
+		auto stage = Stage(*_dev, size());
+		copyImageToBuf(*_dev, *this, stage, _extent);
+		stage.invalidate_mapped_cache(0, stage.size_bytes());
+		std::copy(stage.begin(), stage.end(), copy_to);
+	}
+
+	/// @return copy of image data (row-major) in a host container.
+	template<class C=std::vector<T>>
+	auto toHost() const-> C {
+		auto r = C(size());
+		using std::begin;
+		toHost(begin(r));
+		return r;
+	}
+
+	/// @return descriptor info for binding the image as a storage image.
+	auto descriptor_image_info() const-> vk::DescriptorImageInfo {
+		return {nullptr, _view, vk::ImageLayout::eGeneral};
+	}
+
+	/// @return image width
+	auto width() const-> uint32_t { return _extent.width; }
+	/// @return image height
+	auto height() const-> uint32_t { return _extent.height; }
+	/// @return image dimensions
+	auto extent() const-> vk::Extent2D { return _extent; }
+	/// @return number of elements in the image
+	auto size() const-> size_t { return size_t(_extent.width)*_extent.height; }
+	/// @return size of the image data in bytes (as tightly packed in a buffer)
+	auto size_bytes() const-> size_t { return size()*sizeof(T); }
+	/// @return image format
+	static constexpr auto format()-> vk::Format { return ImageFormat<T>::value; }
+	/// @return view of the whole image
+	auto view() const-> vk::ImageView { return _view; }
+	/// @return sampler used when the image is bound as combined image sampler
+	auto sampler() const-> vk::Sampler { return _sampler; }
+	/// @return reference to device on which the image is allocated
+	auto device() const-> vuh::Device& { return *_dev; }
+
+	/// Check that the host range of n elements covers the image exactly, as the staging copy
+	/// of the image extent would read past a shorter range.
+	/// @throws vuh::BufferRangeExceeded
+	auto checkHostSize(size_t n) const-> void {
+		if(n != size()){
+			throw BufferRangeExceeded("host range of " + std::to_string(n) + " elements does not match the "
+			                          + std::to_string(_extent.width) + "x" + std::to_string(_extent.height)
+			                          + " image");
+		}
+	}
+private: // helpers
+	/// @return image create info for the image of given dimensions
+	static auto imageInfo(uint32_t width, uint32_t height, vk::ImageUsageFlags flags_usage
+	                      )-> vk::ImageCreateInfo
+	{
+		const auto usage = flags_usage | vk::ImageUsageFlagBits::eStorage
+		                   | vk::ImageUsageFlagBits::eSampled
+		                   | vk::ImageUsageFlagBits::eTransferSrc
+		                   | vk::ImageUsageFlagBits::eTransferDst;
+		return vk::ImageCreateInfo({}, vk::ImageType::e2D, format(), {width, height, 1}, 1, 1
+		                           , vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal
+		                           , usage, vk::SharingMode::eExclusive, 0, nullptr
+		                           , vk::ImageLayout::eUndefined);
+	}
+
+	/// @return sampler create info. Clamp to edge with linear filtering when the format supports it.
+	static auto samplerInfo(vuh::Device& device)-> vk::SamplerCreateInfo {
+		const auto features = device.phys().getFormatProperties(format()).optimalTilingFeatures;
+		const auto filter = (features & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)
+		                    ? vk::Filter::eLinear : vk::Filter::eNearest;
+		const auto address = vk::SamplerAddressMode::eClampToEdge;
+		return vk::SamplerCreateInfo({}, filter, filter, vk::SamplerMipmapMode::eNearest
+		                             , address, address, address);
+	}
+
+	/// release resources associated with current Image2D object
+	auto release() noexcept-> void {
+		if(static_cast<vk::Image&>(*this)){
+			_dev->destroySampler(_sampler);
+			_dev->destroyImageView(_view);
+			_dev->destroyImage(*this);
+			_dev->releaseMemory(_mem);
+		}
+	}
+private: // data
+	vk::DeviceMemory _mem;  ///< associated chunk of device memory
+	vk::ImageView _view;    ///< view of the whole image
+	vk::Sampler _sampler;   ///< sampler for combined image sampler binding
+	vuh::Device* _dev;      ///< referes underlying logical device
+	vk::Extent2D _extent;   ///< image dimensions
+}; // class Image2D
+} // namespace arr
+
+/// Image bound to kernels as a combined image sampler (sampler2D in glsl).
+/// Non-owning, underlying image should outlive the binding.
+template<class Image>
+class SampledImage {
+public:
+	using value_type = typename Image::value_type;
+	static constexpr auto descriptor_class = vk::DescriptorType::eCombinedImageSampler;
+
+	/// Constructor
+	explicit SampledImage(const Image& image): _image(&image) {}
+
+	/// @return descriptor info for binding the image with its sampler
+	auto descriptor_image_info() const-> vk::DescriptorImageInfo {
+		return {_image->sampler(), _image->view(), vk::ImageLayout::eGeneral};
+	}
+
+	/// @return underlying image
+	auto image() const-> const Image& { return *_image; }
+	/// @return reference to device on which the underlying image is allocated
+	auto device() const-> vuh::Device& { return _image->device(); }
+private: // data
+	const Image* _image; ///< underlying image
+}; // class SampledImage
+
+/// Wrap the image to be bound to kernels as a combined image sampler.
+template<class Image>
+auto sampled(const Image& image)-> SampledImage<Image> {
+	return SampledImage<Image>(image);
+}
+} // namespace vuh
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "allocDevice.hpp"
+
+#include <vuh/device.h>
+
+#include <vulkan/vulkan.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace vuh {
+namespace arr {
+
+/// Handle of the array declared in the TransientArena.
+template<class T>
+struct TransientHandle {
+	size_t id; ///< index of the array in the arena
+};
+
+/// Non-owning array living in the TransientArena memory.
+/// Binds to kernels as a storage buffer, valid as long as the arena is alive.
+template<class T>
+class TransientArray {
+public:
+	using value_type = T;
+	static constexpr auto descriptor_class = vk::DescriptorType::eStorageBuffer;
+
+	/// Constructor
+	TransientArray(vuh::Device& device, vk::Buffer buffer, size_t n_elements)
+	   : _dev(&device), _buffer(buffer), _size(n_elements)
+	{}
+
+	/// @return underlying buffer
+	auto buffer() const-> vk::Buffer { return _buffer; }
+	/// @return offset of the array data in the underlying buffer, always 0
+	auto offset_bytes() const-> size_t { return 0; }
+	/// @return number of elements
+	auto size() const-> size_t { return _size; }
+	/// @return size of the array data in bytes
+	auto size_bytes() const-> size_t { return _size*sizeof(T); }
+	/// @return reference to device on which the array is allocated
+	auto device() const-> vuh::Device& { return *_dev; }
+private: // data
+	vuh::Device* _dev;   ///< device the array is allocated on
+	vk::Buffer _buffer;  ///< buffer owned by the arena
+	size_t _size;        ///< number of elements
+}; // class TransientArray
+
+/// Arena of short-lived device arrays sharing a single memory allocation.
+/// Arrays are declared with the range of steps (e.g. indices of kernel dispatches) in which
+/// they are live. On commit() arrays with non-overlapping lifetimes are packed to the
+/// same memory, so that the arena only takes as much memory as the peak of simultaneously
+/// live arrays (plus some fragmentation) instead of the sum of all array sizes.
+/// Content of an array is undefined at the beginning of its lifetime.
+/// Aliasing is only safe when the dispatches of different steps do not overlap in time,
+/// that is when they are run synchronously or are otherwise waited for in order.
+/// Memory is allocated by the allocator defined by a template parameter.
+template<class Alloc>
+class TransientArena {
+	static constexpr auto buffer_usage = vk::BufferUsageFlagBits::eStorageBuffer
+	                                     | vk::BufferUsageFlagBits::eTransferSrc
+	                                     | vk::BufferUsageFlagBits::eTransferDst;
+public:
+	/// Constructor. Creates an empty arena.
+	explicit TransientArena(vuh::Device& device ///< device to allocate arrays on
+	                        , vk::MemoryPropertyFlags flags_memory={} ///< additional (to defined by allocator) memory flags
+	                        )
+	   : _dev(&device), _flags_memory(flags_memory)
+	{}
+
+	TransientArena(const TransientArena&) = delete;
+	auto operator=(const TransientArena&)-> TransientArena& = delete;
+
+	/// Move constructor.
+	TransientArena(TransientArena&& other) noexcept
+	   : _dev(other._dev), _flags_memory(other._flags_memory), _entries(std::move(other._entries))
+	   , _mem(other._mem), _size_bytes(other._size_bytes)
+	{
+		other._entries.clear();
+		other._mem = nullptr;
+	}
+
+	/// Move assignment. Resources of the current arena are released immediately.
+	auto operator=(TransientArena&& other) noexcept-> TransientArena& {
+		release();
+		_dev = other._dev;
+		_flags_memory = other._flags_memory;
+		_entries = std::move(other._entries);
+		_mem = other._mem;
+		_size_bytes = other._size_bytes;
+		other._entries.clear();
+		other._mem = nullptr;
+		return *this;
+	}
+
+	/// Release all arrays and the arena memory.
+	~TransientArena() noexcept { release(); }
+
+	/// Declare an array of n_elements live in steps [first_step, last_step].
+	/// @pre commit() was not called yet
+	template<class T>
+	auto add(size_t n_elements, size_t first_step, size_t last_step)-> TransientHandle<T> {
+		assert(!_mem);
+		assert(first_step <= last_step);
+		auto buffer = _dev->createBuffer({{}, std::max(n_elements*sizeof(T), size_t(1)), buffer_usage});
+		_entries.push_back({buffer, _dev->getBufferMemoryRequirements(buffer)
+		                    , n_elements, first_step, last_step, 0});
+		return {_entries.size() - 1};
+	}
+
+	/// Lay out the declared arrays and allocate the arena memory.
+	/// Arrays are placed in the order of decreasing size, each at the lowest (suitably aligned)
+	/// offset that does not intersect arrays with overlapping lifetime already placed.
+	auto commit()-> void {
+		assert(!_mem);
+		if(_entries.empty()){
+			return;
+		}
+		auto order = std::vector<size_t>(_entries.size());
+		std::iota(begin(order), end(order), size_t(0));
+		std::stable_sort(begin(order), end(order), [this](size_t a, size_t b){
+			return _entries[a].reqs.size > _entries[b].reqs.size;
+		});
+		auto reqs = vk::MemoryRequirements{0, 1, ~uint32_t(0)};
+		auto placed = std::vector<size_t>{};
+		for(auto id: order){
+			auto& e = _entries[id];
+			e.offset = lowest_offset(e, placed);
+			placed.push_back(id);
+			reqs.size = std::max(reqs.size, e.offset + e.reqs.size);
+			reqs.alignment = std::max(reqs.alignment, e.reqs.alignment);
+			reqs.memoryTypeBits &= e.reqs.memoryTypeBits;
+		}
+		if(reqs.memoryTypeBits == 0){
+			throw NoSuitableMemoryFound("no memory type is suitable for all arrays of the arena");
+		}
+		auto alloc = Alloc();
+		_mem = alloc.allocMemory(*_dev, reqs, _flags_memory);
+		_size_bytes = reqs.size;
+		for(const auto& e: _entries){
+			_dev->bindBufferMemory(e.buffer, _mem, e.offset);
+		}
+	}
+
+	/// @return the array corresponding to the handle.
+	/// @pre commit() was called
+	template<class T>
+	auto get(TransientHandle<T> h) const-> TransientArray<T> {
+		assert(_mem);
+		const auto& e = _entries.at(h.id);
+		return TransientArray<T>(*_dev, e.buffer, e.n_elements);
+	}
+
+	/// @return size of the arena memory (bytes), 0 before commit()
+	auto size_bytes() const-> size_t { return _size_bytes; }
+
+	/// @return total memory (bytes) the declared arrays would take without aliasing
+	auto unaliased_size_bytes() const-> size_t {
+		auto r = size_t(0);
+		for(const auto& e: _entries){
+			r += e.reqs.size;
+		}
+		return r;
+	}
+
+	/// @return number of declared arrays
+	auto count() const-> size_t { return _entries.size(); }
+private: // helpers
+	/// Declared array
+	struct Entry {
+		vk::Buffer buffer;          ///< buffer of the array
+		vk::MemoryRequirements reqs;///< memory requirements of the buffer
+		size_t n_elements;          ///< number of elements
+		size_t first_step;          ///< first step the array is live in
+		size_t last_step;           ///< last step the array is live in
+		vk::DeviceSize offset;      ///< offset of the array in arena memory
+	};
+
+	/// @return lowest offset at which the entry does not intersect the placed entries live
+	/// at the same time.
+	auto lowest_offset(const Entry& e, const std::vector<size_t>& placed) const-> vk::DeviceSize {
+		auto busy = std::vector<std::pair<vk::DeviceSize, vk::DeviceSize>>{}; // sorted [begin, end)
+		for(auto id: placed){
+			const auto& p = _entries[id];
+			if(p.first_step <= e.last_step && e.first_step <= p.last_step){
+				busy.emplace_back(p.offset, p.offset + p.reqs.size);
+			}
+		}
+		std::sort(begin(busy), end(busy));
+		auto offset = vk::DeviceSize(0);
+		for(const auto& b: busy){
+			if(offset + e.reqs.size <= b.first){
+				break;
+			}
+			if(b.second > offset){
+				offset = (b.second + e.reqs.alignment - 1)/e.reqs.alignment*e.reqs.alignment;
+			}
+		}
+		return offset;
+	}
+
+	/// Release all arrays and the arena memory.
+	auto release() noexcept-> void {
+		for(const auto& e: _entries){
+			_dev->destroyBuffer(e.buffer);
+		}
+		_entries.clear();
+		if(_mem){
+			_dev->releaseMemory(_mem);
+			_mem = nullptr;
+		}
+	}
+private: // data
+	vuh::Device* _dev;                     ///< device the arena is allocated on
+	vk::MemoryPropertyFlags _flags_memory; ///< additional memory flags
+	std::vector<Entry> _entries;           ///< declared arrays
+	vk::DeviceMemory _mem;                 ///< arena memory, null before commit()
+	size_t _size_bytes = 0;                ///< size of the arena memory
+}; // class TransientArena
+} // namespace arr
+} // namespace vuh
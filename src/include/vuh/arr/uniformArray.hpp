@@ -0,0 +1,110 @@
+#pragma once
+
+#include "basicArray.hpp"
+
+#include <vuh/device.h>
+
+#include <vulkan/vulkan.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+
+namespace vuh {
+namespace arr {
+
+/// Uniform buffer holding a single small read-only kernel parameter block of type T
+/// (aka constant memory). Suitable for parameters exceeding the push constants size limit.
+/// Memory is allocated in host-visible space, mapped once for the whole lifetime of the object
+/// and is split into a ring of slots each holding a copy of T.
+/// Every update() writes to the next slot, so that the values bound to the kernels still
+/// in flight (up to n_slots - 1 of them) are not overwritten.
+/// Array binds the current slot, so it should be (re)bound to a Program after update().
+/// Layout of T should match the std140 layout of the uniform block in the shader.
+template<class T, class Alloc>
+class UniformArray: public BasicArray {
+	using Base = BasicArray;
+	static_assert(std::is_trivially_copyable<T>::value, "uniform block type should be trivially copyable");
+public:
+	using value_type = T;
+	static constexpr auto descriptor_class = vk::DescriptorType::eUniformBuffer;
+
+	/// Construct object of the class on given device. Memory is not initialized.
+	explicit UniformArray(vuh::Device& device ///< device to create array on
+	                      , size_t n_slots=3  ///< number of ring slots
+	                      , vk::MemoryPropertyFlags flags_memory={} ///< additional (to defined by allocator) memory usage flags
+	                      , vk::BufferUsageFlags flags_buffer={}    ///< additional (to defined by allocator) buffer usage flags
+	                      )
+	   : UniformArray(device, n_slots, slot_stride(device), flags_memory, flags_buffer)
+	{}
+
+	/// Move constructor.
+	UniformArray(UniformArray&& o) noexcept
+	   : Base(std::move(o)), _stride(o._stride), _n_slots(o._n_slots), _slot(o._slot)
+	{}
+
+	/// Move operator.
+	auto operator=(UniformArray&& o) noexcept-> UniformArray& {
+		this->swap(o);
+		return *this;
+	}
+
+	/// Swap the guts of two arrays.
+	auto swap(UniformArray& o) noexcept-> void {
+		using std::swap;
+		swap(static_cast<Base&>(*this), static_cast<Base&>(o));
+		swap(_stride, o._stride);
+		swap(_n_slots, o._n_slots);
+		swap(_slot, o._slot);
+	}
+
+	/// Advance to the next ring slot and write the new value there.
+	/// Slot previously bound to kernels is left intact.
+	auto update(const T& value)-> UniformArray& {
+		_slot = (_slot + 1) % _n_slots;
+		write(value);
+		return *this;
+	}
+
+	/// @return value in the current slot
+	auto value() const-> const T& { return *reinterpret_cast<const T*>(Base::template mapMemory<char>() + _slot*_stride); }
+
+	/// @return offset of the current slot from the beginning of the buffer
+	auto offset_bytes() const-> std::size_t { return _slot*_stride; }
+
+	/// @return size of the bound range, the uniform block itself
+	auto size_bytes() const-> std::size_t { return sizeof(T); }
+
+	/// @return number of ring slots
+	auto slots() const-> std::size_t { return _n_slots; }
+private: // helpers
+	/// Helper constructor.
+	UniformArray(vuh::Device& device, size_t n_slots, size_t stride
+	             , vk::MemoryPropertyFlags flags_memory, vk::BufferUsageFlags flags_buffer)
+	   : Base((Alloc*)nullptr, device, n_slots*stride, flags_memory
+	          , vk::BufferUsageFlagBits::eUniformBuffer | flags_buffer)
+	   , _stride(stride)
+	   , _n_slots(n_slots)
+	{
+		assert(n_slots > 0);
+		Base::set_map_policy(MapPolicy::Persistent);
+	}
+
+	/// @return size of the ring slot, block size aligned to the device requirements.
+	static auto slot_stride(const vuh::Device& device)-> size_t {
+		const auto align = size_t(device.properties().limits.minUniformBufferOffsetAlignment);
+		return align > 1 ? (sizeof(T) + align - 1)/align*align : sizeof(T);
+	}
+
+	/// Write value to the current slot and make it visible to device.
+	auto write(const T& value)-> void {
+		std::memcpy(Base::template mapMemory<char>() + _slot*_stride, &value, sizeof(T));
+		Base::flush_mapped_writes(_slot*_stride, sizeof(T));
+	}
+private: // data
+	size_t _stride;      ///< distance between the ring slots in bytes
+	size_t _n_slots;     ///< number of ring slots
+	size_t _slot = 0;    ///< current slot
+}; // class UniformArray
+} // namespace arr
+} // namespace vuh
@@ -5,7 +5,11 @@
 #include "arr/arrayView.hpp"
 #include "arr/copy_async.hpp"
 #include "arr/deviceArray.hpp"
+#include "arr/deviceVector.hpp"
 #include "arr/hostArray.hpp"
+#include "arr/image2D.hpp"
+#include "arr/transientArena.hpp"
+#include "arr/uniformArray.hpp"
 
 namespace vuh {
 namespace detail {
@@ -42,6 +46,9 @@ namespace mem {
     using HostCachedCoherent = arr::AllocDevice<arr::properties::HostCachedCoherent>;
 } // namespace mem
 
+/// Host mapping policy of host-visible arrays.
+using MapPolicy = arr::MapPolicy;
+
 /// Maps Array classes with different data exchange interfaces, to a single templated type.
 /// This enables std::vector-like type declarations of Arrays with different allocators.
 /// Althogh in this case resulting classes have different data exchange interfaces,
@@ -50,4 +57,23 @@ template<class T, class Alloc=arr::AllocDevice<arr::properties::Device>,
          typename ImplSelector = typename Alloc::properties_t>
 using Array = typename detail::ArrayClass<ImplSelector>::template type<T, Alloc>;
 
+/// Uniform buffer holding a kernel parameter block of type T.
+/// Defaults to device-local host-visible coherent memory, falling back to host-visible.
+template<class T, class Alloc=mem::UnifiedCoherent>
+using UniformArray = arr::UniformArray<T, Alloc>;
+
+/// Resizable array in device memory with amortized O(1) appends.
+template<class T, class Alloc=mem::Device>
+using DeviceVector = arr::DeviceVector<T, Alloc>;
+
+/// Arena of short-lived device arrays aliasing the same memory when their lifetimes
+/// do not overlap. Defaults to device-local memory.
+template<class Alloc=mem::DeviceOnly>
+using TransientArena = arr::TransientArena<Alloc>;
+
+/// Two-dimensional image, binds as storage image or (wrapped with vuh::sampled()) as
+/// combined image sampler. Defaults to device-local memory.
+template<class T, class Alloc=mem::Device>
+using Image2D = arr::Image2D<T, Alloc>;
+
 } // namespace vuh
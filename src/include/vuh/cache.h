@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace vuh {
+	/// Persistent key-value store of measured device properties (probe and tuning results).
+	/// Backed by a text file with a "key<TAB>value" entry per line, loaded on construction
+	/// and rewritten on every update. Failing to read or write the file only loses the cached
+	/// values, it is never an error.
+	class DiskCache {
+	public:
+		explicit DiskCache(std::string path);
+
+		auto get(const std::string& key) const-> std::optional<std::string>;
+		auto set(const std::string& key, const std::string& value)-> void;
+		/// @return path of the backing file
+		auto path() const-> const std::string& { return _path; }
+
+		static auto defaultDir()-> std::string;
+		static auto deviceKey(vk::PhysicalDevice physdevice)-> std::string;
+	private: // data
+		std::string _path;                          ///< backing file
+		std::map<std::string, std::string> _values; ///< cached values
+		mutable std::mutex _mutex;                  ///< guards the values and the file
+	}; // class DiskCache
+} // namespace vuh
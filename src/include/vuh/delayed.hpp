@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.hpp>
 #include <vuh/device.h>
 #include <vuh/resource.hpp>
+#include <vuh/trace.h>
 
 #include <cassert>
 
@@ -90,6 +91,7 @@ namespace vuh {
 		         ) noexcept-> bool
 		{
 			if(_device){
+				VUH_TRACE_SCOPE("Delayed::wait", "sync");
 				(void)_device->waitForFences({*this}, true, period);
 				if(_device->getFenceStatus(*this) == vk::Result::eSuccess){
 					_device->destroyFence(*this);
@@ -100,6 +102,10 @@ namespace vuh {
 			}
             return false;
 		}
+
+		/// @return the associated action object.
+		/// Actions may carry results available after synchronization (like measured GPU time).
+		auto action() const-> const Action& { return *this; }
 	private: // data
 		std::unique_ptr<Device, util::NoopDeleter<Device>> _device; ///< refers to the device owning corresponding the underlying fence.
 	}; // class Delayed
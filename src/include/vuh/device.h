@@ -2,11 +2,26 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace vuh {
 	class Instance;
 
+	/// Memory heap usage summary.
+	struct HeapUsage {
+		vk::DeviceSize size_bytes = 0;        ///< total heap size
+		vk::DeviceSize allocated_bytes = 0;   ///< bytes currently allocated by vuh on this device
+		uint64_t allocation_count = 0;        ///< number of live allocations made by vuh on this device
+		vk::DeviceSize budget_bytes = 0;      ///< hard budget set with Device::setMemoryBudget(), 0 if none
+		vk::DeviceSize driver_budget_bytes = 0; ///< budget reported by the driver (VK_EXT_memory_budget), 0 if not available
+		vk::DeviceSize driver_usage_bytes = 0;  ///< heap usage by the whole process reported by the driver, 0 if not available
+	};
+
 	/// Logical device packed with associated command pools and buffers.
 	/// Holds the pool(s) for transfer and compute operations as well as command
 	/// buffers for sync operations.
@@ -28,17 +43,35 @@ namespace vuh {
 		auto operator=(Device&&) noexcept-> Device&;
 		friend auto swap(Device& d1, Device& d2)-> void;
 
-		auto properties() const-> vk::PhysicalDeviceProperties;
+		auto properties() const-> const vk::PhysicalDeviceProperties&;
+		auto limits() const-> const vk::PhysicalDeviceLimits&;
+		auto features() const-> const vk::PhysicalDeviceFeatures&;
+		auto queueFamilies() const-> const std::vector<vk::QueueFamilyProperties>&;
+		auto extensions() const-> const std::vector<vk::ExtensionProperties>&;
+		auto hasExtension(const char* name) const-> bool;
 		auto numComputeQueues() const-> uint32_t { return 1u;}
 		auto numTransferQueues() const-> uint32_t { return 1u;}
+		auto memoryProperties() const-> const vk::PhysicalDeviceMemoryProperties&;
 		auto memoryProperties(uint32_t id) const-> vk::MemoryPropertyFlags;
 		auto selectMemory(vk::Buffer buffer, vk::MemoryPropertyFlags properties) const-> uint32_t;
+		auto selectMemory(vk::Image image, vk::MemoryPropertyFlags properties) const-> uint32_t;
+		auto selectMemoryType(uint32_t memory_type_bits, vk::MemoryPropertyFlags properties) const-> uint32_t;
 		auto instance() const-> const vuh::Instance& {return _instance;}
 		auto hasSeparateQueues() const-> bool;
 
+		auto enableProfiling(bool enable=true)-> void;
+		auto profiling() const-> bool { return _profiling; }
+		auto timestampPeriod() const-> float { return _timestamp_period; }
+		auto timestampValidBits(bool transfer=false) const-> uint32_t;
+
 		auto computeQueue(uint32_t i = 0)-> vk::Queue;
 		auto transferQueue(uint32_t i = 0)-> vk::Queue;
 		auto alloc(vk::Buffer buf, uint32_t memory_id)-> vk::DeviceMemory;
+		auto allocMemory(uint32_t memory_id, vk::DeviceSize size_bytes)-> vk::DeviceMemory;
+		auto releaseMemory(vk::DeviceMemory memory) noexcept-> void;
+		auto heapCount() const-> uint32_t;
+		auto heapUsage(uint32_t heap_id) const-> HeapUsage;
+		auto setMemoryBudget(uint32_t heap_id, vk::DeviceSize budget_bytes)-> void;
 		auto computeCmdPool()-> vk::CommandPool {return _cmdpool_compute;}
 		auto computeCmdBuffer()-> vk::CommandBuffer& {return _cmdbuf_compute;}
 		auto transferCmdPool()-> vk::CommandPool;
@@ -52,6 +85,28 @@ namespace vuh {
         auto phys()-> vk::PhysicalDevice& { return _physdev; }
 		auto releaseComputeCmdBuffer()-> vk::CommandBuffer;
 
+		/// @return object cached under the key, created with make() (returning std::unique_ptr<T>)
+		/// on the first request. Used to keep compiled kernels of bundled algorithms.
+		/// Cached objects follow the device handle on move and swap and are destroyed before
+		/// the device is released, so they should refer to the vk::Device handle only.
+		/// Safe to call concurrently. make() runs without the lock, so it may request other cached
+		/// objects; if several threads create the same object, the first one stored is kept.
+		template<class T, class F>
+		auto cached(const std::string& key, F&& make)-> T& {
+			{
+				auto lock = std::lock_guard<std::mutex>(_cache->mutex);
+				auto it = _cache->objects.find(key);
+				if(it != _cache->objects.end()){
+					return *static_cast<T*>(it->second.get());
+				}
+			}
+			auto p = std::shared_ptr<T>(make());
+			auto lock = std::lock_guard<std::mutex>(_cache->mutex);
+			const auto& r = _cache->objects.emplace(key, std::move(p)).first->second;
+			return *static_cast<T*>(r.get());
+		}
+		auto clearCache() noexcept-> void;
+
         void resetComputeCmdBuffer();
         //compute, else transfer
         void freeCmdBuffer(vk::CommandBuffer buf, bool transfer = false);
@@ -67,6 +122,14 @@ namespace vuh {
                         , const std::vector<const char *> &extensions);
 		auto release() noexcept-> void;
 	private: // data
+		struct PhysicalInfo;
+		struct MemoryAccount;
+		/// Objects bound to the device, see cached(). Kept on the heap so the mutex moves along with
+		/// the device.
+		struct ObjectCache {
+			std::mutex mutex; ///< guards the map, not held while objects are created
+			std::unordered_map<std::string, std::shared_ptr<void>> objects;
+		};
 		vuh::Instance&     _instance;           ///< refer to Instance object used to create device
 		vk::PhysicalDevice _physdev;            ///< handle to associated physical device
 		vk::CommandPool    _cmdpool_compute;    ///< handle to command pool for compute commands
@@ -75,5 +138,12 @@ namespace vuh {
 		vk::CommandBuffer  _cmdbuf_transfer;    ///< primary command buffer associated with transfer command pool. Initialized on first transfer request.
 		uint32_t _cmp_family_id = uint32_t(-1); ///< compute queue family id. -1 if device does not have compute-capable queues.
 		uint32_t _tfr_family_id = uint32_t(-1); ///< transfer queue family id, maybe the same as compute queue id.
+		uint32_t _cmp_timestamp_bits = 0;       ///< number of valid bits in timestamps written by compute queue, 0 if not supported.
+		uint32_t _tfr_timestamp_bits = 0;       ///< number of valid bits in timestamps written by transfer queue, 0 if not supported (incl. transfer-only families).
+		float _timestamp_period = 0.f;          ///< number of nanoseconds per timestamp tick
+		bool _profiling = false;                ///< if true dispatches and copies are bracketed by timestamp queries
+		std::shared_ptr<const PhysicalInfo> _info;  ///< immutable physical device data captured at construction
+		std::unique_ptr<MemoryAccount> _memaccount; ///< per-heap accounting of memory allocated through this device
+		std::unique_ptr<ObjectCache> _cache;        ///< objects bound to this device, see cached()
 	}; // class Device
 }
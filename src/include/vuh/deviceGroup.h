@@ -0,0 +1,199 @@
+#pragma once
+
+#include "arr/arrayView.hpp"
+#include "arr/copy_async.hpp"
+#include "arr/deviceArray.hpp"
+#include "delayed.hpp"
+#include "device.h"
+#include "program.hpp"
+#include "trace.h"
+#include "traits.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace vuh {
+	class Instance;
+
+	/// Part of the 1D index range assigned to one device of the DeviceGroup.
+	struct Shard {
+		size_t device; ///< index of the device in the group
+		size_t first;  ///< first index of the shard
+		size_t last;   ///< one past the last index of the shard
+
+		/// @return number of indices in the shard
+		auto size() const-> size_t { return last - first; }
+	};
+
+	/// Set of logical devices sharing the 1D workload.
+	/// The index range is split between the devices proportionally to their weights.
+	/// Weights start equal and are updated from the throughput measured by run(), so that
+	/// the following splits balance the load. Same physical device may be added several times
+	/// (e.g. to test sharding with a single CPU implementation).
+	class DeviceGroup {
+	public:
+		/// Upper bound on a single fence wait of run() while other devices are still busy (ns).
+		static constexpr auto wait_slice_ns = uint64_t(200'000);
+
+		explicit DeviceGroup(vuh::Instance& instance);
+		DeviceGroup(vuh::Instance& instance, const std::vector<vk::PhysicalDevice>& physdevices);
+
+		DeviceGroup(const DeviceGroup&) = delete;
+		auto operator=(const DeviceGroup&)-> DeviceGroup& = delete;
+		DeviceGroup(DeviceGroup&&) = default;
+		auto operator=(DeviceGroup&&)-> DeviceGroup& = default;
+
+		/// @return number of devices in the group
+		auto size() const-> size_t { return _devices.size(); }
+		/// @return i-th device of the group
+		auto device(size_t i)-> vuh::Device& { return _devices.at(i); }
+
+		auto weights() const-> const std::vector<double>& { return _weights; }
+		auto setWeights(std::vector<double> weights)-> void;
+		auto setSmoothing(double smoothing)-> void;
+		auto split(size_t n_items, size_t granule=1) const-> std::vector<Shard>;
+		auto updateWeights(const std::vector<Shard>& shards, const std::vector<double>& seconds)-> void;
+
+		/// Run the dispatch on every non-empty shard, without waiting.
+		/// Dispatch is a callable of a form Delayed<detail::Compute>(const Shard&), normally
+		/// running the program of the shard device on the array views of the shard.
+		/// @return synchronization tokens, one per non-empty shard (in the order of shards)
+		template<class F>
+		auto run_async(const std::vector<Shard>& shards, F&& dispatch
+		               )-> std::vector<vuh::Delayed<detail::Compute>>
+		{
+			VUH_TRACE_SCOPE("DeviceGroup::run_async", "compute");
+			auto r = std::vector<vuh::Delayed<detail::Compute>>{};
+			r.reserve(shards.size());
+			for(const auto& s: shards){
+				if(s.size() > 0){
+					r.push_back(dispatch(s));
+				}
+			}
+			return r;
+		}
+
+		/// Run the dispatch on every non-empty shard and wait for completion.
+		/// Completion time of each device is measured and used to update the device weights.
+		/// The host thread sleeps in the driver fence waits, each bounded by wait_slice_ns while
+		/// several devices are still busy, so completion times are accurate to about that slice
+		/// times the number of devices.
+		template<class F>
+		auto run(const std::vector<Shard>& shards, F&& dispatch)-> void {
+			VUH_TRACE_SCOPE("DeviceGroup::run", "compute");
+			using clock = std::chrono::steady_clock;
+			const auto start = clock::now();
+			auto tokens = run_async(shards, std::forward<F>(dispatch));
+			auto busy = std::vector<size_t>{}; // indices of non-empty shards, same order as tokens
+			for(size_t i = 0; i < shards.size(); ++i){
+				if(shards[i].size() > 0){
+					busy.push_back(i);
+				}
+			}
+			auto seconds = std::vector<double>(shards.size(), 0.);
+			for(auto pending = tokens.size(); pending > 0;){
+				for(size_t i = 0; i < tokens.size(); ++i){
+					if(seconds[busy[i]] != 0.){
+						continue;
+					}
+					// the last busy device is waited for without timeout
+					const auto timeout = pending > 1 ? wait_slice_ns : uint64_t(-1);
+					auto& dev = device(shards[busy[i]].device);
+					if(dev.waitForFences({tokens[i]}, true, timeout) == vk::Result::eSuccess){
+						const auto dt = std::chrono::duration<double>(clock::now() - start).count();
+						seconds[busy[i]] = std::max(dt, 1e-9);
+						--pending;
+					}
+				}
+			}
+			for(auto& t: tokens){
+				t.wait();
+			}
+			updateWeights(shards, seconds);
+		}
+	private: // data
+		std::vector<vuh::Device> _devices; ///< devices of the group, never reallocated
+		std::vector<double> _weights;      ///< normalized relative device throughput
+		double _smoothing = 0.5;           ///< weight of the new measurement in the weights update
+	}; // class DeviceGroup
+
+	/// Device array split between the devices of the group.
+	/// Shard layout is fixed at construction, shard i lives on device shards()[i].device.
+	template<class T, class Alloc=arr::AllocDevice<arr::properties::Device>>
+	class ShardedArray {
+	public:
+		using array_type = arr::DeviceArray<T, Alloc>;
+
+		/// Create the array of n_elements split by the current group weights.
+		/// Shard boundaries are multiples of granule (e.g. the workgroup size). Memory is uninitialized.
+		ShardedArray(DeviceGroup& group, size_t n_elements, size_t granule=1)
+		   : _shards(group.split(n_elements, granule)), _size(n_elements)
+		{
+			_arrays.reserve(_shards.size());
+			for(const auto& s: _shards){
+				_arrays.emplace_back(group.device(s.device), std::max(s.size(), size_t(1)));
+			}
+		}
+
+		/// Create the array and scatter the host data to the shards.
+		template<class It1, class It2
+		         , class=std::enable_if_t<traits::are_comparable_host_iterators<It1, It2>::value>>
+		ShardedArray(DeviceGroup& group, It1 begin, It2 end, size_t granule=1)
+		   : ShardedArray(group, size_t(std::distance(begin, end)), granule)
+		{
+			auto tokens = std::vector<vuh::Delayed<Copy>>{};
+			tokens.reserve(_shards.size());
+			for(size_t i = 0; i < _shards.size(); ++i){
+				if(_shards[i].size() > 0){
+					tokens.push_back(copy_async(std::next(begin, std::ptrdiff_t(_shards[i].first))
+					                            , std::next(begin, std::ptrdiff_t(_shards[i].last))
+					                            , device_begin(_arrays[i])));
+				}
+			}
+		}
+
+		/// @return shard layout
+		auto shards() const-> const std::vector<Shard>& { return _shards; }
+		/// @return array of the i-th shard
+		auto shard(size_t i)-> array_type& { return _arrays.at(i); }
+		/// @return view of the valid data of the i-th shard, to be bound to kernels
+		auto view(size_t i)-> ArrayView<array_type> {
+			return array_view(_arrays.at(i), 0, _shards.at(i).size());
+		}
+		/// @return total number of elements
+		auto size() const-> size_t { return _size; }
+
+		/// Gather the shards to host. Transfers from all devices run concurrently.
+		template<class It>
+		auto toHost(It dst_begin)-> void {
+			auto tokens = std::vector<vuh::Delayed<Copy>>{};
+			tokens.reserve(_shards.size());
+			for(size_t i = 0; i < _shards.size(); ++i){
+				if(_shards[i].size() > 0){
+					auto first = device_begin(_arrays[i]);
+					tokens.push_back(copy_async(first, first + _shards[i].size()
+					                            , std::next(dst_begin, std::ptrdiff_t(_shards[i].first))));
+				}
+			}
+		}
+
+		/// @return host container with a copy of the array data.
+		template<class C>
+		auto toHost()-> C {
+			auto r = C(_size);
+			using std::begin;
+			toHost(begin(r));
+			return r;
+		}
+	private: // data
+		std::vector<Shard> _shards;      ///< shard layout
+		std::vector<array_type> _arrays; ///< per-shard arrays
+		size_t _size;                    ///< total number of elements
+	}; // class ShardedArray
+} // namespace vuh
@@ -11,10 +11,76 @@ namespace vuh {
 		NoSuitableMemoryFound(const char* message);
 	};
 
+	/// Exception indicating that an allocation would exceed the memory budget set for the heap.
+	/// Derives from vk::OutOfDeviceMemoryError, but unlike the driver allocation failure it is not
+	/// handled by falling back to other memory types: it always reaches the caller.
+	class MemoryBudgetExceeded: public vk::OutOfDeviceMemoryError {
+	public:
+		MemoryBudgetExceeded(const std::string& message);
+		MemoryBudgetExceeded(const char* message);
+	};
+
+	/// Exception indicating that no device satisfies the requested criteria.
+	class NoSuitableDeviceFound: public std::runtime_error {
+	public:
+		NoSuitableDeviceFound(const std::string& message);
+		NoSuitableDeviceFound(const char* message);
+	};
+
 	/// Exception indicating failure to read a file.
 	class FileReadFailure: public std::runtime_error {
 	public:
 		FileReadFailure(const std::string& message);
 		FileReadFailure(const char* message);
 	};
+
+	/// Exception indicating failure to write a file.
+	class FileWriteFailure: public std::runtime_error {
+	public:
+		FileWriteFailure(const std::string& message);
+		FileWriteFailure(const char* message);
+	};
+
+	/// Exception indicating that the kernel interface declared on the host side
+	/// (push constants, specialization constants, array parameters) does not match
+	/// the one declared in the shader code.
+	class ShaderInterfaceMismatch: public std::logic_error {
+	public:
+		ShaderInterfaceMismatch(const std::string& message);
+		ShaderInterfaceMismatch(const char* message);
+	};
+
+	/// Exception indicating that the buffer range bound to a kernel exceeds the device limit
+	/// (maxStorageBufferRange or maxUniformBufferRange). Bind array views instead.
+	/// Also thrown when the region of a multi-region or 2D copy does not fit in its array.
+	class BufferRangeExceeded: public std::length_error {
+	public:
+		BufferRangeExceeded(const std::string& message);
+		BufferRangeExceeded(const char* message);
+	};
+
+	/// Exception indicating that the array view bound to a kernel starts at the offset which is not
+	/// a multiple of minStorageBufferOffsetAlignment (minUniformBufferOffsetAlignment),
+	/// or that the range of the device-side fill or update is not aligned to 4 bytes.
+	class BufferOffsetMisaligned: public std::invalid_argument {
+	public:
+		BufferOffsetMisaligned(const std::string& message);
+		BufferOffsetMisaligned(const char* message);
+	};
+
+	/// Exception indicating that the arrays passed to an operation live on different devices
+	/// where the operation needs them on the same one.
+	class DeviceMismatch: public std::invalid_argument {
+	public:
+		DeviceMismatch(const std::string& message);
+		DeviceMismatch(const char* message);
+	};
+
+	/// Exception indicating that the device does not support the feature (e.g. shaderInt64)
+	/// needed by the kernel.
+	class DeviceFeatureMissing: public std::runtime_error {
+	public:
+		DeviceFeatureMissing(const std::string& message);
+		DeviceFeatureMissing(const char* message);
+	};
 } // namespace vuh
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "arr/copy_async.hpp"
+#include "arr/deviceArray.hpp"
+#include "delayed.hpp"
+#include "device.h"
+#include "trace.h"
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace vuh {
+	/// Byte range of a file on disk. Source or destination of the copy_async file transfers.
+	struct FileRange {
+		std::string path;                  ///< file path
+		size_t offset = 0;                 ///< offset of the range from the beginning of file (bytes)
+		size_t size_bytes = size_t(-1);    ///< range size, size_t(-1) for the rest of the file
+	};
+
+	/// @return file range to be used with copy_async
+	inline auto file(std::string path, size_t offset=0, size_t size_bytes=size_t(-1))-> FileRange {
+		return FileRange{std::move(path), offset, size_bytes};
+	}
+
+	namespace detail {
+		/// Ring of host-visible staging buffers used for the pipelined file transfers.
+		/// Keeps the staging resources alive till the transfer completes, delayed action is a noop.
+		class FileStage {
+		public:
+			explicit FileStage(vuh::Device& device);
+			FileStage(FileStage&&) noexcept;
+			auto operator=(FileStage&&) noexcept-> FileStage&;
+			~FileStage() noexcept;
+
+			auto upload(const FileRange& src, vk::Buffer dst, size_t dst_offset, size_t max_bytes)-> vk::Fence;
+			auto download(vk::Buffer src, size_t src_offset, size_t size_bytes, const FileRange& dst)-> void;
+
+			/// delayed operation is a noop
+			constexpr auto operator()() const-> void {}
+		private:
+			struct Impl;
+			std::unique_ptr<Impl> _impl;
+		}; // class FileStage
+	} // namespace detail
+
+	/// Async copy of the file range to the device array.
+	/// Copies min(file range size, space left in the array) bytes.
+	/// File is read in chunks directly to a ring of staging buffers, so reading the next chunk
+	/// overlaps with the transfer of the previous ones and no intermediate host copy of the whole
+	/// data is made. The call blocks till the file is read, only the last transfers are async.
+	/// @throws vuh::FileReadFailure
+	template<class T, class Alloc>
+	auto copy_async(const FileRange& src, ArrayIter<arr::DeviceArray<T, Alloc>> dst_begin
+	                )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("copy_async file", "transfer");
+		auto& array = dst_begin.array();
+		auto stage = detail::FileStage(array.device());
+		const auto dst_offset = dst_begin.offset()*sizeof(T);
+		auto fence = stage.upload(src, array, dst_offset, array.size_bytes() - dst_offset);
+		return Delayed<Copy>{Delayed<>{fence, array.device()}, Copy::wrap(std::move(stage))};
+	}
+
+	/// Copy the range of device array to the file.
+	/// Copies min(array range size, file range size) bytes, so data beyond the end of the
+	/// destination range is not written (the default range size reaches to the end of file).
+	/// File is created if it does not exist, otherwise it is overwritten only within the
+	/// destination range (not truncated).
+	/// Transfers are pipelined through a ring of staging buffers, so that writing a chunk to the
+	/// file overlaps with the transfers of the next ones. The call blocks till the data
+	/// is written, returned object is already signalled.
+	/// @throws vuh::FileWriteFailure
+	template<class T, class Alloc>
+	auto copy_async(ArrayIter<arr::DeviceArray<T, Alloc>> src_begin
+	                , ArrayIter<arr::DeviceArray<T, Alloc>> src_end
+	                , const FileRange& dst
+	                )-> vuh::Delayed<Copy>
+	{
+		VUH_TRACE_SCOPE("copy_async file", "transfer");
+		auto& array = src_begin.array();
+		auto stage = detail::FileStage(array.device());
+		stage.download(array, src_begin.offset()*sizeof(T), (src_end - src_begin)*sizeof(T), dst);
+		return Delayed<Copy>{array.device(), Copy::wrap(std::move(stage))};
+	}
+} // namespace vuh
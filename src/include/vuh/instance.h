@@ -2,6 +2,7 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <string>
 #include <vector>
 
 namespace vuh {
@@ -9,6 +10,16 @@ namespace vuh {
 
 	using debug_reporter_t = PFN_vkDebugReportCallbackEXT;
 
+	/// Requirements and preferences used to rank the devices by Instance::bestDevice().
+	struct DeviceCriteria {
+		std::vector<std::string> extensions;      ///< required device extensions
+		vk::DeviceSize min_device_local_bytes = 0; ///< minimal size of the largest device-local heap
+		uint32_t min_subgroup_size = 0;           ///< minimal subgroup size (needs Vulkan 1.1 instance, ignored if 0)
+		bool allow_cpu = true;                    ///< accept software (CPU) implementations
+		bool probe = false;                       ///< rank by measured copy bandwidth first
+		std::string probe_cache;                  ///< file caching the probe results, empty for the default one
+	};
+
 	/// Working with vuh starts from creating an object of this class.
 	/// Its main responsibility is listing the available devices and handling extensions and layers.
 	/// It is also responsible for logging vuh and vulkan messages.
@@ -31,10 +42,15 @@ namespace vuh {
 		auto operator= (Instance&&) noexcept-> Instance&;
 
 		auto devices()-> std::vector<vk::PhysicalDevice>;
+		auto rankDevices(const DeviceCriteria& criteria={})-> std::vector<vk::PhysicalDevice>;
+		auto bestDevice(const DeviceCriteria& criteria={})-> vk::PhysicalDevice;
 		auto report(const char* prefix, const char* message
 		            , VkDebugReportFlagsEXT flags=VK_DEBUG_REPORT_INFORMATION_BIT_EXT) const-> void;
 
         static uint32_t getInstanceVersion();
+		/// @return Vulkan version requested by the application at instance creation.
+		/// Device functionality beyond that version should not be used.
+		auto apiVersion() const-> uint32_t { return _api_version; }
 
 	private: // helpers
 		auto clear() noexcept-> void;
@@ -42,5 +58,6 @@ namespace vuh {
 		vk::Instance _instance;     ///< vulkan instance
 		debug_reporter_t _reporter; ///< points to actual reporting function. This pointer is registered with a reporter callback but can also be used directly.
 		VkDebugReportCallbackEXT _reporter_cbk; ///< report callback. Only used to release the handle in the end.
+		uint32_t _api_version;      ///< Vulkan version requested in the application info
 	}; // class Instance
 } // namespace vuh
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vuh/device.h>
+#include <vuh/instance.h>
+#include <vuh/resource.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace vuh {
+	/// Aggregate statistics of measured GPU execution times.
+	struct ProfileStats {
+		uint64_t count = 0;     ///< number of measurements
+		double total_ns = 0.;   ///< total measured time (ns)
+		double min_ns = std::numeric_limits<double>::max(); ///< shortest measured time (ns)
+		double max_ns = 0.;     ///< longest measured time (ns)
+
+		/// Add a measurement.
+		auto add(double ns)-> void {
+			++count;
+			total_ns += ns;
+			min_ns = std::min(min_ns, ns);
+			max_ns = std::max(max_ns, ns);
+		}
+
+		/// @return mean measured time (ns), 0 if nothing was measured.
+		auto mean_ns() const-> double { return count ? total_ns/double(count) : 0.; }
+
+		/// Forget all measurements.
+		auto reset()-> void { *this = ProfileStats{}; }
+	}; // struct ProfileStats
+
+	namespace detail {
+		/// Pair of timestamp queries bracketing the commands recorded to a command buffer.
+		/// Inactive (all operations are noops) unless profiling is enabled on the device and
+		/// timestamps are supported by the queue family the commands are submitted to.
+		struct _TimestampQuery {
+			/// Constructor. Creates inactive query.
+			_TimestampQuery() = default;
+
+			/// Constructor. Creates the query pool if profiling is enabled on the device.
+			explicit _TimestampQuery(vuh::Device& device ///< device to create query pool on
+			                         , bool transfer=false ///< true if commands go to the transfer queue
+			                         )
+			{
+				const auto bits = device.timestampValidBits(transfer);
+				if(device.profiling() && bits > 0){
+					pool = device.createQueryPool({{}, vk::QueryType::eTimestamp, 2});
+					mask = bits < 64 ? (uint64_t(1) << bits) - 1 : ~uint64_t(0);
+					this->device.reset(&device);
+				}
+			}
+
+			/// @return true if the query is active
+			explicit operator bool() const { return bool(device); }
+
+			/// Record the reset of the queries and the starting timestamp.
+			/// Should be recorded right after the command buffer begin.
+			auto begin(vk::CommandBuffer cmd_buf) const-> void {
+				if(device){
+					cmd_buf.resetQueryPool(pool, 0, 2);
+					cmd_buf.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, pool, 0);
+				}
+			}
+
+			/// Record the finishing timestamp.
+			/// Should be recorded right before the command buffer end.
+			auto end(vk::CommandBuffer cmd_buf) const-> void {
+				if(device){
+					cmd_buf.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, pool, 1);
+				}
+			}
+
+			/// Read the time elapsed between the timestamps (ns) to ns.
+			/// Does not throw, failure to read the results is reported through the instance reporter.
+			/// @return false if the query is inactive or its results could not be read.
+			/// @pre submitted commands should be complete.
+			auto read_ns(double& ns) const-> bool {
+				if(!device){
+					return false;
+				}
+				auto ticks = std::array<uint64_t, 2>{};
+				const auto result = device->getQueryPoolResults(pool, 0, 2, sizeof(ticks), ticks.data()
+				                                                , sizeof(uint64_t)
+				                                                , vk::QueryResultFlagBits::e64
+				                                                  | vk::QueryResultFlagBits::eWait);
+				if(result != vk::Result::eSuccess){
+					device->instance().report("TimestampQuery", "failed to read timestamp query results"
+					                          , VK_DEBUG_REPORT_WARNING_BIT_EXT);
+					return false;
+				}
+				ns = double((ticks[1] - ticks[0]) & mask)*device->timestampPeriod();
+				return true;
+			}
+
+			/// @return time elapsed between the timestamps (ns), 0 if the query is inactive
+			/// or its results could not be read.
+			/// @pre submitted commands should be complete.
+			auto elapsed_ns() const-> double {
+				auto ns = 0.;
+				return read_ns(ns) ? ns : 0.;
+			}
+
+			/// Release the query pool.
+			auto release() noexcept-> void {
+				if(device){
+					device->destroyQueryPool(pool);
+				}
+			}
+		public: // data
+			vk::QueryPool pool;   ///< pool of two timestamp queries
+			uint64_t mask = 0;    ///< mask of valid timestamp bits
+			std::unique_ptr<vuh::Device, util::NoopDeleter<vuh::Device>> device; ///< device owning the pool, null if inactive
+		}; // struct _TimestampQuery
+
+		/// Movable timestamp query pair.
+		using TimestampQuery = util::Resource<_TimestampQuery>;
+	} // namespace detail
+} // namespace vuh
@@ -4,11 +4,17 @@
 #include "device.h"
 #include "utils.h"
 #include "delayed.hpp"
+#include "error.h"
+#include "profile.hpp"
+#include "reflect.h"
+#include "trace.h"
 
 #include <vulkan/vulkan.hpp>
 
 #include <array>
 #include <cstddef>
+#include <memory>
+#include <string>
 #include <tuple>
 #include <utility>
 
@@ -62,25 +68,62 @@ namespace vuh {
 			return spec2entries(specs, std::make_index_sequence<sizeof...(Ts)>{});
 		}
 
+		/// @return true if the descriptor type refers to an image (as opposed to a buffer)
+		constexpr auto isImageDescriptor(vk::DescriptorType type)-> bool {
+			return type == vk::DescriptorType::eStorageImage
+			       || type == vk::DescriptorType::eCombinedImageSampler
+			       || type == vk::DescriptorType::eSampledImage;
+		}
+
+		/// @return buffer descriptor info for the array argument, empty info for images
+		template<class Arr>
+		auto dscBufferInfo(Arr& arr)-> vk::DescriptorBufferInfo {
+			if constexpr(isImageDescriptor(DictTypeToDsc<Arr>::value)){
+				return {};
+			} else {
+				return {arr.buffer(), arr.offset_bytes(), arr.size_bytes()};
+			}
+		}
+
+		/// @return image descriptor info for the image argument, empty info for buffers
+		template<class Arr>
+		auto dscImageInfo(Arr& arr)-> vk::DescriptorImageInfo {
+			if constexpr(isImageDescriptor(DictTypeToDsc<Arr>::value)){
+				return arr.descriptor_image_info();
+			} else {
+				return {};
+			}
+		}
+
 		// helper
-        template<class T, class T1, size_t... I>
-        auto dscinfos2writesets(vk::DescriptorSet dscset, const T& infos, const T1& infostex
+        template<class T, class T1, class T2, size_t... I>
+        auto dscinfos2writesets(vk::DescriptorSet dscset
+		                        , const std::array<vk::DescriptorType, sizeof...(I)>& dsc_types
+		                        , const T& infos, const T1& infostex, const T2& infosimg
 		                        , std::index_sequence<I...>
 		                        )-> std::array<vk::WriteDescriptorSet, sizeof...(I)>
 		{
             auto istex = [&](int i) {
                 return (bool)infostex[i];
+            };
+            auto isimg = [&](int i) {
+                return isImageDescriptor(dsc_types[i]);
             };
 			auto r = std::array<vk::WriteDescriptorSet, sizeof...(I)>{{
                 {dscset, uint32_t(I), 0, 1,
-                                istex(I) ? vk::DescriptorType::eStorageTexelBuffer : vk::DescriptorType::eStorageBuffer,
-                                nullptr, istex(I) ? nullptr : &infos[I], istex(I) ? &infostex[I] : nullptr}...
+                                istex(I) ? vk::DescriptorType::eStorageTexelBuffer : dsc_types[I],
+                                isimg(I) ? &infosimg[I] : nullptr,
+                                (istex(I) || isimg(I)) ? nullptr : &infos[I],
+                                istex(I) ? &infostex[I] : nullptr}...
 			}};
 			return r;
 		}
 
 		/// Transient command buffer data with a releaseable interface.
 		struct ComputeBuffer {
+			/// Default constructor. Holds no buffer.
+			ComputeBuffer() = default;
+
 			/// Constructor. Takes ownership over provided buffer.
 			ComputeBuffer(vuh::Device& device, vk::CommandBuffer buffer)
 			   : cmd_buffer(buffer), device(&device){}
@@ -98,15 +141,40 @@ namespace vuh {
 		}; // struct ComputeData
 
 		/// Helper class for use as a Delayed<> parameter extending the lifetime of the command
-		/// buffer and a noop triggered action.
+		/// buffer (and timestamp queries if profiling).
+		/// Triggered action collects the measured GPU time, noop if not profiling.
 		struct Compute: private util::Resource<ComputeBuffer> {
+			/// Default constructor. Holds no resources, needed to move Delayed<Compute>.
+			Compute() = default;
+
 			/// Constructor
-			explicit Compute(vuh::Device& device, vk::CommandBuffer buffer)
+			explicit Compute(vuh::Device& device, vk::CommandBuffer buffer
+			                 , TimestampQuery timer={}                    ///< queries bracketing the dispatch
+			                 , std::shared_ptr<ProfileStats> stats=nullptr ///< statistics to add measured time to
+			                 )
 			   : Resource<ComputeBuffer>(device, std::move(buffer))
+			   , _timer(std::move(timer))
+			   , _stats(std::move(stats))
 			{}
 
-			/// Noop. Action to be triggered when the fence is signaled.
-			constexpr auto operator()() noexcept-> void {}
+			/// Action to be triggered when the fence is signaled.
+			/// Does not throw: timestamps that could not be read are reported and not counted.
+			auto operator()() noexcept-> void {
+				if(_timer && _timer.read_ns(_elapsed_ns)){
+					VUH_TRACE_GPU("dispatch", "compute", _elapsed_ns, false);
+					if(_stats){
+						_stats->add(_elapsed_ns);
+					}
+				}
+			}
+
+			/// @return GPU time of the dispatch (ns), 0 if not profiling.
+			/// @pre the fence should be signalled (Delayed::wait() returned true).
+			auto elapsed_ns() const-> double { return _elapsed_ns; }
+		private: // data
+			TimestampQuery _timer;                ///< timestamps bracketing the dispatch
+			std::shared_ptr<ProfileStats> _stats; ///< per-program statistics
+			double _elapsed_ns = 0.;              ///< measured GPU time
 		}; // struct Compute
 
 		/// Program base functionality.
@@ -117,6 +185,7 @@ namespace vuh {
 			/// @pre bacth sizes should be specified before calling this.
 			/// @pre all paramerters should be specialized, pushed and bound before calling this.
 			auto run(const vk::Semaphore *signal_sem = nullptr, const vk::Semaphore *wait_sem = nullptr, bool transfer = false) const -> void {
+				VUH_TRACE_SCOPE("Program::run", "compute");
                 vk::PipelineStageFlags sem_flags = vk::PipelineStageFlagBits::eAllCommands;
 				auto submitInfo = vk::SubmitInfo(wait_sem ? 1 : 0, wait_sem, &sem_flags,
                                                  1, transfer ? &_device.transferCmdBuffer() : &_device.computeCmdBuffer(),
@@ -125,12 +194,21 @@ namespace vuh {
 				// submit the command buffer to the queue and set up a fence.
 				auto queue = transfer ? _device.transferQueue() : _device.computeQueue();
 				queue.submit({submitInfo}, nullptr);
-				queue.waitIdle();
+				{
+					VUH_TRACE_SCOPE("Queue::waitIdle", "sync");
+					queue.waitIdle();
+				}
+				auto elapsed = 0.;
+				if(_timer && !transfer && _timer.read_ns(elapsed)){
+					VUH_TRACE_GPU("dispatch", "compute", elapsed, false);
+					_stats->add(elapsed);
+				}
 			}
 
 			/// Run the Program object on previously bound parameters.
 			/// @return Delayed<Compute> object used for synchronization with host
 			auto run_async()-> vuh::Delayed<Compute> const {
+				VUH_TRACE_SCOPE("Program::run_async", "compute");
 				auto buffer = _device.releaseComputeCmdBuffer();
 				auto submitInfo = vk::SubmitInfo(0, nullptr, nullptr, 1, &buffer); // submit a single command buffer
 
@@ -139,22 +217,31 @@ namespace vuh {
 				auto fence = _device.createFence(vk::FenceCreateInfo()); // fence makes sure the control is not returned to CPU till command buffer is depleted
 				queue.submit({submitInfo}, fence);
 
-				return Delayed<Compute>{fence, _device, Compute(_device, buffer)};
+				// submitted buffer refers to the current queries, new ones are created on next recording
+				auto timer = std::move(_timer);
+				return Delayed<Compute>{fence, _device, Compute(_device, buffer, std::move(timer), _stats)};
 			}
 
+			/// @return GPU time statistics of all profiled runs of the program.
+			/// Async runs are only accounted after synchronization.
+			/// Profiling should be enabled on the device (Device::enableProfiling()).
+			auto profile() const-> const ProfileStats& { return *_stats; }
+
+			/// Reset the GPU time statistics.
+			auto reset_profile()-> void { _stats->reset(); }
+
             /// Binds a pipeline and a descriptor set.
             template<class... Arrs>
             auto bind_descset(Arrs&... arrs)-> void {
                 constexpr auto N = sizeof...(arrs);
-                auto dscinfos = std::array<vk::DescriptorBufferInfo, N>{
-                                               {{arrs.buffer()
-                                               , arrs.offset_bytes()
-                                               , arrs.size_bytes()}... }
-                                };
+                auto dscinfos = std::array<vk::DescriptorBufferInfo, N>{{dscBufferInfo(arrs)...}};
+                check_ranges(typesToDscTypes<Arrs...>(), dscinfos);
+                auto dscinfosimg = std::array<vk::DescriptorImageInfo, N>{{dscImageInfo(arrs)...}};
                 auto dscinfostex = std::array<vk::BufferView, N>{
                                                { {[](auto& arr){ if constexpr(std::is_base_of_v<vk::BufferView, std::decay_t<decltype(arr)>>) return arr; else return nullptr; }(arrs)}... }
                                 };
-                auto write_dscsets = dscinfos2writesets(_dscset, dscinfos, dscinfostex
+                auto write_dscsets = dscinfos2writesets(_dscset, typesToDscTypes<Arrs...>()
+                                                       , dscinfos, dscinfostex, dscinfosimg
                                                        , std::make_index_sequence<N>{});
                 _device.updateDescriptorSets(write_dscsets, {}); // associate buffers to binding points in bindLayout
             }
@@ -190,6 +277,7 @@ namespace vuh {
 			            , vk::ShaderModuleCreateFlags flags={}
 			            )
 			   : _device(device)
+			   , _interface(reflect_spirv(reinterpret_cast<const uint32_t*>(code.data()), code.size()))
 			{
 				_shader = device.createShaderModule({ flags, uint32_t(code.size())
 				                                    , reinterpret_cast<const uint32_t*>(code.data())
@@ -201,6 +289,7 @@ namespace vuh {
 			            , vk::ShaderModuleCreateFlags flags={}
 			            )
 			   : _device(device)
+			   , _interface(reflect_spirv(code, size))
 			{
 				_shader = device.createShaderModule({ flags, size
 				                                    , code
@@ -226,6 +315,9 @@ namespace vuh {
 			   , _pipeline(o._pipeline)
 			   , _device(o._device)
 			   , _batch(o._batch)
+			   , _interface(std::move(o._interface))
+			   , _timer(std::move(o._timer))
+			   , _stats(std::move(o._stats))
 			{
 				o._shader = nullptr; //
 			}
@@ -244,6 +336,9 @@ namespace vuh {
 				_pipeline   = o._pipeline;
 				_device     = o._device;
 				_batch      = o._batch;	
+				_interface  = std::move(o._interface);
+				_timer      = std::move(o._timer);
+				_stats      = std::move(o._stats);
 			
 				o._shader = nullptr;
 				return *this;
@@ -266,6 +361,7 @@ namespace vuh {
 			template<size_t N, class... Arrs>
 			auto init_pipelayout(const std::array<vk::PushConstantRange, N>& psrange, Arrs&...)-> void {
 				auto dscTypes = typesToDscTypes<Arrs...>();
+				check_bindings(dscTypes);
 				auto bindings = dscTypesToLayout(dscTypes);
 				_dsclayout = _device.createDescriptorSetLayout(
 				                                       { vk::DescriptorSetLayoutCreateFlags()
@@ -276,6 +372,95 @@ namespace vuh {
 				        {vk::PipelineLayoutCreateFlags(), 1, &_dsclayout, uint32_t(N), psrange.data()});
 			}
 
+			/// Check that the size of push constants structure is enough to hold the push constant
+			/// block declared in the shader.
+			/// @throws vuh::ShaderInterfaceMismatch
+			auto check_push_constants(std::size_t size_bytes) const-> void {
+				if(_interface.valid && _interface.push_constant_size > size_bytes){
+					throw ShaderInterfaceMismatch("shader push constants block is "
+					      + std::to_string(_interface.push_constant_size) + " bytes, while only "
+					      + std::to_string(size_bytes) + " bytes are passed by the Program");
+				}
+			}
+
+			/// Check that sizes of specialization constants match those declared in the shader.
+			/// Constants are numbered through starting from 0 in order of their appearance in
+			/// the specialization constants typelist.
+			/// @throws vuh::ShaderInterfaceMismatch
+			template<size_t N>
+			auto check_specs(const std::array<vk::SpecializationMapEntry, N>& entries) const-> void {
+				if(!_interface.valid){
+					return;
+				}
+				for(const auto& e: entries){
+					const auto spec = _interface.spec_constant(e.constantID);
+					if(spec && spec->size != e.size){
+						throw ShaderInterfaceMismatch("specialization constant "
+						      + std::to_string(e.constantID) + " is " + std::to_string(spec->size)
+						      + " bytes in shader, while Program passes " + std::to_string(e.size));
+					}
+				}
+			}
+
+			/// Check array parameters passed to the Program against the bindings declared in the shader.
+			/// All shader bindings should be covered by array parameters of matching descriptor types.
+			/// @throws vuh::ShaderInterfaceMismatch
+			template<size_t N>
+			auto check_bindings(const std::array<vk::DescriptorType, N>& dsc_types) const-> void {
+				if(!_interface.valid){
+					return;
+				}
+				for(const auto& b: _interface.bindings){
+					if(b.set != 0){
+						throw ShaderInterfaceMismatch("shader uses descriptor set "
+						      + std::to_string(b.set) + ", only set 0 is supported");
+					}
+					if(b.binding >= N){
+						throw ShaderInterfaceMismatch("shader binding " + std::to_string(b.binding)
+						      + " is not covered by " + std::to_string(N) + " array parameters");
+					}
+					if(b.type != dsc_types[b.binding]){
+						throw ShaderInterfaceMismatch("shader binding " + std::to_string(b.binding)
+						      + " expects " + vk::to_string(b.type) + ", "
+						      + vk::to_string(dsc_types[b.binding]) + " passed");
+					}
+				}
+			}
+
+			/// Check the bound buffer ranges against the device limits.
+			/// @throws vuh::BufferRangeExceeded
+			/// @throws vuh::BufferOffsetMisaligned
+			template<size_t N>
+			auto check_ranges(const std::array<vk::DescriptorType, N>& dsc_types
+			                  , const std::array<vk::DescriptorBufferInfo, N>& infos
+			                  ) const-> void
+			{
+				const auto& limits = _device.limits();
+				for(size_t i = 0; i < N; ++i){
+					auto limit = vk::DeviceSize(0);
+					auto alignment = vk::DeviceSize(1);
+					if(dsc_types[i] == vk::DescriptorType::eStorageBuffer){
+						limit = limits.maxStorageBufferRange;
+						alignment = limits.minStorageBufferOffsetAlignment;
+					} else if(dsc_types[i] == vk::DescriptorType::eUniformBuffer){
+						limit = limits.maxUniformBufferRange;
+						alignment = limits.minUniformBufferOffsetAlignment;
+					} else {
+						continue;
+					}
+					if(alignment > 1 && infos[i].offset % alignment != 0){
+						throw BufferOffsetMisaligned("array parameter " + std::to_string(i) + " is bound at offset "
+						      + std::to_string(infos[i].offset) + " bytes, device requires multiples of "
+						      + std::to_string(alignment));
+					}
+					if(infos[i].range > limit){
+						throw BufferRangeExceeded("array parameter " + std::to_string(i) + " binds "
+						      + std::to_string(infos[i].range) + " bytes, device limit is "
+						      + std::to_string(limit) + ", bind an array view instead");
+					}
+				}
+			}
+
 			/// Allocates descriptors sets
 			template<class... Arrs>
 			auto alloc_descriptor_sets(Arrs&...)-> void {
@@ -284,7 +469,14 @@ namespace vuh {
                                                                    , 2 * sizeof...(Arrs));
                 auto sbo_descriptors_size2 = vk::DescriptorPoolSize(vk::DescriptorType::eStorageTexelBuffer
                                                                    , 2 * sizeof...(Arrs));
-                auto descriptor_sizes = std::array<vk::DescriptorPoolSize, 2>({sbo_descriptors_size, sbo_descriptors_size2}); // can be done compile-time, but not worth it
+                auto ubo_descriptors_size = vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer
+                                                                   , 2 * sizeof...(Arrs));
+                auto img_descriptors_size = vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage
+                                                                   , 2 * sizeof...(Arrs));
+                auto smp_descriptors_size = vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler
+                                                                   , 2 * sizeof...(Arrs));
+                auto descriptor_sizes = std::array<vk::DescriptorPoolSize, 5>({sbo_descriptors_size, sbo_descriptors_size2, ubo_descriptors_size
+                                                                              , img_descriptors_size, smp_descriptors_size}); // can be done compile-time, but not worth it
 				_dscpool = _device.createDescriptorPool(
                                              {vk::DescriptorPoolCreateFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT),
                                               2 // 1 here is the max number of descriptor sets that can be allocated from the pool
@@ -306,6 +498,10 @@ namespace vuh {
 				auto cmdbuf = _device.computeCmdBuffer();
 				auto beginInfo = vk::CommandBufferBeginInfo();
 				cmdbuf.begin(beginInfo);
+				if(bool(_timer) != _device.profiling()){
+					_timer = TimestampQuery(_device);
+				}
+				_timer.begin(cmdbuf);
 
 				// Before dispatch bind a pipeline, AND a descriptor set.
 				cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, _pipeline);
@@ -317,10 +513,14 @@ namespace vuh {
 			auto command_buffer_end()-> void {
 				auto cmdbuf = _device.computeCmdBuffer();
 				cmdbuf.dispatch(_batch[0], _batch[1], _batch[2]); // start compute pipeline, execute the shader
+				_timer.end(cmdbuf);
 				cmdbuf.end(); // end recording commands
 			}
 
         public:
+			/// @return shader interface extracted from the SPIR-V code at construction
+			auto shader_interface() const-> const ShaderInterface& { return _interface; }
+
             vk::ShaderModule _shader;            ///< compute shader to execute
         protected: // data
 			vk::DescriptorSetLayout _dsclayout;  ///< descriptor set layout. This defines the kernel's array parameters interface.
@@ -332,6 +532,9 @@ namespace vuh {
 
 			vuh::Device& _device;                ///< refer to device to run shader on
 			std::array<uint32_t, 3> _batch={0, 0, 0}; ///< 3D evaluation grid dimensions (number of workgroups to run)
+			ShaderInterface _interface;          ///< shader interface reflected from SPIR-V, used to validate the Program interface
+			TimestampQuery _timer;               ///< timestamps bracketing the recorded dispatch, inactive if not profiling
+			std::shared_ptr<ProfileStats> _stats = std::make_shared<ProfileStats>(); ///< GPU time statistics
 
         public:
             const char* entryPoint = "main";
@@ -350,12 +553,16 @@ namespace vuh {
 			/// Construct object using given a vuh::Device and path to SPIR-V shader code.
 			SpecsBase(Device& device, const char* filepath, vk::ShaderModuleCreateFlags flags={})
 			   : ProgramBase(device, filepath, flags)
-			{}
+			{
+				check_specs(specs2mapentries(_specs));
+			}
 
 			/// Construct object using given a vuh::Device a SPIR-V shader code.
 			SpecsBase(Device& device, const uint32_t* code, size_t size, vk::ShaderModuleCreateFlags f={})
 			   : ProgramBase(device, code, size, f)
-			{}
+			{
+				check_specs(specs2mapentries(_specs));
+			}
 
 			/// Initialize the pipeline.
 			/// Specialization constants interface is defined here.
@@ -414,16 +621,22 @@ namespace vuh {
 		using Base = detail::SpecsBase<Specs<Specs_Ts...>>;
 	public:
 		/// Initialize program on a device using SPIR-V code at a given path
+		/// @throws vuh::ShaderInterfaceMismatch if Params do not cover shader push constants block
 		Program(vuh::Device& device, const char* filepath, vk::ShaderModuleCreateFlags flags={})
 		   : Base(device, filepath, flags)
-		{}
+		{
+			Base::check_push_constants(sizeof(Params));
+		}
 
 		/// Initialize program on a device from binary SPIR-V code
+		/// @throws vuh::ShaderInterfaceMismatch if Params do not cover shader push constants block
 		Program(vuh::Device& device, const uint32_t* code, size_t size
 		        , vk::ShaderModuleCreateFlags flags={}
 		        )
 		   : Base(device, code, size, flags)
-		{}
+		{
+			Base::check_push_constants(sizeof(Params));
+		}
 
 		using Base::run;
 		using Base::run_async;
@@ -448,6 +661,7 @@ namespace vuh {
 		/// should be specified before calling this.
 		template<class... Arrs>
 		auto bind(const Params& p, Arrs&&... args)-> const Program& {
+			VUH_TRACE_SCOPE("Program::bind", "compute");
 			if(!Base::_pipeline){ // handle multiple rebind
 				init_pipelayout(args...);
 				Base::alloc_descriptor_sets(args...);
@@ -508,16 +722,22 @@ namespace vuh {
 		using Base = detail::SpecsBase<Specs<Specs_Ts...>>;
 	public:
 		/// Initialize program on a device using SPIR-V code at a given path
+		/// @throws vuh::ShaderInterfaceMismatch if shader declares push constants
 		Program(vuh::Device& device, const char* filepath, vk::ShaderModuleCreateFlags flags={})
 		   : Base(device, filepath, flags)
-		{}
+		{
+			Base::check_push_constants(0);
+		}
 
 		/// Initialize program on a device from binary SPIR-V code
+		/// @throws vuh::ShaderInterfaceMismatch if shader declares push constants
 		Program(vuh::Device& device, const uint32_t* code, size_t size
 		        , vk::ShaderModuleCreateFlags flags={}
 		        )
 		   : Base (device, code, size, flags)
-		{}
+		{
+			Base::check_push_constants(0);
+		}
 
 		using Base::run;
 		using Base::run_async;
@@ -542,6 +762,7 @@ namespace vuh {
 		/// should be specified before calling this.
 		template<class... Arrs>
 		auto bind(Arrs&&... args)-> const Program& {
+			VUH_TRACE_SCOPE("Program::bind", "compute");
 			if(!Base::_pipeline){ // handle multiple rebind
 				Base::init_pipelayout(std::array<vk::PushConstantRange, 0>{}, args...);
 				Base::alloc_descriptor_sets(args...);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vuh {
+	/// Descriptor binding as declared in the shader code.
+	struct ShaderBinding {
+		uint32_t set;             ///< descriptor set id
+		uint32_t binding;         ///< binding id within the set
+		vk::DescriptorType type;  ///< descriptor type expected by the shader
+		uint32_t count;           ///< number of descriptors (>1 for arrays of descriptors, 0 for runtime arrays)
+	};
+
+	/// Specialization constant as declared in the shader code.
+	struct ShaderSpecConstant {
+		uint32_t id;   ///< constant_id of the specialization constant
+		uint32_t size; ///< size of the constant in bytes (bool constants are 4 bytes as VkBool32)
+	};
+
+	/// Workgroup size along one dimension.
+	/// Either a literal value or a specialization constant (with its default value).
+	struct ShaderLocalSize {
+		uint32_t value = 1;                ///< literal (or default) workgroup size
+		uint32_t spec_id = uint32_t(-1);   ///< id of specialization constant defining the value, -1 if literal
+	};
+
+	/// Interface of a compute shader extracted from its SPIR-V binary.
+	/// Only the features relevant to vuh::Program are captured.
+	struct ShaderInterface {
+		bool valid = false;                          ///< false if the code is not a SPIR-V module (then nothing else is meaningful)
+		std::vector<ShaderBinding> bindings;         ///< descriptor bindings sorted by (set, binding)
+		uint32_t push_constant_size = 0;             ///< size of push constant block (bytes), 0 if no push constants are declared
+		std::vector<ShaderSpecConstant> spec_constants; ///< specialization constants sorted by id
+		std::array<ShaderLocalSize, 3> local_size;   ///< workgroup dimensions
+
+		auto binding(uint32_t set, uint32_t binding) const-> const ShaderBinding*;
+		auto spec_constant(uint32_t id) const-> const ShaderSpecConstant*;
+	};
+
+	auto reflect_spirv(const uint32_t* code, std::size_t size_bytes)-> ShaderInterface;
+} // namespace vuh
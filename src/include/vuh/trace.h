@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+/// Instrumentation macros. Library code is only instrumented when built with VUH_ENABLE_TRACE
+/// (cmake option of the same name), otherwise these compile to nothing.
+#ifdef VUH_ENABLE_TRACE
+#	define VUH_TRACE_CONCAT_IMPL(a, b) a##b
+#	define VUH_TRACE_CONCAT(a, b) VUH_TRACE_CONCAT_IMPL(a, b)
+	/// Record the span covering the rest of the enclosing scope.
+#	define VUH_TRACE_SCOPE(name, category) \
+	   ::vuh::trace::Scope VUH_TRACE_CONCAT(vuh_trace_scope_, __LINE__)(name, category)
+	/// Record the GPU span of given duration (ns) finishing at the current moment.
+#	define VUH_TRACE_GPU(name, category, duration_ns, transfer) \
+	   ::vuh::trace::add_gpu_span(name, category, duration_ns, transfer)
+#else
+#	define VUH_TRACE_SCOPE(name, category) ((void)0)
+#	define VUH_TRACE_GPU(name, category, duration_ns, transfer) ((void)0)
+#endif
+
+namespace vuh {
+/// Recording of the library activity on a timeline, exported in Chrome trace format
+/// (viewable in chrome://tracing and Perfetto).
+/// Host spans are recorded per thread, GPU spans (measured with timestamp queries, see
+/// Device::enableProfiling()) go to separate compute and transfer tracks.
+/// Only names and categories passed as string literals are expected.
+namespace trace {
+	auto start()-> void;
+	auto stop()-> void;
+	auto enabled() noexcept-> bool;
+	auto clear()-> void;
+	auto write_json(const char* filename)-> void;
+
+	auto now_ns() noexcept-> int64_t;
+	auto add_span(const char* name, const char* category, int64_t begin_ns, int64_t end_ns) noexcept-> void;
+	auto add_gpu_span(const char* name, const char* category, double duration_ns, bool transfer) noexcept-> void;
+
+	/// Records the span from construction till destruction of the object,
+	/// if recording is on at construction.
+	class Scope {
+	public:
+		Scope(const char* name, const char* category) noexcept
+		   : _name(name), _category(category), _begin(enabled() ? now_ns() : -1)
+		{}
+
+		~Scope() noexcept {
+			if(_begin >= 0){
+				add_span(_name, _category, _begin, now_ns());
+			}
+		}
+
+		Scope(const Scope&) = delete;
+		auto operator=(const Scope&)-> Scope& = delete;
+	private: // data
+		const char* _name;     ///< span name
+		const char* _category; ///< span category
+		int64_t _begin;        ///< span start (ns), -1 if not recording
+	}; // class Scope
+} // namespace trace
+} // namespace vuh
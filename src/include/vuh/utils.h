@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <type_traits>
 #include <vector>
 
 namespace vuh {
@@ -8,7 +9,13 @@ namespace vuh {
 	template<class... Ts> struct typelist{};
 
 	/// @return nearest integer bigger or equal to exact division value
-	inline auto div_up(uint32_t x, uint32_t y){ return (x + y - 1u)/y; }
+	/// Works with any (incl. 64-bit) unsigned integer types, result has their common type.
+	template<class T, class U>
+	constexpr auto div_up(T x, U y)-> std::common_type_t<T, U> {
+		static_assert(std::is_integral<T>::value && std::is_integral<U>::value, "integer arguments expected");
+		using R = std::common_type_t<T, U>;
+		return (R(x) + R(y) - 1)/R(y);
+	}
 
 	auto read_spirv(const char* filename)-> std::vector<char>;
 
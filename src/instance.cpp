@@ -1,9 +1,19 @@
 #include "vuh/instance.h"
+#include "vuh/cache.h"
 #include "vuh/device.h"
+#include "vuh/error.h"
+#include "vuh/arr/allocDevice.hpp"
+#include "vuh/arr/arrayUtils.h"
+#include "vuh/arr/deviceArray.hpp"
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <tuple>
 
 using std::begin; using std::end;
 #define ALL(c) begin(c), end(c)
@@ -146,6 +156,7 @@ namespace vuh {
 	   : _instance(createInstance(filter_layers(layers), filter_extensions(extension), info))
 	   , _reporter(report_callback ? report_callback : debugReporter)
 	   , _reporter_cbk(registerReporter(_instance, _reporter))
+	   , _api_version(info.apiVersion ? info.apiVersion : VK_API_VERSION_1_0)
     {
 #if VULKAN_HPP_DISPATCH_LOADER_DYNAMIC == 1
         vk::defaultDispatchLoaderDynamic.init(_instance);
@@ -162,6 +173,7 @@ namespace vuh {
 	   : _instance(o._instance)
 	   , _reporter(o._reporter)
 	   , _reporter_cbk(o._reporter_cbk)
+	   , _api_version(o._api_version)
 	{
 		o._instance = nullptr;
 	}
@@ -172,6 +184,7 @@ namespace vuh {
 		swap(_instance, o._instance);
 		swap(_reporter, o._reporter);
 		swap(_reporter_cbk, o._reporter_cbk);
+		swap(_api_version, o._api_version);
 		return *this;
 	}
 
@@ -201,6 +214,154 @@ namespace vuh {
 		return r;
 	}
 
+	namespace {
+		/// @return rank of the device type, higher is preferred
+		auto typeRank(vk::PhysicalDeviceType type)-> int {
+			switch(type){
+			case vk::PhysicalDeviceType::eDiscreteGpu:   return 4;
+			case vk::PhysicalDeviceType::eIntegratedGpu: return 3;
+			case vk::PhysicalDeviceType::eVirtualGpu:    return 2;
+			case vk::PhysicalDeviceType::eCpu:           return 1;
+			default:                                     return 0;
+			}
+		}
+
+		/// @return size of the largest device-local heap
+		auto deviceLocalBytes(vk::PhysicalDevice pd)-> vk::DeviceSize {
+			const auto mem = pd.getMemoryProperties();
+			auto r = vk::DeviceSize(0);
+			for(uint32_t i = 0; i < mem.memoryHeapCount; ++i){
+				if(mem.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal){
+					r = std::max(r, mem.memoryHeaps[i].size);
+				}
+			}
+			return r;
+		}
+
+		/// @return total number of queues supporting compute
+		auto computeQueueCount(vk::PhysicalDevice pd)-> uint32_t {
+			auto r = 0u;
+			for(const auto& f: pd.getQueueFamilyProperties()){
+				if(f.queueFlags & vk::QueueFlagBits::eCompute){
+					r += f.queueCount;
+				}
+			}
+			return r;
+		}
+
+		/// @return subgroup size, 0 if it can not be queried (Vulkan 1.0).
+		/// Needs Vulkan 1.1 on the loader, device and instance (application info) sides.
+		auto subgroupSize(const vuh::Instance& instance, vk::PhysicalDevice pd)-> uint32_t {
+			const auto version = std::min(instance.apiVersion(), pd.getProperties().apiVersion);
+			if(version < VK_API_VERSION_1_1 || Instance::getInstanceVersion() < VK_API_VERSION_1_1){
+				return 0;
+			}
+			auto subgroup = vk::PhysicalDeviceSubgroupProperties{};
+			auto props = vk::PhysicalDeviceProperties2{};
+			props.pNext = &subgroup;
+			pd.getProperties2(&props);
+			return subgroup.subgroupSize;
+		}
+
+		/// @return true if the device supports all extensions
+		auto hasExtensions(vk::PhysicalDevice pd, const std::vector<std::string>& names)-> bool {
+			const auto available = pd.enumerateDeviceExtensionProperties();
+			return std::all_of(ALL(names), [&](const std::string& n){
+				return contains(n.c_str(), available, [](const auto& e){ return e.extensionName; });
+			});
+		}
+
+		/// Measure the device memory bandwidth (GB/s) by timing copies between device-local buffers.
+		/// @return 0 if the measurement failed (e.g. not enough memory)
+		auto probeBandwidth(vuh::Instance& instance, vk::PhysicalDevice pd)-> double {
+			constexpr auto n_bytes = size_t(32) << 20;
+			constexpr auto n_reps = 4;
+			try{
+				auto device = vuh::Device(instance, pd);
+				using Array = arr::DeviceArray<char, arr::AllocDevice<arr::properties::Device>>;
+				auto src = Array(device, n_bytes);
+				auto dst = Array(device, n_bytes);
+				arr::copyBuf(device, src, dst, n_bytes); // warm up
+				const auto start = std::chrono::steady_clock::now();
+				for(int i = 0; i < n_reps; ++i){
+					arr::copyBuf(device, src, dst, n_bytes);
+				}
+				const auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				return dt > 0. ? 2.*n_bytes*n_reps/dt*1e-9 : 0.; // each copy reads and writes
+			} catch(std::exception&){
+				return 0.;
+			}
+		}
+
+		/// @return bandwidth (GB/s) stored in the probe cache, 0 if the value is not usable
+		auto parseBandwidth(const std::string& value)-> double {
+			try {
+				const auto r = std::stod(value);
+				return std::isfinite(r) && r > 0. ? r : 0.;
+			} catch(std::exception&){
+				return 0.;
+			}
+		}
+	} // namespace
+
+	/// @return devices satisfying the criteria, best first.
+	/// Devices are ordered by the measured copy bandwidth (if criteria.probe is set), then by
+	/// type (discrete, integrated, virtual, cpu), size of device-local heap, number of compute
+	/// queues and subgroup size.
+	/// Probe results are cached in a file (see DiskCache::defaultDir()), so that the
+	/// measurement only runs once per device and driver version. Failed probes are not cached
+	/// and unreadable cache entries are probed again.
+	auto Instance::rankDevices(const DeviceCriteria& criteria)-> std::vector<vk::PhysicalDevice> {
+		using Score = std::tuple<double, int, vk::DeviceSize, uint32_t, uint32_t>;
+		auto cache = std::unique_ptr<DiskCache>{};
+		if(criteria.probe){
+			cache = std::make_unique<DiskCache>(criteria.probe_cache.empty()
+			                                    ? DiskCache::defaultDir() + "/vuh_device_probe.txt"
+			                                    : criteria.probe_cache);
+		}
+		auto scored = std::vector<std::pair<Score, vk::PhysicalDevice>>{};
+		for(auto pd: devices()){
+			const auto props = pd.getProperties();
+			const auto heap = deviceLocalBytes(pd);
+			const auto subgroup = subgroupSize(*this, pd);
+			if(!criteria.allow_cpu && props.deviceType == vk::PhysicalDeviceType::eCpu){ continue; }
+			if(heap < criteria.min_device_local_bytes){ continue; }
+			if(criteria.min_subgroup_size > 0 && subgroup < criteria.min_subgroup_size){ continue; }
+			if(computeQueueCount(pd) == 0 || !hasExtensions(pd, criteria.extensions)){ continue; }
+			auto bandwidth = 0.;
+			if(cache){
+				const auto key = "bandwidth:" + DiskCache::deviceKey(pd);
+				if(const auto v = cache->get(key)){
+					bandwidth = parseBandwidth(*v);
+				}
+				if(bandwidth <= 0.){ // not cached or garbled, failed probes are not stored
+					bandwidth = probeBandwidth(*this, pd);
+					if(bandwidth > 0.){
+						cache->set(key, std::to_string(bandwidth));
+					}
+				}
+			}
+			scored.emplace_back(Score{bandwidth, typeRank(props.deviceType), heap
+			                          , computeQueueCount(pd), subgroup}, pd);
+		}
+		std::stable_sort(ALL(scored), [](const auto& a, const auto& b){ return a.first > b.first; });
+		auto r = std::vector<vk::PhysicalDevice>{};
+		for(const auto& s: scored){
+			r.push_back(s.second);
+		}
+		return r;
+	}
+
+	/// @return best device satisfying the criteria, see rankDevices().
+	/// @throws vuh::NoSuitableDeviceFound
+	auto Instance::bestDevice(const DeviceCriteria& criteria)-> vk::PhysicalDevice {
+		const auto ranked = rankDevices(criteria);
+		if(ranked.empty()){
+			throw NoSuitableDeviceFound("no device satisfies the requested criteria");
+		}
+		return ranked.front();
+	}
+
 	/// Log message using the reporter callback registered with the Vulkan instance.
 	/// Default callback sends all messages to std::cerr
 	auto Instance::report(const char* prefix    ///< prefix part of message. may contain component name, etc.
@@ -0,0 +1,157 @@
+#include <vuh/arr/copy_async.hpp>
+#include <vuh/arr/allocDevice.hpp>
+#include <vuh/arr/hostArray.hpp>
+#include <vuh/arr/hostCopy.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+	/// Size of a single bounce buffer of the peer transfer ring.
+	constexpr auto chunk_bytes = size_t(16) << 20;
+	/// Number of bounce buffer pairs in the ring.
+	constexpr auto n_slots = size_t(3);
+
+	/// Wait for the fence and destroy it.
+	auto waitFence(vuh::Device& device, vk::Fence& fence) noexcept-> void {
+		if(fence){
+			(void)device.waitForFences({fence}, true, uint64_t(-1));
+			device.destroyFence(fence);
+			fence = nullptr;
+		}
+	}
+
+	/// Record and submit the copy between buffers to the transfer queue of the device.
+	/// @return fence signalled on completion
+	auto submitCopy(vuh::Device& device, vk::CommandBuffer cmd_buf
+	                , vk::Buffer src, size_t src_offset, vk::Buffer dst, size_t dst_offset
+	                , size_t size_bytes)-> vk::Fence
+	{
+		cmd_buf.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+		auto region = vk::BufferCopy(src_offset, dst_offset, size_bytes);
+		cmd_buf.copyBuffer(src, dst, 1, &region);
+		cmd_buf.end();
+		auto fence = device.createFence(vk::FenceCreateInfo());
+		auto submit_info = vk::SubmitInfo(0, nullptr, nullptr, 1, &cmd_buf);
+		device.transferQueue().submit({submit_info}, fence);
+		return fence;
+	}
+} // namespace
+
+namespace vuh {
+namespace detail {
+	/// Bounce buffer ring. Slot i holds a host-visible buffer on each device, the command buffers
+	/// recording the transfers to/from those and the fences signalled when transfers complete.
+	struct PeerStage::Impl {
+		using StageSrc = arr::HostArray<char, arr::AllocDevice<arr::properties::HostCached>>;
+		using StageDst = arr::HostArray<char, arr::AllocDevice<arr::properties::HostCoherent>>;
+
+		struct Slot {
+			StageSrc down;            ///< receives the chunk from the source device
+			StageDst up;              ///< sends the chunk to the destination device
+			vk::CommandBuffer cmd_down;
+			vk::CommandBuffer cmd_up;
+			vk::Fence fence_down;     ///< null if not submitted
+			vk::Fence fence_up;       ///< null if not submitted or handed over
+		};
+
+		vuh::Device& src;
+		vuh::Device& dst;
+		std::vector<Slot> slots;
+
+		Impl(vuh::Device& src, vuh::Device& dst): src(src), dst(dst) {}
+
+		~Impl() noexcept { release(); }
+
+		/// Allocate the ring of n slots of given size.
+		auto allocate(size_t n, size_t slot_bytes)-> void {
+			release();
+			const auto cmd_down = src.allocateCommandBuffers({src.transferCmdPool()
+			                                                 , vk::CommandBufferLevel::ePrimary, uint32_t(n)});
+			const auto cmd_up = dst.allocateCommandBuffers({dst.transferCmdPool()
+			                                               , vk::CommandBufferLevel::ePrimary, uint32_t(n)});
+			slots.reserve(n);
+			try{
+				for(size_t i = 0; i < n; ++i){
+					slots.push_back({StageSrc(src, slot_bytes), StageDst(dst, slot_bytes)
+					                 , cmd_down[i], cmd_up[i], nullptr, nullptr});
+				}
+			} catch(std::exception&){
+				slots.clear();
+				src.freeCommandBuffers(src.transferCmdPool(), cmd_down);
+				dst.freeCommandBuffers(dst.transferCmdPool(), cmd_up);
+				throw;
+			}
+		}
+
+		/// Wait for all transfers and release the ring.
+		auto release() noexcept-> void {
+			for(auto& s: slots){
+				waitFence(src, s.fence_down);
+				waitFence(dst, s.fence_up);
+				src.freeCommandBuffers(src.transferCmdPool(), 1, &s.cmd_down);
+				dst.freeCommandBuffers(dst.transferCmdPool(), 1, &s.cmd_up);
+			}
+			slots.clear();
+		}
+	}; // struct PeerStage::Impl
+
+	/// Constructor. Bounce buffers are allocated on the first transfer.
+	PeerStage::PeerStage(vuh::Device& src, vuh::Device& dst)
+	   : _impl(std::make_unique<Impl>(src, dst))
+	{}
+
+	PeerStage::PeerStage(PeerStage&&) noexcept = default;
+	auto PeerStage::operator=(PeerStage&&) noexcept-> PeerStage& = default;
+
+	/// Destructor. Waits for the outstanding transfers and releases the bounce buffers.
+	PeerStage::~PeerStage() noexcept = default;
+
+	/// Copy the range between buffers on the source and destination devices.
+	/// Each chunk is copied to the host-visible buffer of the source device, then on host to
+	/// the host-visible buffer of the destination device and from there to the destination.
+	/// Downloads of the next chunks, host copy and upload of the current chunk overlap.
+	/// Blocks till all chunks are copied on the host side.
+	/// @return fence of the destination device signalled when all uploads complete.
+	/// Ownership passes to the caller.
+	auto PeerStage::copy(vk::Buffer src, size_t src_offset, vk::Buffer dst, size_t dst_offset
+	                     , size_t size_bytes)-> vk::Fence
+	{
+		auto& impl = *_impl;
+		if(size_bytes == 0){
+			return impl.dst.createFence({vk::FenceCreateFlagBits::eSignaled});
+		}
+		const auto chunk = std::min(size_bytes, chunk_bytes);
+		const auto n_chunks = (size_bytes + chunk - 1)/chunk;
+		impl.allocate(std::min(n_slots, n_chunks), chunk);
+		auto& slots = impl.slots;
+		auto chunk_size = [&](size_t i){ return std::min(chunk, size_bytes - i*chunk); };
+		for(size_t i = 0; i < slots.size(); ++i){ // fill the pipeline
+			slots[i].fence_down = submitCopy(impl.src, slots[i].cmd_down, src, src_offset + i*chunk
+			                                 , slots[i].down, 0, chunk_size(i));
+		}
+		auto last = size_t(0);
+		for(size_t i = 0; i < n_chunks; ++i){
+			VUH_TRACE_SCOPE("peer chunk", "transfer");
+			auto& s = slots[i % slots.size()];
+			const auto m = chunk_size(i);
+			waitFence(impl.src, s.fence_down);
+			waitFence(impl.dst, s.fence_up);
+			s.down.invalidate_mapped_cache(0, m);
+			arr::host_copy(s.up.data(), s.down.data(), m);
+			s.up.flush_mapped_writes(0, m);
+			s.fence_up = submitCopy(impl.dst, s.cmd_up, s.up, 0, dst, dst_offset + i*chunk, m);
+			last = i % slots.size();
+			const auto next = i + slots.size();
+			if(next < n_chunks){
+				s.fence_down = submitCopy(impl.src, s.cmd_down, src, src_offset + next*chunk
+				                          , s.down, 0, chunk_size(next));
+			}
+		}
+		// fence of the last upload also covers all previous ones on the same queue
+		auto fence = slots[last].fence_up;
+		slots[last].fence_up = nullptr;
+		return fence;
+	}
+} // namespace detail
+} // namespace vuh
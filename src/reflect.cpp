@@ -0,0 +1,352 @@
+#include "vuh/reflect.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+	// SPIR-V enumerants used by reflection (see SPIR-V specification, section 3).
+	constexpr uint32_t SpirvMagic = 0x07230203;
+
+	constexpr uint32_t OpEntryPoint               = 15;
+	constexpr uint32_t OpExecutionMode            = 16;
+	constexpr uint32_t OpTypeBool                 = 20;
+	constexpr uint32_t OpTypeInt                  = 21;
+	constexpr uint32_t OpTypeFloat                = 22;
+	constexpr uint32_t OpTypeVector               = 23;
+	constexpr uint32_t OpTypeMatrix               = 24;
+	constexpr uint32_t OpTypeImage                = 25;
+	constexpr uint32_t OpTypeSampler              = 26;
+	constexpr uint32_t OpTypeSampledImage         = 27;
+	constexpr uint32_t OpTypeArray                = 28;
+	constexpr uint32_t OpTypeRuntimeArray         = 29;
+	constexpr uint32_t OpTypeStruct               = 30;
+	constexpr uint32_t OpTypePointer              = 32;
+	constexpr uint32_t OpConstant                 = 43;
+	constexpr uint32_t OpConstantComposite        = 44;
+	constexpr uint32_t OpSpecConstantTrue         = 48;
+	constexpr uint32_t OpSpecConstantFalse        = 49;
+	constexpr uint32_t OpSpecConstant             = 50;
+	constexpr uint32_t OpSpecConstantComposite    = 51;
+	constexpr uint32_t OpVariable                 = 59;
+	constexpr uint32_t OpDecorate                 = 71;
+	constexpr uint32_t OpMemberDecorate           = 72;
+	constexpr uint32_t OpExecutionModeId          = 331;
+
+	constexpr uint32_t DecorationSpecId           = 1;
+	constexpr uint32_t DecorationBufferBlock      = 3;
+	constexpr uint32_t DecorationArrayStride      = 6;
+	constexpr uint32_t DecorationMatrixStride     = 7;
+	constexpr uint32_t DecorationBuiltIn          = 11;
+	constexpr uint32_t DecorationBinding          = 33;
+	constexpr uint32_t DecorationDescriptorSet    = 34;
+	constexpr uint32_t DecorationOffset           = 35;
+
+	constexpr uint32_t StorageClassUniformConstant = 0;
+	constexpr uint32_t StorageClassUniform         = 2;
+	constexpr uint32_t StorageClassPushConstant    = 9;
+	constexpr uint32_t StorageClassStorageBuffer   = 12;
+
+	constexpr uint32_t ExecutionModelGLCompute    = 5;
+	constexpr uint32_t ExecutionModeLocalSize     = 17;
+	constexpr uint32_t ExecutionModeLocalSizeId   = 38;
+	constexpr uint32_t BuiltInWorkgroupSize       = 25;
+	constexpr uint32_t DimBuffer                  = 5;
+
+	constexpr auto none = uint32_t(-1);
+
+	/// Everything reflection needs to know about a single SPIR-V result id.
+	struct IdInfo {
+		uint32_t opcode = 0;              ///< opcode of the instruction defining the id
+		uint32_t type = none;             ///< result type id (for constants and variables)
+		std::vector<uint32_t> operands;   ///< operands following the result id
+		uint32_t set = none;              ///< DescriptorSet decoration
+		uint32_t binding = none;          ///< Binding decoration
+		uint32_t spec_id = none;          ///< SpecId decoration
+		uint32_t builtin = none;          ///< BuiltIn decoration
+		uint32_t array_stride = 0;        ///< ArrayStride decoration
+		bool buffer_block = false;        ///< BufferBlock decoration
+		std::vector<uint32_t> member_offsets;        ///< Offset decorations of struct members
+		std::vector<uint32_t> member_matrix_strides; ///< MatrixStride decorations of struct members
+	};
+
+	/// Grow the vector (if needed) to accommodate the element at given index and set its value.
+	auto set_at(std::vector<uint32_t>& v, uint32_t i, uint32_t value)-> void {
+		if(v.size() <= i){
+			v.resize(i + 1, 0u);
+		}
+		v[i] = value;
+	}
+
+	/// @return size in bytes of the type with given id, as laid out in a block with explicit layout.
+	/// Runtime arrays have zero size.
+	auto type_size(const std::vector<IdInfo>& ids, uint32_t type_id, uint32_t depth=0)-> uint32_t {
+		if(type_id >= ids.size() || depth > 64){
+			return 0;
+		}
+		const auto& t = ids[type_id];
+		switch(t.opcode){
+		case OpTypeBool: return 4u;
+		case OpTypeInt:
+		case OpTypeFloat: return t.operands.at(0)/8u;
+		case OpTypeVector: return t.operands.at(1)*type_size(ids, t.operands.at(0), depth + 1);
+		case OpTypeMatrix: return t.operands.at(1)*type_size(ids, t.operands.at(0), depth + 1);
+		case OpTypeArray: {
+			const auto len_id = t.operands.at(1);
+			const auto len = len_id < ids.size() && !ids[len_id].operands.empty()
+			                 ? ids[len_id].operands[0] : 0u;
+			const auto stride = t.array_stride ? t.array_stride
+			                                   : type_size(ids, t.operands.at(0), depth + 1);
+			return len*stride;
+		}
+		case OpTypeStruct: {
+			auto r = uint32_t(0);
+			for(uint32_t m = 0; m < t.operands.size(); ++m){
+				const auto offset = m < t.member_offsets.size() ? t.member_offsets[m] : r;
+				const auto& mt = ids[std::min<size_t>(t.operands[m], ids.size() - 1)];
+				auto size = type_size(ids, t.operands[m], depth + 1);
+				if(mt.opcode == OpTypeMatrix && m < t.member_matrix_strides.size()
+				   && t.member_matrix_strides[m] != 0)
+				{
+					size = mt.operands.at(1)*t.member_matrix_strides[m];
+				}
+				r = std::max(r, offset + size);
+			}
+			return r;
+		}
+		default: return 0u;
+		}
+	}
+
+	/// @return descriptor type corresponding to a variable of given storage class and type.
+	/// Returns false if variable of such type is not bound through a descriptor.
+	auto descriptor_type(const std::vector<IdInfo>& ids, uint32_t storage, uint32_t type_id
+	                     , vk::DescriptorType& dsc_type)-> bool
+	{
+		const auto& t = ids.at(type_id);
+		switch(storage){
+		case StorageClassStorageBuffer:
+			dsc_type = vk::DescriptorType::eStorageBuffer;
+			return true;
+		case StorageClassUniform:
+			dsc_type = t.buffer_block ? vk::DescriptorType::eStorageBuffer
+			                          : vk::DescriptorType::eUniformBuffer;
+			return true;
+		case StorageClassUniformConstant:
+			switch(t.opcode){
+			case OpTypeImage: {
+				const auto storage_image = t.operands.at(5) == 2u;
+				if(t.operands.at(1) == DimBuffer){
+					dsc_type = storage_image ? vk::DescriptorType::eStorageTexelBuffer
+					                         : vk::DescriptorType::eUniformTexelBuffer;
+				} else {
+					dsc_type = storage_image ? vk::DescriptorType::eStorageImage
+					                         : vk::DescriptorType::eSampledImage;
+				}
+				return true;
+			}
+			case OpTypeSampledImage:
+				dsc_type = vk::DescriptorType::eCombinedImageSampler;
+				return true;
+			case OpTypeSampler:
+				dsc_type = vk::DescriptorType::eSampler;
+				return true;
+			default: return false;
+			}
+		default: return false;
+		}
+	}
+
+	/// Resolve the (possibly specialized) constant id to workgroup dimension.
+	auto local_size(const std::vector<IdInfo>& ids, uint32_t id)-> vuh::ShaderLocalSize {
+		auto r = vuh::ShaderLocalSize{};
+		if(id < ids.size() && !ids[id].operands.empty()){
+			r.value = ids[id].operands[0];
+			if(ids[id].opcode == OpSpecConstant){
+				r.spec_id = ids[id].spec_id;
+			}
+		}
+		return r;
+	}
+} // namespace
+
+namespace vuh {
+	/// @return pointer to binding with given set and binding ids, nullptr if shader does not declare such.
+	auto ShaderInterface::binding(uint32_t set, uint32_t binding) const-> const ShaderBinding* {
+		auto it = std::find_if(begin(bindings), end(bindings), [=](const ShaderBinding& b){
+			return b.set == set && b.binding == binding;
+		});
+		return it != end(bindings) ? &*it : nullptr;
+	}
+
+	/// @return pointer to specialization constant with given id, nullptr if shader does not declare such.
+	auto ShaderInterface::spec_constant(uint32_t id) const-> const ShaderSpecConstant* {
+		auto it = std::find_if(begin(spec_constants), end(spec_constants)
+		                       , [=](const ShaderSpecConstant& s){ return s.id == id; });
+		return it != end(spec_constants) ? &*it : nullptr;
+	}
+
+	/// Extract the compute shader interface (descriptor bindings, push constant block size,
+	/// specialization constants and workgroup size) from the SPIR-V binary.
+	/// This is a single linear pass over the module, meant to be done once per shader.
+	/// If the code is not a valid SPIR-V module the returned interface has valid flag set to false.
+	auto reflect_spirv(const uint32_t* code  ///< SPIR-V code
+	                   , std::size_t size_bytes ///< size of the code in bytes
+	                   )-> ShaderInterface
+	{
+		auto r = ShaderInterface{};
+		const auto n_words = size_bytes/sizeof(uint32_t);
+		if(code == nullptr || n_words < 5 || code[0] != SpirvMagic){
+			return r;
+		}
+		const auto bound = code[3];
+		auto ids = std::vector<IdInfo>(bound);
+		auto entry = none;
+		auto mode_size = std::array<uint32_t, 3>{none, none, none};
+		auto mode_size_ids = std::array<uint32_t, 3>{none, none, none};
+
+		for(size_t i = 5; i < n_words;){
+			const auto word_count = code[i] >> 16;
+			const auto opcode = code[i] & 0xffffu;
+			if(word_count == 0 || i + word_count > n_words){
+				return r; // malformed module
+			}
+			const auto* args = code + i + 1;
+			const auto n_args = word_count - 1;
+			auto id = [&](uint32_t k)-> IdInfo* {
+				return k < n_args && args[k] < bound ? &ids[args[k]] : nullptr;
+			};
+
+			switch(opcode){
+			case OpEntryPoint:
+				if(n_args >= 2 && args[0] == ExecutionModelGLCompute && entry == none){
+					entry = args[1];
+				}
+				break;
+			case OpExecutionMode:
+			case OpExecutionModeId:
+				if(n_args >= 5 && args[0] == entry){
+					if(opcode == OpExecutionMode && args[1] == ExecutionModeLocalSize){
+						mode_size = {args[2], args[3], args[4]};
+					} else if(opcode == OpExecutionModeId && args[1] == ExecutionModeLocalSizeId){
+						mode_size_ids = {args[2], args[3], args[4]};
+					}
+				}
+				break;
+			case OpDecorate:
+				if(auto t = id(0)){
+					const auto value = n_args > 2 ? args[2] : 0u;
+					switch(n_args > 1 ? args[1] : none){
+					case DecorationSpecId:        t->spec_id = value; break;
+					case DecorationBufferBlock:   t->buffer_block = true; break;
+					case DecorationArrayStride:   t->array_stride = value; break;
+					case DecorationBuiltIn:       t->builtin = value; break;
+					case DecorationBinding:       t->binding = value; break;
+					case DecorationDescriptorSet: t->set = value; break;
+					default: break;
+					}
+				}
+				break;
+			case OpMemberDecorate:
+				if(auto t = id(0)){
+					if(n_args > 3 && args[2] == DecorationOffset){
+						set_at(t->member_offsets, args[1], args[3]);
+					} else if(n_args > 3 && args[2] == DecorationMatrixStride){
+						set_at(t->member_matrix_strides, args[1], args[3]);
+					}
+				}
+				break;
+			case OpTypeBool: case OpTypeInt: case OpTypeFloat: case OpTypeVector:
+			case OpTypeMatrix: case OpTypeImage: case OpTypeSampler: case OpTypeSampledImage:
+			case OpTypeArray: case OpTypeRuntimeArray: case OpTypeStruct: case OpTypePointer:
+				if(auto t = id(0)){
+					t->opcode = opcode;
+					t->operands.assign(args + 1, args + n_args);
+				}
+				break;
+			case OpConstant: case OpConstantComposite: case OpSpecConstantTrue:
+			case OpSpecConstantFalse: case OpSpecConstant: case OpSpecConstantComposite:
+			case OpVariable:
+				if(auto t = id(1)){
+					t->opcode = opcode;
+					t->type = args[0];
+					t->operands.assign(args + 2, args + n_args);
+				}
+				break;
+			default: break;
+			}
+			i += word_count;
+		}
+
+		for(uint32_t k = 0; k < bound; ++k){
+			const auto& v = ids[k];
+			switch(v.opcode){
+			case OpVariable: {
+				if(v.type >= bound || ids[v.type].opcode != OpTypePointer || v.operands.empty()){
+					break;
+				}
+				const auto storage = v.operands[0];
+				auto type_id = ids[v.type].operands.at(1);
+				if(storage == StorageClassPushConstant){
+					r.push_constant_size = std::max(r.push_constant_size, type_size(ids, type_id));
+					break;
+				}
+				auto count = uint32_t(1);
+				while(type_id < bound && (ids[type_id].opcode == OpTypeArray
+				                          || ids[type_id].opcode == OpTypeRuntimeArray))
+				{
+					const auto& arr = ids[type_id];
+					if(arr.opcode == OpTypeArray){
+						const auto len_id = arr.operands.at(1);
+						count *= len_id < bound && !ids[len_id].operands.empty()
+						         ? ids[len_id].operands[0] : 1u;
+					} else {
+						count = 0;
+					}
+					type_id = arr.operands.at(0);
+				}
+				auto dsc_type = vk::DescriptorType{};
+				if(type_id < bound && descriptor_type(ids, storage, type_id, dsc_type)){
+					r.bindings.push_back({v.set == none ? 0u : v.set
+					                     , v.binding == none ? 0u : v.binding
+					                     , dsc_type, count});
+				}
+				break;
+			}
+			case OpSpecConstantTrue:
+			case OpSpecConstantFalse:
+			case OpSpecConstant:
+				if(v.spec_id != none){
+					r.spec_constants.push_back({v.spec_id, v.opcode == OpSpecConstant
+					                                       ? type_size(ids, v.type) : 4u});
+				}
+				break;
+			default: break;
+			}
+		}
+
+		for(size_t d = 0; d < 3; ++d){
+			if(mode_size[d] != none){
+				r.local_size[d].value = mode_size[d];
+			} else if(mode_size_ids[d] != none){
+				r.local_size[d] = local_size(ids, mode_size_ids[d]);
+			}
+		}
+		for(const auto& v: ids){ // WorkgroupSize built-in takes precedence over execution modes
+			if(v.builtin == BuiltInWorkgroupSize && v.operands.size() >= 3
+			   && (v.opcode == OpConstantComposite || v.opcode == OpSpecConstantComposite))
+			{
+				for(size_t d = 0; d < 3; ++d){
+					r.local_size[d] = local_size(ids, v.operands[d]);
+				}
+			}
+		}
+
+		std::sort(begin(r.bindings), end(r.bindings), [](const auto& b1, const auto& b2){
+			return std::make_pair(b1.set, b1.binding) < std::make_pair(b2.set, b2.binding);
+		});
+		std::sort(begin(r.spec_constants), end(r.spec_constants)
+		          , [](const auto& s1, const auto& s2){ return s1.id < s2.id; });
+		r.valid = true;
+		return r;
+	}
+} // namespace vuh
@@ -0,0 +1,146 @@
+#include <vuh/trace.h>
+#include <vuh/error.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	/// Recorded span
+	struct Event {
+		const char* name;
+		const char* category;
+		int64_t begin_ns;
+		int64_t end_ns;
+		uint32_t pid;      ///< 0 for host, 1 for GPU
+		uint32_t tid;      ///< host thread number or GPU track (0 - compute, 1 - transfer)
+	};
+
+	/// Trace recorder state
+	struct Recorder {
+		std::atomic<bool> recording{false};
+		std::mutex mutex;
+		std::vector<Event> events;
+		std::map<std::thread::id, uint32_t> threads; ///< maps host threads to small numbers
+
+		/// @return small number of the current thread. Should be called under the lock.
+		auto thread_number()-> uint32_t {
+			return threads.emplace(std::this_thread::get_id(), uint32_t(threads.size())).first->second;
+		}
+	};
+
+	auto recorder()-> Recorder& {
+		static Recorder r;
+		return r;
+	}
+
+	/// Append the string to JSON output escaping the special characters.
+	auto write_escaped(std::ostream& out, const char* str)-> void {
+		for(; *str; ++str){
+			if(*str == '"' || *str == '\\'){
+				out << '\\';
+			}
+			out << *str;
+		}
+	}
+} // namespace
+
+namespace vuh {
+namespace trace {
+	/// Start recording. Previously recorded events are kept.
+	auto start()-> void {
+		now_ns(); // fix the time origin
+		recorder().recording = true;
+	}
+
+	/// Stop recording.
+	auto stop()-> void {
+		recorder().recording = false;
+	}
+
+	/// @return true if recording is on
+	auto enabled() noexcept-> bool {
+		return recorder().recording.load(std::memory_order_relaxed);
+	}
+
+	/// Forget all recorded events.
+	auto clear()-> void {
+		auto& r = recorder();
+		auto lock = std::lock_guard<std::mutex>(r.mutex);
+		r.events.clear();
+	}
+
+	/// @return time (ns) since the trace time origin (first call of this function)
+	auto now_ns() noexcept-> int64_t {
+		using clock = std::chrono::steady_clock;
+		static const auto origin = clock::now();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - origin).count();
+	}
+
+	/// Record the host span on the current thread track.
+	auto add_span(const char* name, const char* category, int64_t begin_ns, int64_t end_ns
+	              ) noexcept-> void
+	{
+		auto& r = recorder();
+		try{
+			auto lock = std::lock_guard<std::mutex>(r.mutex);
+			r.events.push_back({name, category, begin_ns, end_ns, 0u, r.thread_number()});
+		} catch(std::exception&){ // tracing should never break the traced code
+		}
+	}
+
+	/// Record the GPU span of given duration finishing now.
+	/// GPU clock is not calibrated against the host clock, so spans are aligned to the moment
+	/// host learns about completion (fence wait), and only their durations are exact.
+	auto add_gpu_span(const char* name, const char* category, double duration_ns, bool transfer
+	                  ) noexcept-> void
+	{
+		if(!enabled() || duration_ns <= 0.){
+			return;
+		}
+		const auto end = now_ns();
+		auto& r = recorder();
+		try{
+			auto lock = std::lock_guard<std::mutex>(r.mutex);
+			r.events.push_back({name, category, end - int64_t(duration_ns), end, 1u, transfer ? 1u : 0u});
+		} catch(std::exception&){
+		}
+	}
+
+	/// Write recorded events to a file in Chrome trace JSON format.
+	/// @throws vuh::FileWriteFailure
+	auto write_json(const char* filename)-> void {
+		auto fout = std::ofstream(filename);
+		if(!fout.is_open()){
+			throw FileWriteFailure(std::string("could not open file ") + filename + " for writing");
+		}
+		auto& r = recorder();
+		auto lock = std::lock_guard<std::mutex>(r.mutex);
+		fout << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+		     << R"({"name":"process_name","ph":"M","pid":0,"args":{"name":"host"}},)" "\n"
+		     << R"({"name":"process_name","ph":"M","pid":1,"args":{"name":"gpu"}},)" "\n"
+		     << R"({"name":"thread_name","ph":"M","pid":1,"tid":0,"args":{"name":"compute"}},)" "\n"
+		     << R"({"name":"thread_name","ph":"M","pid":1,"tid":1,"args":{"name":"transfer"}})";
+		fout.precision(3);
+		fout << std::fixed;
+		for(const auto& e: r.events){
+			fout << ",\n{\"name\":\"";
+			write_escaped(fout, e.name);
+			fout << "\",\"cat\":\"";
+			write_escaped(fout, e.category);
+			fout << "\",\"ph\":\"X\",\"ts\":" << 1e-3*double(e.begin_ns)
+			     << ",\"dur\":" << 1e-3*double(e.end_ns - e.begin_ns)
+			     << ",\"pid\":" << e.pid << ",\"tid\":" << e.tid << "}";
+		}
+		fout << "\n]}\n";
+		if(!fout){
+			throw FileWriteFailure(std::string("failed writing trace to ") + filename);
+		}
+	}
+} // namespace trace
+} // namespace vuh
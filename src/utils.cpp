@@ -1,6 +1,7 @@
 #include <vuh/utils.h>
 #include <vuh/error.h>
 #include <vuh/arr/arrayUtils.h>
+#include <vuh/trace.h>
 
 #include <fstream>
 
@@ -34,7 +35,7 @@ inline bool ends_with(std::string const & value, std::string const & ending)
             std::copy_backward(ret.begin(), ret.begin() + size, ret.begin() + size + 4);
             *((uint32_t*)ret.data()) = 0x19981215;
         } else {
-            ret.resize(4u*div_up(uint32_t(ret.size()), 4u));
+            ret.resize(4u*div_up(ret.size(), size_t(4)));
         }
 		return ret;
 	}
@@ -51,6 +52,7 @@ namespace arr {
 	             , size_t dst_offset ///< destination buffer offset (bytes)
 	             )-> void
 	{
+		VUH_TRACE_SCOPE("copyBuf", "transfer");
 		auto cmd_buf = device.transferCmdBuffer();
 		cmd_buf.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
 		auto region = vk::BufferCopy(src_offset, dst_offset, size_bytes);
@@ -61,5 +63,102 @@ namespace arr {
 		queue.submit({submit_info}, nullptr);
 		queue.waitIdle();
 	}
+
+	namespace {
+		/// Record commands to a transient command buffer from the device compute pool,
+		/// submit it to the compute queue and wait for completion.
+		/// Images are only ever touched by the compute queue family, so that their content
+		/// never needs the queue family ownership transfer.
+		template<class F>
+		auto submitComputeSync(vuh::Device& device, F&& record)-> void {
+			auto cmd_buf = device.allocateCommandBuffers({device.computeCmdPool()
+			                                             , vk::CommandBufferLevel::ePrimary, 1})[0];
+			try{
+				cmd_buf.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+				record(cmd_buf);
+				cmd_buf.end();
+				auto queue = device.computeQueue();
+				auto submit_info = vk::SubmitInfo(0, nullptr, nullptr, 1, &cmd_buf);
+				queue.submit({submit_info}, nullptr);
+				queue.waitIdle();
+			} catch(std::runtime_error&){
+				device.freeCommandBuffers(device.computeCmdPool(), 1, &cmd_buf);
+				throw;
+			}
+			device.freeCommandBuffers(device.computeCmdPool(), 1, &cmd_buf);
+		}
+	} // namespace
+
+	/// @return region covering the whole single-layer color image tightly packed in a buffer
+	auto imageRegion(vk::Extent2D extent)-> vk::BufferImageCopy {
+		return vk::BufferImageCopy(0, 0, 0
+		                           , {vk::ImageAspectFlagBits::eColor, 0, 0, 1}
+		                           , {0, 0, 0}, {extent.width, extent.height, 1});
+	}
+
+	/// Record the full memory and execution dependency between compute and transfer operations
+	/// on the image, optionally changing its layout.
+	/// Command buffer is expected to be submitted to the compute queue.
+	auto imageBarrier(vk::CommandBuffer cmd_buf ///< command buffer to record the barrier to
+	                  , vk::Image image         ///< single-layer single-mip color image
+	                  , vk::ImageLayout old_layout ///< current image layout
+	                  , vk::ImageLayout new_layout ///< layout to transition to
+	                  )-> void
+	{
+		const auto stages = vk::PipelineStageFlagBits::eComputeShader
+		                    | vk::PipelineStageFlagBits::eTransfer;
+		const auto access_src = vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite;
+		const auto access_dst = access_src | vk::AccessFlagBits::eShaderRead
+		                        | vk::AccessFlagBits::eTransferRead;
+		auto barrier = vk::ImageMemoryBarrier(access_src, access_dst, old_layout, new_layout
+		                                      , VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED
+		                                      , image, {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+		cmd_buf.pipelineBarrier(stages, stages, {}, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	/// Transition the freshly created image from undefined layout to a given one.
+	/// Fully sync.
+	auto initImageLayout(vuh::Device& device ///< device where image is allocated
+	                     , vk::Image image   ///< image in undefined layout
+	                     , vk::ImageLayout layout ///< layout to transition to
+	                     )-> void
+	{
+		submitComputeSync(device, [&](vk::CommandBuffer cmd_buf){
+			imageBarrier(cmd_buf, image, vk::ImageLayout::eUndefined, layout);
+		});
+	}
+
+	/// Copy tightly packed data from the buffer to the whole image.
+	/// Image is expected to be in general layout. Fully sync.
+	auto copyBufToImage(vuh::Device& device ///< device where buffer and image are allocated
+	                    , vk::Buffer src    ///< source buffer
+	                    , vk::Image dst     ///< destination image (general layout)
+	                    , vk::Extent2D extent ///< image dimensions
+	                    )-> void
+	{
+		VUH_TRACE_SCOPE("copyBufToImage", "transfer");
+		submitComputeSync(device, [&](vk::CommandBuffer cmd_buf){
+			const auto region = imageRegion(extent);
+			imageBarrier(cmd_buf, dst, vk::ImageLayout::eGeneral, vk::ImageLayout::eGeneral);
+			cmd_buf.copyBufferToImage(src, dst, vk::ImageLayout::eGeneral, 1, &region);
+			imageBarrier(cmd_buf, dst, vk::ImageLayout::eGeneral, vk::ImageLayout::eGeneral);
+		});
+	}
+
+	/// Copy the whole image to the buffer, tightly packed.
+	/// Image is expected to be in general layout. Fully sync.
+	auto copyImageToBuf(vuh::Device& device ///< device where buffer and image are allocated
+	                    , vk::Image src     ///< source image (general layout)
+	                    , vk::Buffer dst    ///< destination buffer
+	                    , vk::Extent2D extent ///< image dimensions
+	                    )-> void
+	{
+		VUH_TRACE_SCOPE("copyImageToBuf", "transfer");
+		submitComputeSync(device, [&](vk::CommandBuffer cmd_buf){
+			const auto region = imageRegion(extent);
+			imageBarrier(cmd_buf, src, vk::ImageLayout::eGeneral, vk::ImageLayout::eGeneral);
+			cmd_buf.copyImageToBuffer(src, vk::ImageLayout::eGeneral, dst, 1, &region);
+		});
+	}
 } // namespace arr
 } // namespace vuh
@@ -3,8 +3,13 @@
 #include <vuh/vuh.h>
 #include <vuh/array.hpp>
 #include <vuh/arr/copy_async.hpp>
+#include <vuh/file.h>
 
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <numeric>
 
 using std::begin;
 using std::end;
@@ -104,4 +109,100 @@ TEST_CASE("async copy device-local memory", "[array][correctness][async]"){
 			REQUIRE(host_data_tst == host_data);
 		}
 	}
+	SECTION("region copies"){
+		auto iota = std::vector<float>(arr_size);
+		std::iota(begin(iota), end(iota), 0.f);
+		auto array_src = vuh::Array<float, vuh::mem::Device>(device, iota);
+		auto array_dst = vuh::Array<float, vuh::mem::Device>(device, std::vector<float>(arr_size, -1.f));
+
+		SECTION("list of regions"){
+			const auto regions = std::vector<vuh::CopyRegion>{{0, 8, 4}, {64, 0, 8}};
+			vuh::copy_async(device_begin(array_src), device_begin(array_dst), regions).wait();
+			auto expected = std::vector<float>(arr_size, -1.f);
+			std::copy(begin(iota), begin(iota) + 4, begin(expected) + 8);
+			std::copy(begin(iota) + 64, begin(iota) + 72, begin(expected));
+			REQUIRE(array_dst.toHost<std::vector<float>>() == expected);
+		}
+		SECTION("2d block"){ // 4x8 block at (2, 3) of 16x8 matrix to packed 4x8 layout
+			auto src_begin = device_begin(array_src);
+			src_begin += 3*16 + 2;
+			vuh::copy_async_2d(src_begin, 16, device_begin(array_dst), 4, 4, 8).wait();
+			auto expected = std::vector<float>(arr_size, -1.f);
+			for(size_t i = 0; i < 8; ++i){
+				std::copy_n(begin(iota) + (3 + i)*16 + 2, 4, begin(expected) + i*4);
+			}
+			REQUIRE(array_dst.toHost<std::vector<float>>() == expected);
+		}
+		SECTION("out of range regions are rejected"){
+			const auto max = std::numeric_limits<size_t>::max();
+			using regions = std::vector<vuh::CopyRegion>;
+			REQUIRE_THROWS_AS(vuh::copy_async(device_begin(array_src), device_begin(array_dst)
+			                                  , regions{{0, 0, 4}, {arr_size - 2, 0, 4}})
+			                  , vuh::BufferRangeExceeded);
+			REQUIRE_THROWS_AS(vuh::copy_async(device_begin(array_src), device_begin(array_dst) + 4
+			                                  , regions{{0, arr_size - 4, 1}})
+			                  , vuh::BufferRangeExceeded);
+			REQUIRE_THROWS_AS(vuh::copy_async(device_begin(array_src), device_begin(array_dst)
+			                                  , regions{{max, 0, 2}})
+			                  , vuh::BufferRangeExceeded);
+			REQUIRE_THROWS_AS(vuh::copy_async_2d(device_begin(array_src), 16, device_begin(array_dst)
+			                                     , 4, 4, arr_size/16 + 1)
+			                  , vuh::BufferRangeExceeded);
+			REQUIRE_THROWS_AS(vuh::copy_async_2d(device_begin(array_src), 4, device_begin(array_dst)
+			                                     , 8, 8, 2)
+			                  , vuh::BufferRangeExceeded);
+			REQUIRE_THROWS_AS(vuh::copy_async_2d(device_begin(array_src), max/2, device_begin(array_dst)
+			                                     , 4, 4, 3)
+			                  , vuh::BufferRangeExceeded);
+			REQUIRE(array_dst.toHost<std::vector<float>>() == std::vector<float>(arr_size, -1.f));
+		}
+		SECTION("regions between devices are rejected"){
+			auto other = vuh::Device(instance, instance.devices().at(0));
+			auto array_other = vuh::Array<float, vuh::mem::Device>(other, arr_size);
+			REQUIRE_THROWS_AS(vuh::copy_async(device_begin(array_src), device_begin(array_other)
+			                                  , std::vector<vuh::CopyRegion>{{0, 0, 4}})
+			                  , vuh::DeviceMismatch);
+			REQUIRE_THROWS_AS(vuh::copy_async_2d(device_begin(array_src), 16, device_begin(array_other)
+			                                     , 4, 4, 2)
+			                  , vuh::DeviceMismatch);
+		}
+	}
+	SECTION("device-side fill and update"){
+		auto array = vuh::Array<float, vuh::mem::Device>(device, host_data);
+		vuh::zero_async(device_begin(array), device_end(array)).wait();
+		REQUIRE(array.toHost<std::vector<float>>() == std::vector<float>(arr_size, 0.f));
+
+		vuh::fill_async(vuh::array_view(array, arr_size/2, arr_size), 6.28f).wait();
+		auto expected = std::vector<float>(arr_size, 0.f);
+		std::fill(begin(expected) + arr_size/2, end(expected), 6.28f);
+		REQUIRE(array.toHost<std::vector<float>>() == expected);
+
+		vuh::update_async(host_data.data(), host_data.data() + arr_size/2, device_begin(array)).wait();
+		std::copy(begin(host_data), begin(host_data) + arr_size/2, begin(expected));
+		REQUIRE(array.toHost<std::vector<float>>() == expected);
+
+		auto bytes = vuh::Array<uint8_t, vuh::mem::Device>(device, 16);
+		REQUIRE_THROWS_AS(vuh::zero_async(device_begin(bytes) + 1, device_begin(bytes) + 5)
+		                  , vuh::BufferOffsetMisaligned);
+		REQUIRE_THROWS_AS(vuh::zero_async(device_begin(bytes), device_begin(bytes) + 6)
+		                  , vuh::BufferOffsetMisaligned);
+	}
+	SECTION("file transfers"){
+		const auto path = std::string("vuh_file_t.bin");
+		auto array = vuh::Array<float, vuh::mem::Device>(device, host_data);
+		vuh::copy_async(device_begin(array), device_end(array), vuh::file(path)).wait();
+		auto array_dst = vuh::Array<float, vuh::mem::Device>(device, arr_size);
+		vuh::copy_async(vuh::file(path, arr_size/2*sizeof(float)), device_begin(array_dst)).wait();
+		auto host_data_tst = std::vector<float>(arr_size/2, 0.f);
+		array_dst.rangeToHost(0, arr_size/2, begin(host_data_tst));
+		REQUIRE(host_data_tst == std::vector<float>(begin(host_data) + arr_size/2, end(host_data)));
+		std::remove(path.c_str());
+
+		// destination range shorter than the source: only its size is written
+		vuh::copy_async(device_begin(array), device_end(array)
+		                , vuh::file(path, 0, arr_size/4*sizeof(float))).wait();
+		REQUIRE(std::ifstream(path, std::ios::binary | std::ios::ate).tellg()
+		        == std::streamoff(arr_size/4*sizeof(float)));
+		std::remove(path.c_str());
+	}
 }
@@ -3,7 +3,10 @@
 #include <vuh/vuh.h>
 #include <vuh/array.hpp>
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <vector>
 
 using std::begin;
 using std::end;
@@ -66,6 +69,15 @@ TEST_CASE("array with memory directly allocated from device", "[array][correctne
 			array.toHost(begin(host_dst), arr_size, [](auto x){ return 2.f*x;});
 			REQUIRE(host_dst == host_data_doubled);
 		}
+		SECTION("callback transfers to host through the staging buffer"){
+			auto array = vuh::Array<float, vuh::mem::Device>(device, host_data);
+			auto host_dst = std::vector<float>(arr_size, 0.f);
+			array.toHost([&](const float* p){ std::copy(p, p + arr_size - 3, begin(host_dst) + 3); }, 3);
+			REQUIRE(std::vector<float>(begin(host_dst) + 3, end(host_dst)) == std::vector<float>(arr_size - 3, 3.14f));
+			array.fromHost(begin(host_data_doubled), end(host_data_doubled));
+			array.toHost(begin(host_dst), arr_size, [](auto x){ return 0.5f*x;});
+			REQUIRE(host_dst == host_data);
+		}
 		// this one is deliberately same as construct from iterable
 		SECTION("transfer whole array to newly created host std::vector"){
 			auto array = vuh::Array<float, vuh::mem::Device>(device, host_data);
@@ -140,9 +152,169 @@ TEST_CASE("array with memory directly allocated from device", "[array][correctne
 			REQUIRE(std::vector<float>(begin(array), end(array)) == host_data_doubled);
 		}
 	}
+	SECTION("partial transfers to host-cached memory"){
+		auto array = vuh::Array<float, vuh::mem::HostCached>(device, std::vector<float>(arr_size, 0.f));
+		const auto offset = arr_size/2 + 3;
+		array.fromHost(begin(host_data), begin(host_data) + 5, offset);
+		auto part = std::vector<float>(5, 0.f);
+		array.rangeToHost(offset, offset + 5, begin(part));
+		REQUIRE(part == std::vector<float>(5, 3.14f));
+		auto all = array.toHost<std::vector<float>>();
+		REQUIRE(all[offset - 1] == 0.f);
+		REQUIRE(all[offset + 5] == 0.f);
+	}
+	SECTION("map policies"){
+		auto array = vuh::Array<float, vuh::mem::HostCached>(device, host_data);
+		REQUIRE(array.map_policy() == vuh::MapPolicy::Lazy);
+		array.set_map_policy(vuh::MapPolicy::Persistent);
+		REQUIRE(array.isMapped());
+		array.fromHost(begin(host_data_doubled), end(host_data_doubled));
+		REQUIRE(array.isMapped());
+		REQUIRE(array.toHost<std::vector<float>>() == host_data_doubled);
+		array.set_map_policy(vuh::MapPolicy::Transient);
+		REQUIRE(!array.isMapped());
+		array.fromHost(begin(host_data), end(host_data));
+		REQUIRE(!array.isMapped());
+		REQUIRE(array.toHost<std::vector<float>>() == host_data);
+	}
+	SECTION("device vector"){
+		auto vec = vuh::DeviceVector<float>(device);
+		REQUIRE(vec.empty());
+		auto expected = std::vector<float>{};
+		for(size_t i = 0; i < 10; ++i){
+			vec.push_back_range(begin(host_data), begin(host_data) + 13);
+			expected.insert(end(expected), begin(host_data), begin(host_data) + 13);
+		}
+		REQUIRE(vec.size() == expected.size());
+		REQUIRE(vec.capacity() >= vec.size());
+		REQUIRE(vec.capacity() < 2*vec.size() + 13);
+		REQUIRE(vec.toHost() == expected);
+		vec.resize(5);
+		vec.shrink_to_fit();
+		REQUIRE(vec.capacity() == 5);
+		REQUIRE(vec.toHost() == std::vector<float>(begin(expected), begin(expected) + 5));
+	}
+	SECTION("64-bit sizes"){
+		REQUIRE(vuh::div_up(size_t(5) << 32, size_t(2)) == (size_t(5) << 31));
+		REQUIRE(vuh::div_up(uint32_t(9), 8) == 2u);
+		auto array = vuh::Array<float, vuh::mem::DeviceOnly>(device, arr_size);
+		REQUIRE(array.size() == arr_size);
+	}
+	SECTION("transient arena aliases arrays with disjoint lifetimes"){
+		auto arena = vuh::TransientArena<>(device);
+		auto a = arena.add<float>(arr_size, 0, 1);
+		auto b = arena.add<float>(arr_size, 1, 2);
+		auto c = arena.add<float>(arr_size, 2, 3);
+		arena.commit();
+		REQUIRE(arena.count() == 3);
+		REQUIRE(arena.size_bytes() >= 2*arr_size*sizeof(float));
+		REQUIRE(arena.size_bytes() < arena.unaliased_size_bytes());
+		auto arr_a = arena.get(a);
+		REQUIRE(arr_a.size() == arr_size);
+		REQUIRE(arena.get(c).size_bytes() == arr_size*sizeof(float));
+		(void)b;
+	}
+	SECTION("parallel host copies"){
+		vuh::setHostCopyThreads(0);
+		const auto big = std::vector<float>(size_t(3) << 20, 1.5f);
+		auto array = vuh::Array<float, vuh::mem::Host>(device, begin(big), end(big));
+		REQUIRE(std::equal(begin(big), end(big), array.begin()));
+		auto array_dev = vuh::Array<float, vuh::mem::Device>(device, big.size());
+		array_dev.fromHost(begin(big), end(big), [](float x){ return 2.f*x; });
+		REQUIRE(array_dev.toHost<std::vector<float>>() == std::vector<float>(big.size(), 3.f));
+		vuh::setHostCopyThreads(1);
+	}
+	SECTION("streaming host copies"){
+		REQUIRE(vuh::arr::detail::is_contiguous<std::vector<float>::iterator>);
+		REQUIRE(vuh::arr::detail::is_contiguous<std::vector<float>::const_iterator>);
+		REQUIRE(!vuh::arr::detail::is_contiguous<std::vector<bool>::iterator>);
+
+		// unaligned head and tail around the body copied with 64-byte non-temporal stores
+		auto src = std::vector<uint8_t>(1024);
+		for(size_t i = 0; i < src.size(); ++i){ src[i] = uint8_t(i*7 + 1); }
+		auto dst = std::vector<uint8_t>(src.size(), 0);
+		const auto n_bytes = size_t(64*7 + 13);
+		vuh::arr::stream_copy(dst.data() + 3, src.data() + 5, n_bytes);
+		REQUIRE(std::equal(begin(src) + 5, begin(src) + 5 + n_bytes, begin(dst) + 3));
+		REQUIRE(dst[2] == 0);
+		REQUIRE(dst[3 + n_bytes] == 0);
+
+		// vector iterators take the streaming path, source not aligned to the cache line
+		auto data = std::vector<float>(3*arr_size + 3);
+		for(size_t i = 0; i < data.size(); ++i){ data[i] = float(i); }
+		auto array = vuh::Array<float, vuh::mem::Host>(device, begin(data) + 1, end(data));
+		REQUIRE(std::equal(begin(data) + 1, end(data), array.begin()));
+	}
+	SECTION("array views"){
+		auto iota = std::vector<float>(arr_size);
+		for(size_t i = 0; i < arr_size; ++i){ iota[i] = float(i); }
+		auto array = vuh::Array<float, vuh::mem::Device>(device, iota);
+		auto view = vuh::array_view(array, 16, 48);
+		REQUIRE(view.size() == 32);
+		REQUIRE(view.offset_bytes() == 16*sizeof(float));
+
+		auto sub = view.subview(8, 16);
+		REQUIRE(sub.offset() == 24);
+		REQUIRE(sub.toHost<std::vector<float>>() == std::vector<float>(begin(iota) + 24, begin(iota) + 32));
+
+		sub.fromHost(begin(host_data), end(host_data)); // clamped to the view size
+		auto expected = iota;
+		std::fill(begin(expected) + 24, begin(expected) + 32, 3.14f);
+		REQUIRE(array.toHost<std::vector<float>>() == expected);
+
+		auto array_dst = vuh::Array<float, vuh::mem::Device>(device, arr_size);
+		vuh::copy_async(device_begin(view), device_end(view), device_begin(array_dst)).wait();
+		auto host_dst = std::vector<float>(view.size());
+		array_dst.rangeToHost(0, view.size(), begin(host_dst));
+		REQUIRE(host_dst == std::vector<float>(begin(expected) + 16, begin(expected) + 48));
+	}
 	SECTION("void memory allocator should throw"){
 		REQUIRE_THROWS(([&](){
 			auto d_array = vuh::Array<float, vuh::arr::AllocDevice<void>>(device, arr_size);
 		}()));
 	}
+	SECTION("memory accounting"){
+		auto total = [&]{
+			auto r = std::pair<vk::DeviceSize, uint64_t>{0, 0};
+			for(uint32_t i = 0; i < device.heapCount(); ++i){
+				r.first += device.heapUsage(i).allocated_bytes;
+				r.second += device.heapUsage(i).allocation_count;
+			}
+			return r;
+		};
+		const auto before = total();
+		{
+			auto array = vuh::Array<float, vuh::mem::Device>(device, arr_size);
+			REQUIRE(total().first >= before.first + arr_size*sizeof(float));
+			REQUIRE(total().second == before.second + 1);
+		}
+		REQUIRE(total() == before);
+	}
+	SECTION("cached physical device data"){
+		REQUIRE(device.properties().deviceID == device.phys().getProperties().deviceID);
+		REQUIRE(device.memoryProperties().memoryTypeCount == device.phys().getMemoryProperties().memoryTypeCount);
+		REQUIRE(device.queueFamilies().size() == device.phys().getQueueFamilyProperties().size());
+		const auto all_types = (1u << device.memoryProperties().memoryTypeCount) - 1;
+		const auto id = device.selectMemoryType(all_types, vk::MemoryPropertyFlagBits::eHostVisible);
+		REQUIRE(id != uint32_t(-1));
+		REQUIRE(device.selectMemoryType(all_types, vk::MemoryPropertyFlagBits::eHostVisible) == id);
+	}
+	SECTION("allocations exceeding the budget should throw instead of falling back"){
+		auto heap_id = uint32_t(-1);
+		{
+			auto counts = std::vector<uint64_t>{};
+			for(uint32_t i = 0; i < device.heapCount(); ++i){
+				counts.push_back(device.heapUsage(i).allocation_count);
+			}
+			auto array = vuh::Array<float, vuh::mem::Device>(device, arr_size);
+			for(uint32_t i = 0; i < device.heapCount(); ++i){
+				if(device.heapUsage(i).allocation_count > counts[i]){ heap_id = i; }
+			}
+		}
+		REQUIRE(heap_id != uint32_t(-1));
+		device.setMemoryBudget(heap_id, 1);
+		REQUIRE_THROWS_AS((vuh::Array<float, vuh::mem::Device>(device, arr_size))
+		                  , vuh::MemoryBudgetExceeded);
+		device.setMemoryBudget(heap_id, 0);
+	}
 }
@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+#include <vuh/alg/compact.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+TEST_CASE("stream compaction", "[correctness][async][algorithms]"){
+	auto instance = vuh::Instance();
+	auto device = vuh::Device(instance, instance.devices().at(0));
+
+	SECTION("elements satisfying the comparison keep their order"){
+		auto host_data = std::vector<float>(1000003);
+		for(size_t i = 0; i < host_data.size(); ++i){
+			host_data[i] = float(i % 101) - 50.f;
+		}
+		auto ref = std::vector<float>();
+		std::copy_if(begin(host_data), end(host_data), std::back_inserter(ref), [](float x){ return x >= 10.f; });
+		auto d_src = vuh::Array<float>(device, host_data);
+		auto d_dst = vuh::Array<float>(device, host_data.size());
+		auto d_count = vuh::Array<uint32_t>(device, 1);
+		vuh::copy_if(vuh::array_view(d_src, 0, host_data.size()), device_begin(d_dst), device_begin(d_count)
+		             , vuh::CompareOp::GreaterEqual, 10.f).wait();
+		REQUIRE(d_count.toHost<std::vector<uint32_t>>()[0] == ref.size());
+		auto result = d_dst.toHost<std::vector<float>>();
+		result.resize(ref.size());
+		REQUIRE(result == ref);
+	}
+	SECTION("indirect dispatch command follows the count"){
+		auto host_data = std::vector<int32_t>(5000, 3);
+		host_data[17] = 7;
+		host_data[4999] = 7;
+		auto d_src = vuh::Array<int32_t>(device, host_data);
+		auto d_dst = vuh::Array<int32_t>(device, host_data.size());
+		auto d_count = vuh::Array<uint32_t>(device, 5, {}, vk::BufferUsageFlagBits::eIndirectBuffer);
+		vuh::copy_if(vuh::array_view(d_src, 10, 5000), device_begin(d_dst), device_begin(d_count) + 1
+		             , vuh::CompareOp::NotEqual, 3, 64).wait();
+		auto count = d_count.toHost<std::vector<uint32_t>>();
+		REQUIRE(std::vector<uint32_t>(begin(count) + 1, end(count)) == std::vector<uint32_t>{2, 1, 1, 1});
+		REQUIRE(d_dst.toHost<std::vector<int32_t>>()[1] == 7);
+	}
+	SECTION("short destination or count is rejected"){
+		auto d_src = vuh::Array<uint32_t>(device, 100);
+		auto d_dst = vuh::Array<uint32_t>(device, 100);
+		auto d_count = vuh::Array<uint32_t>(device, 4);
+		auto view = vuh::array_view(d_src, 0, 100);
+		REQUIRE_THROWS_AS(vuh::copy_if(view, device_begin(d_dst) + 1, device_begin(d_count)
+		                               , vuh::CompareOp::Less, 1u), vuh::BufferRangeExceeded);
+		REQUIRE_THROWS_AS(vuh::copy_if(view, device_begin(d_dst), device_begin(d_count) + 1
+		                               , vuh::CompareOp::Less, 1u, 32), vuh::BufferRangeExceeded);
+		auto other = vuh::Device(instance, instance.devices().at(0));
+		auto d_other = vuh::Array<uint32_t>(other, 4);
+		REQUIRE_THROWS_AS(vuh::copy_if(view, device_begin(d_dst), device_begin(d_other)
+		                               , vuh::CompareOp::Less, 1u), vuh::DeviceMismatch);
+	}
+	SECTION("empty input"){
+		auto d_src = vuh::Array<uint32_t>(device, 16);
+		auto d_count = vuh::Array<uint32_t>(device, std::vector<uint32_t>(4, 42u));
+		vuh::copy_if(vuh::array_view(d_src, 0, 0), device_begin(d_src), device_begin(d_count)
+		             , vuh::CompareOp::Less, 1u, 32).wait();
+		REQUIRE(d_count.toHost<std::vector<uint32_t>>() == std::vector<uint32_t>{0, 0, 1, 1});
+	}
+}
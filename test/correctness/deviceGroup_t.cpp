@@ -0,0 +1,81 @@
+#include <catch2/catch.hpp>
+#include "approx.hpp"
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+#include <vuh/deviceGroup.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+using test::approx;
+
+TEST_CASE("device group sharding", "[correctness][async]"){
+	auto instance = vuh::Instance();
+	const auto physdev = instance.devices().at(0);
+	auto group = vuh::DeviceGroup(instance, {physdev, physdev}); // two logical devices
+
+	SECTION("split follows weights and granule"){
+		auto shards = group.split(1000, 64);
+		REQUIRE(shards.size() == 2);
+		REQUIRE(shards[0].first == 0);
+		REQUIRE(shards[0].last % 64 == 0);
+		REQUIRE(shards[1].first == shards[0].last);
+		REQUIRE(shards[1].last == 1000);
+
+		group.setWeights({3., 1.});
+		shards = group.split(1024, 64);
+		REQUIRE(shards[0].size() == 768);
+		REQUIRE(shards[1].size() == 256);
+		REQUIRE_THROWS_AS(group.setWeights({1.}), std::invalid_argument);
+	}
+	SECTION("copy between devices"){
+		auto host_data = std::vector<float>(1000);
+		std::iota(begin(host_data), end(host_data), 0.f);
+		auto d_src = vuh::Array<float>(group.device(0), host_data);
+		auto d_dst = vuh::Array<float>(group.device(1), std::vector<float>(1000, -1.f));
+		vuh::copy_async(device_begin(d_src) + 100, device_begin(d_src) + 300, device_begin(d_dst)).wait();
+		auto expected = std::vector<float>(1000, -1.f);
+		std::copy(begin(host_data) + 100, begin(host_data) + 300, begin(expected));
+		REQUIRE(d_dst.toHost<std::vector<float>>() == expected);
+	}
+	SECTION("sharded saxpy"){
+		constexpr auto arr_size = size_t(1024);
+		constexpr auto grid_x = uint32_t(32);
+		const auto a = 0.1f;
+		auto y = std::vector<float>(arr_size, 1.f);
+		auto x = std::vector<float>(arr_size);
+		std::iota(begin(x), end(x), 0.f);
+		auto out_ref = y;
+		for(size_t i = 0; i < arr_size; ++i){
+			out_ref[i] += a*x[i];
+		}
+
+		using Specs = vuh::typelist<uint32_t>;
+		struct Params{uint32_t size; float a;};
+		using Program = vuh::Program<Specs, Params>;
+		auto programs = std::vector<std::unique_ptr<Program>>{};
+		for(size_t i = 0; i < group.size(); ++i){
+			programs.push_back(std::make_unique<Program>(group.device(i), "../shaders/saxpy.spv"));
+		}
+
+		auto d_y = vuh::ShardedArray<float>(group, begin(y), end(y), grid_x);
+		auto d_x = vuh::ShardedArray<float>(group, begin(x), end(x), grid_x);
+		const auto& shards = d_y.shards();
+		auto run = [&](const vuh::Shard& s){
+			const auto n = uint32_t(s.size());
+			return programs[s.device]->grid(n/grid_x).spec(grid_x)
+			                          .run_async({n, a}, d_y.view(s.device), d_x.view(s.device));
+		};
+		group.run(shards, run);
+		REQUIRE(d_y.toHost<std::vector<float>>() == approx(out_ref).eps(1.e-5).verbose());
+
+		const auto& w = group.weights();
+		REQUIRE(w[0] + w[1] == Approx(1.));
+		REQUIRE(w[0] > 0.);
+		REQUIRE(w[1] > 0.);
+	}
+}
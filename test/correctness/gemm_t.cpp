@@ -0,0 +1,109 @@
+#include <catch2/catch.hpp>
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+#include <vuh/alg/gemm.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+	/// Host reference of C = alpha*A*B + beta*C for row-major matrices with tight strides.
+	auto gemm_ref(uint32_t m, uint32_t n, uint32_t k, float alpha, const float* a, const float* b
+	              , float beta, float* c)-> void
+	{
+		for(uint32_t i = 0; i < m; ++i){
+			for(uint32_t j = 0; j < n; ++j){
+				auto s = 0.f;
+				for(uint32_t l = 0; l < k; ++l){
+					s += a[i*k + l]*b[l*n + j];
+				}
+				c[i*n + j] = alpha*s + beta*c[i*n + j];
+			}
+		}
+	}
+
+	auto approx_equal(const std::vector<float>& x, const std::vector<float>& y)-> bool {
+		if(x.size() != y.size()){
+			return false;
+		}
+		for(size_t i = 0; i < x.size(); ++i){
+			if(std::abs(x[i] - y[i]) > 1e-3f*(1.f + std::abs(y[i]))){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	auto matrix(size_t n_elements, uint32_t seed)-> std::vector<float> {
+		auto r = std::vector<float>(n_elements);
+		for(size_t i = 0; i < r.size(); ++i){
+			r[i] = float((i*seed) % 17)*0.125f - 1.f;
+		}
+		return r;
+	}
+} // namespace
+
+TEST_CASE("tiled matrix multiply", "[correctness][async][algorithms]"){
+	auto instance = vuh::Instance();
+	auto device = vuh::Device(instance, instance.devices().at(0));
+	const auto m = uint32_t(37);
+	const auto n = uint32_t(53);
+	const auto k = uint32_t(29);
+	const auto h_a = matrix(m*k, 3);
+	const auto h_b = matrix(k*n, 5);
+	const auto h_c = matrix(m*n, 7);
+	auto ref = h_c;
+	gemm_ref(m, n, k, 0.5f, h_a.data(), h_b.data(), 2.f, ref.data());
+	auto d_a = vuh::Array<float>(device, h_a);
+	auto d_b = vuh::Array<float>(device, h_b);
+
+	SECTION("all tiling variants over the matrices not divisible by tiles"){
+		for(const auto& v: vuh::detail::gemm_variants()){
+			if(v.group_x*v.group_y > device.limits().maxComputeWorkGroupInvocations){
+				continue;
+			}
+			auto d_c = vuh::Array<float>(device, h_c);
+			auto batch = vuh::detail::Batch(device);
+			vuh::detail::record_gemm(batch, device, v, m, n, k, 0.5f, {d_a, 0, k, 0}, {d_b, 0, n, 0}
+			                         , 2.f, {d_c, 0, n, 0}, 1);
+			auto fence = batch.submit();
+			vuh::Delayed<vuh::Copy>{fence, device, vuh::Copy::wrap(std::move(batch))}.wait();
+			REQUIRE(approx_equal(d_c.toHost<std::vector<float>>(), ref));
+		}
+	}
+	SECTION("tuned variant"){
+		auto d_c = vuh::Array<float>(device, h_c);
+		vuh::gemm(m, n, k, 0.5f, vuh::array_view(d_a, 0, m*k), k, vuh::array_view(d_b, 0, k*n), n
+		          , 2.f, vuh::array_view(d_c, 0, m*n), n).wait();
+		REQUIRE(approx_equal(d_c.toHost<std::vector<float>>(), ref));
+	}
+	SECTION("strided batched and batched"){
+		const auto n_batch = uint32_t(3);
+		const auto h_as = matrix(n_batch*m*k, 11);
+		const auto h_bs = matrix(n_batch*k*n, 13);
+		auto refs = std::vector<float>(n_batch*m*n, 0.f);
+		for(uint32_t i = 0; i < n_batch; ++i){
+			gemm_ref(m, n, k, 1.f, h_as.data() + i*m*k, h_bs.data() + i*k*n, 0.f, refs.data() + i*m*n);
+		}
+		auto d_as = vuh::Array<float>(device, h_as);
+		auto d_bs = vuh::Array<float>(device, h_bs);
+		auto d_cs = vuh::Array<float>(device, n_batch*m*n);
+		vuh::gemm_strided_batched(m, n, k, 1.f, vuh::array_view(d_as, 0, n_batch*m*k), k, m*k
+		                          , vuh::array_view(d_bs, 0, n_batch*k*n), n, k*n
+		                          , 0.f, vuh::array_view(d_cs, 0, n_batch*m*n), n, m*n, n_batch).wait();
+		REQUIRE(approx_equal(d_cs.toHost<std::vector<float>>(), refs));
+
+		using View = vuh::ArrayView<vuh::Array<float>>;
+		auto as = std::vector<View>{}, bs = std::vector<View>{}, cs = std::vector<View>{};
+		auto d_cs2 = vuh::Array<float>(device, n_batch*m*n);
+		for(uint32_t i = 0; i < n_batch; ++i){
+			as.push_back(vuh::array_view(d_as, i*m*k, (i + 1)*m*k));
+			bs.push_back(vuh::array_view(d_bs, i*k*n, (i + 1)*k*n));
+			cs.push_back(vuh::array_view(d_cs2, i*m*n, (i + 1)*m*n));
+		}
+		vuh::gemm_batched(m, n, k, 1.f, as, k, bs, n, 0.f, cs, n).wait();
+		REQUIRE(approx_equal(d_cs2.toHost<std::vector<float>>(), refs));
+	}
+}
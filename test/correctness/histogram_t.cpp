@@ -0,0 +1,43 @@
+#include <catch2/catch.hpp>
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+#include <vuh/alg/histogram.hpp>
+
+#include <cstdint>
+#include <vector>
+
+TEST_CASE("device histogram", "[correctness][async][algorithms]"){
+	auto instance = vuh::Instance();
+	auto device = vuh::Device(instance, instance.devices().at(0));
+
+	SECTION("privatized bins, out of range elements are skipped"){
+		auto host_data = std::vector<int32_t>(1000003);
+		for(size_t i = 0; i < host_data.size(); ++i){
+			host_data[i] = int32_t(i % 120) - 10;
+		}
+		auto ref = std::vector<uint32_t>(10, 0);
+		for(auto x: host_data){
+			if(x >= 0 && x < 100){
+				++ref[size_t(x/10)];
+			}
+		}
+		auto d_data = vuh::Array<int32_t>(device, host_data);
+		auto d_bins = vuh::Array<uint32_t>(device, std::vector<uint32_t>(10, 42u));
+		vuh::histogram(vuh::array_view(d_data, 0, host_data.size()), vuh::array_view(d_bins, 0, 10)
+		               , 0, 100).wait();
+		REQUIRE(d_bins.toHost<std::vector<uint32_t>>() == ref);
+	}
+	SECTION("bins exceeding shared memory"){
+		const auto n_bins = size_t(5000);
+		auto host_data = std::vector<float>(3*n_bins);
+		for(size_t i = 0; i < host_data.size(); ++i){
+			host_data[i] = float(i % n_bins) + 0.5f;
+		}
+		auto d_data = vuh::Array<float>(device, host_data);
+		auto d_bins = vuh::Array<uint32_t>(device, n_bins);
+		vuh::histogram(vuh::array_view(d_data, 0, host_data.size()), vuh::array_view(d_bins, 0, n_bins)
+		               , 0.f, float(n_bins)).wait();
+		REQUIRE(d_bins.toHost<std::vector<uint32_t>>() == std::vector<uint32_t>(n_bins, 3u));
+	}
+}
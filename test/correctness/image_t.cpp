@@ -0,0 +1,64 @@
+#include <catch2/catch.hpp>
+#include "approx.hpp"
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using std::begin;
+using std::end;
+using test::approx;
+
+TEST_CASE("2D images", "[image][correctness]"){
+	constexpr auto width = uint32_t(37);
+	constexpr auto height = uint32_t(21);
+	auto host_data = [](){
+		auto r = std::vector<float>(width*height);
+		for(size_t i = 0; i < r.size(); ++i){ r[i] = float(i); }
+		return r;
+	}();
+
+	auto instance = vuh::Instance();
+	auto device = instance.devices().at(0);
+
+	SECTION("host data roundtrip"){
+		auto img = vuh::Image2D<float>(device, width, height, begin(host_data), end(host_data));
+		REQUIRE(img.toHost() == host_data);
+	}
+	SECTION("async host data roundtrip"){
+		auto img = vuh::Image2D<float>(device, width, height);
+		vuh::copy_async(begin(host_data), end(host_data), img).wait();
+		auto out = std::vector<float>(host_data.size(), 0.f);
+		vuh::copy_async(img, begin(out)).wait();
+		REQUIRE(out == host_data);
+	}
+	SECTION("host range of wrong size is rejected"){
+		auto img = vuh::Image2D<float>(device, width, height);
+		const auto short_end = begin(host_data) + host_data.size()/2;
+		REQUIRE_THROWS_AS(img.fromHost(begin(host_data), short_end), vuh::BufferRangeExceeded);
+		REQUIRE_THROWS_AS(vuh::copy_async(begin(host_data), short_end, img), vuh::BufferRangeExceeded);
+	}
+	SECTION("storage and sampled image kernel arguments"){
+		struct Params{uint32_t width; uint32_t height; float a;};
+		const auto a = 2.f;
+		auto img_in = vuh::Image2D<float>(device, width, height, begin(host_data), end(host_data));
+		auto img_out = vuh::Image2D<float>(device, width, height);
+		auto program = vuh::Program<vuh::typelist<>, Params>(device, "../shaders/image_scale.spv");
+		program.grid(vuh::div_up(width, 8), vuh::div_up(height, 8))
+		       ({width, height, a}, img_out, vuh::sampled(img_in));
+
+		auto out_ref = host_data;
+		std::transform(begin(out_ref), end(out_ref), begin(out_ref), [a](float x){ return a*x; });
+		REQUIRE(img_out.toHost() == approx(out_ref).eps(1.e-5));
+	}
+	SECTION("storage image passed for a sampler is rejected at bind"){
+		struct Params{uint32_t width; uint32_t height; float a;};
+		auto img_in = vuh::Image2D<float>(device, width, height);
+		auto img_out = vuh::Image2D<float>(device, width, height);
+		auto program = vuh::Program<vuh::typelist<>, Params>(device, "../shaders/image_scale.spv");
+		REQUIRE_THROWS_AS(program.grid(1, 1).bind({width, height, 1.f}, img_out, img_in)
+		                  , vuh::ShaderInterfaceMismatch);
+	}
+}
@@ -0,0 +1,73 @@
+#include <catch2/catch.hpp>
+
+#include <vuh/vuh.h>
+#include <vuh/cache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("device selection", "[correctness]"){
+	auto instance = vuh::Instance();
+	const auto devices = instance.devices();
+
+	SECTION("best device is one of the available ones"){
+		const auto best = instance.bestDevice();
+		REQUIRE(std::find(begin(devices), end(devices), best) != end(devices));
+		REQUIRE(instance.rankDevices().size() == devices.size());
+	}
+	SECTION("unsatisfiable criteria throw"){
+		auto criteria = vuh::DeviceCriteria{};
+		criteria.extensions = {"VK_VUH_no_such_extension"};
+		REQUIRE(instance.rankDevices(criteria).empty());
+		REQUIRE_THROWS_AS(instance.bestDevice(criteria), vuh::NoSuitableDeviceFound);
+	}
+	SECTION("probe results are cached"){
+		const auto path = std::string("vuh_probe_t.txt");
+		std::remove(path.c_str());
+		auto criteria = vuh::DeviceCriteria{};
+		criteria.probe = true;
+		criteria.probe_cache = path;
+		const auto best = instance.bestDevice(criteria);
+		const auto cache = vuh::DiskCache(path);
+		REQUIRE(cache.get("bandwidth:" + vuh::DiskCache::deviceKey(best)));
+		REQUIRE(instance.bestDevice(criteria) == best); // served from cache
+		std::remove(path.c_str());
+	}
+	SECTION("device object cache is shared between threads"){
+		auto device = vuh::Device(instance, devices.at(0));
+		auto made = std::atomic<int>(0);
+		auto objects = std::vector<const int*>(8, nullptr);
+		auto threads = std::vector<std::thread>{};
+		for(size_t i = 0; i < objects.size(); ++i){
+			threads.emplace_back([&, i]{
+				objects[i] = &device.cached<int>("test:outer", [&]{
+					++made;
+					// creation may request other cached objects
+					const auto inner = device.cached<int>("test:inner", []{ return std::make_unique<int>(20); });
+					return std::make_unique<int>(inner + 1);
+				});
+			});
+		}
+		for(auto& t: threads){
+			t.join();
+		}
+		REQUIRE(made >= 1);
+		REQUIRE(std::all_of(begin(objects), end(objects), [&](const int* p){ return p == objects[0]; }));
+		REQUIRE(*objects[0] == 21);
+	}
+	SECTION("disk cache round trip"){
+		const auto path = std::string("vuh_cache_t.txt");
+		{
+			auto cache = vuh::DiskCache(path);
+			cache.set("key", "value");
+		}
+		REQUIRE(vuh::DiskCache(path).get("key") == std::string("value"));
+		REQUIRE(!vuh::DiskCache(path).get("missing"));
+		std::remove(path.c_str());
+	}
+}
@@ -0,0 +1,64 @@
+#include <catch2/catch.hpp>
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+#include <vuh/alg/reduce.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+TEST_CASE("device-wide reduction", "[correctness][async][algorithms]"){
+	auto instance = vuh::Instance();
+	auto device = vuh::Device(instance, instance.devices().at(0));
+
+	SECTION("bundled operations on int array"){
+		auto host_data = std::vector<int32_t>(1000003);
+		std::iota(begin(host_data), end(host_data), -500000);
+		auto d_data = vuh::Array<int32_t>(device, host_data);
+		auto view = vuh::array_view(d_data, 0, host_data.size());
+
+		auto sum = vuh::reduce(view);
+		auto mn = vuh::reduce(view, vuh::ReduceOp::Min);
+		auto mx = vuh::reduce(view, vuh::ReduceOp::Max);
+		sum.wait(); mn.wait(); mx.wait();
+		REQUIRE(sum.action().value() == std::accumulate(begin(host_data), end(host_data), int32_t(0)));
+		REQUIRE(mn.action().value() == -500000);
+		REQUIRE(mx.action().value() == 500002);
+	}
+	SECTION("float sum of a view at unaligned offset"){
+		auto host_data = std::vector<float>(70000);
+		for(size_t i = 0; i < host_data.size(); ++i){
+			host_data[i] = float(i % 17)*0.25f;
+		}
+		auto d_data = vuh::Array<float>(device, host_data);
+		auto r = vuh::reduce(vuh::array_view(d_data, 3, 65539));
+		r.wait();
+		const auto ref = std::accumulate(begin(host_data) + 3, begin(host_data) + 65539, 0.);
+		REQUIRE(std::abs(r.action().value() - ref) <= 1e-5*ref);
+	}
+	SECTION("empty view results in identity"){
+		auto d_data = vuh::Array<uint32_t>(device, std::vector<uint32_t>(16, 7u));
+		auto r = vuh::reduce(vuh::array_view(d_data, 5, 5), vuh::ReduceOp::Min);
+		r.wait();
+		REQUIRE(r.action().value() == uint32_t(-1));
+	}
+	SECTION("result written to device array"){
+		auto host_data = std::vector<uint32_t>(5000, 3u);
+		auto d_data = vuh::Array<uint32_t>(device, host_data);
+		auto d_out = vuh::Array<uint32_t>(device, std::vector<uint32_t>(4, 0u));
+		vuh::reduce_async(vuh::array_view(d_data, 0, 5000), device_begin(d_out) + 2).wait();
+		REQUIRE(d_out.toHost<std::vector<uint32_t>>() == (std::vector<uint32_t>{0u, 0u, 15000u, 0u}));
+	}
+	SECTION("custom operation"){
+		auto host_data = std::vector<float>(10000, 1.f);
+		host_data[4321] = -42.f;
+		auto d_data = vuh::Array<float>(device, host_data);
+		auto r = vuh::reduce(vuh::array_view(d_data, 0, host_data.size())
+		                     , vuh::read_spirv("../shaders/reduce_absmax.spv"), 0.f);
+		r.wait();
+		REQUIRE(r.action().value() == 42.f);
+	}
+}
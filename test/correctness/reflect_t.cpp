@@ -0,0 +1,51 @@
+#include <catch2/catch.hpp>
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+#include <vuh/reflect.h>
+
+#include <cstdint>
+#include <vector>
+
+TEST_CASE("shader interface reflection", "[program][correctness]"){
+	auto instance = vuh::Instance();
+	auto device = instance.devices().at(0);
+
+	SECTION("saxpy interface is extracted from SPIR-V"){
+		const auto code = vuh::read_spirv("../shaders/saxpy.spv");
+		const auto iface = vuh::reflect_spirv(reinterpret_cast<const uint32_t*>(code.data())
+		                                      , code.size());
+		REQUIRE(iface.valid);
+		REQUIRE(iface.bindings.size() == 2);
+		REQUIRE(iface.binding(0, 0)->type == vk::DescriptorType::eStorageBuffer);
+		REQUIRE(iface.binding(0, 1)->type == vk::DescriptorType::eStorageBuffer);
+		REQUIRE(iface.push_constant_size == 8);
+		REQUIRE(iface.spec_constants.size() == 1);
+		REQUIRE(iface.spec_constant(0)->size == sizeof(uint32_t));
+		REQUIRE(iface.local_size[0].spec_id == 0);
+	}
+	SECTION("non SPIR-V code is not reflected"){
+		const auto code = std::vector<uint32_t>(8, 0u);
+		REQUIRE_FALSE(vuh::reflect_spirv(code.data(), code.size()*sizeof(uint32_t)).valid);
+	}
+	SECTION("push constants smaller than shader block are rejected at construction"){
+		using Specs = vuh::typelist<uint32_t>;
+		struct Params{uint32_t size;};
+		REQUIRE_THROWS_AS((vuh::Program<Specs, Params>(device, "../shaders/saxpy.spv"))
+		                  , vuh::ShaderInterfaceMismatch);
+	}
+	SECTION("specialization constants of wrong size are rejected at construction"){
+		using Specs = vuh::typelist<uint64_t>;
+		struct Params{uint32_t size; float a;};
+		REQUIRE_THROWS_AS((vuh::Program<Specs, Params>(device, "../shaders/saxpy.spv"))
+		                  , vuh::ShaderInterfaceMismatch);
+	}
+	SECTION("missing array parameters are rejected at bind"){
+		using Specs = vuh::typelist<uint32_t>;
+		struct Params{uint32_t size; float a;};
+		auto d_y = vuh::Array<float>(device, 128);
+		auto program = vuh::Program<Specs, Params>(device, "../shaders/saxpy.spv");
+		REQUIRE_THROWS_AS(program.grid(2).spec(64).bind({128, 0.1f}, d_y)
+		                  , vuh::ShaderInterfaceMismatch);
+	}
+}
@@ -99,5 +99,45 @@ TEST_CASE("data transfer and computation interleaved. sync host side.", "[correc
 
 		REQUIRE(y == approx(out_ref).eps(1.e-5).verbose());
 	}
+	SECTION("misaligned view binding throws"){
+		using Specs = vuh::typelist<uint32_t>;
+		struct Params{uint32_t size; float a;};
+		auto program = vuh::Program<Specs, Params>(device, "../shaders/saxpy.spv");
+		if(device.limits().minStorageBufferOffsetAlignment > sizeof(float)){
+			REQUIRE_THROWS_AS(program.grid(1).spec(grid_x)({grid_x, a}
+			                                              , vuh::array_view(d_y, 1, grid_x + 1)
+			                                              , vuh::array_view(d_x, 1, grid_x + 1))
+			                  , vuh::BufferOffsetMisaligned);
+		}
+		const auto aligned = device.limits().minStorageBufferOffsetAlignment/sizeof(float);
+		REQUIRE_NOTHROW(program.grid(1).spec(grid_x)({grid_x, a}
+		                                            , vuh::array_view(d_y, aligned, aligned + grid_x)
+		                                            , vuh::array_view(d_x, aligned, aligned + grid_x)));
+	}
+	SECTION("GPU time profiling"){
+		device.enableProfiling();
+		using Specs = vuh::typelist<uint32_t>;
+		struct Params{uint32_t size; float a;};
+		auto program = vuh::Program<Specs, Params>(device, "../shaders/saxpy.spv");
 
+		auto f_y = vuh::copy_async(begin(y), end(y), device_begin(d_y));
+		auto f_x = vuh::copy_async(begin(x), end(x), device_begin(d_x));
+		f_y.wait();
+		f_x.wait();
+		auto f_p = program.grid(arr_size/grid_x).spec(grid_x).run_async({arr_size, a}, d_y, d_x);
+		f_p.wait();
+		program({arr_size, 0.f}, d_y, d_x);
+		device.enableProfiling(false);
+
+		REQUIRE(program.profile().count == (device.timestampValidBits() ? 2u : 0u));
+		if(device.timestampValidBits()){
+			REQUIRE(f_p.action().elapsed_ns() > 0.);
+			REQUIRE(program.profile().min_ns <= f_p.action().elapsed_ns());
+		}
+		if(device.timestampValidBits(true) && !d_x.isHostVisible()){ // staged copy went through the device
+			REQUIRE(f_x.action().elapsed_ns() > 0.);
+		}
+		d_y.toHost(begin(y));
+		REQUIRE(y == approx(out_ref).eps(1.e-5).verbose());
+	}
 }
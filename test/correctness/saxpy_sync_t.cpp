@@ -56,6 +56,17 @@ TEST_CASE("saxpy_once_1D", "[program][correctness]"){
 		program.grid(2)(d_y, d_x);
 		d_y.toHost(begin(y));
 
+		REQUIRE(y == approx(out_ref).eps(1.e-5));
+	}
+	SECTION("parameters in uniform buffer"){
+		struct Params{uint32_t size; float a;};
+		auto d_params = vuh::UniformArray<Params>(device);
+		d_params.update({128, a});
+		using Specs = vuh::typelist<uint32_t>;
+		auto program = vuh::Program<Specs>(device, "../shaders/saxpy_uniform.spv");
+		program.grid(2).spec(64)(d_y, d_x, d_params);
+		d_y.toHost(begin(y));
+
 		REQUIRE(y == approx(out_ref).eps(1.e-5));
 	}
 }
@@ -0,0 +1,59 @@
+#include <catch2/catch.hpp>
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+#include <vuh/alg/scan.hpp>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+TEST_CASE("device-wide prefix scan", "[correctness][async][algorithms]"){
+	auto instance = vuh::Instance();
+	auto device = vuh::Device(instance, instance.devices().at(0));
+
+	SECTION("inclusive scan over several levels of blocks"){
+		auto host_data = std::vector<uint32_t>(1500007);
+		for(size_t i = 0; i < host_data.size(); ++i){
+			host_data[i] = uint32_t(i % 7);
+		}
+		auto ref = host_data;
+		std::partial_sum(begin(host_data), end(host_data), begin(ref));
+		auto d_src = vuh::Array<uint32_t>(device, host_data);
+		auto d_dst = vuh::Array<uint32_t>(device, host_data.size());
+		vuh::inclusive_scan(vuh::array_view(d_src, 0, host_data.size()), device_begin(d_dst)).wait();
+		REQUIRE(d_dst.toHost<std::vector<uint32_t>>() == ref);
+	}
+	SECTION("exclusive in-place scan of a view"){
+		auto host_data = std::vector<int32_t>(5000, 1);
+		auto d_data = vuh::Array<int32_t>(device, host_data);
+		vuh::exclusive_scan(vuh::array_view(d_data, 7, 4007)).wait();
+		auto ref = host_data;
+		for(int32_t i = 0; i < 4000; ++i){
+			ref[size_t(7 + i)] = i;
+		}
+		REQUIRE(d_data.toHost<std::vector<int32_t>>() == ref);
+	}
+	SECTION("short destination is rejected"){
+		auto d_src = vuh::Array<uint32_t>(device, std::vector<uint32_t>(1000, 1u));
+		auto d_dst = vuh::Array<uint32_t>(device, 1000);
+		REQUIRE_THROWS_AS(vuh::inclusive_scan(vuh::array_view(d_src, 0, 1000), device_begin(d_dst) + 1)
+		                  , vuh::BufferRangeExceeded);
+		auto other = vuh::Device(instance, instance.devices().at(0));
+		auto d_other = vuh::Array<uint32_t>(other, 1000);
+		REQUIRE_THROWS_AS(vuh::exclusive_scan(vuh::array_view(d_src, 0, 1000), device_begin(d_other))
+		                  , vuh::DeviceMismatch);
+	}
+	SECTION("64-bit keys"){
+		if(!device.features().shaderInt64){
+			REQUIRE_THROWS_AS(vuh::detail::scan_kernel<uint64_t>(device), vuh::DeviceFeatureMissing);
+			return;
+		}
+		auto host_data = std::vector<uint64_t>(300000, uint64_t(1) << 20);
+		auto ref = host_data;
+		std::partial_sum(begin(host_data), end(host_data), begin(ref));
+		auto d_data = vuh::Array<uint64_t>(device, host_data);
+		vuh::inclusive_scan(vuh::array_view(d_data, 0, host_data.size())).wait();
+		REQUIRE(d_data.toHost<std::vector<uint64_t>>() == ref);
+	}
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch.hpp>
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+#include <vuh/alg/sort.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+TEST_CASE("device-wide radix sort", "[correctness][async][algorithms]"){
+	auto instance = vuh::Instance();
+	auto device = vuh::Device(instance, instance.devices().at(0));
+	auto gen = std::mt19937(42);
+
+	SECTION("32-bit unsigned keys over several blocks"){
+		auto host_data = std::vector<uint32_t>(1000003);
+		std::generate(begin(host_data), end(host_data), gen);
+		auto d_data = vuh::Array<uint32_t>(device, host_data);
+		vuh::sort(d_data).wait();
+		std::sort(begin(host_data), end(host_data));
+		REQUIRE(d_data.toHost<std::vector<uint32_t>>() == host_data);
+	}
+	SECTION("signed and floating point keys of a view"){
+		auto dist = std::uniform_int_distribution<int32_t>(-1000, 1000);
+		auto host_ints = std::vector<int32_t>(5000);
+		std::generate(begin(host_ints), end(host_ints), [&]{ return dist(gen); });
+		auto host_floats = std::vector<float>(begin(host_ints), end(host_ints));
+		for(auto& x: host_floats){ x *= 0.25f; }
+		auto d_ints = vuh::Array<int32_t>(device, host_ints);
+		auto d_floats = vuh::Array<float>(device, host_floats);
+		vuh::sort(vuh::array_view(d_ints, 10, 4010)).wait();
+		vuh::sort(vuh::array_view(d_floats, 0, host_floats.size())).wait();
+		std::sort(begin(host_ints) + 10, begin(host_ints) + 4010);
+		std::sort(begin(host_floats), end(host_floats));
+		REQUIRE(d_ints.toHost<std::vector<int32_t>>() == host_ints);
+		REQUIRE(d_floats.toHost<std::vector<float>>() == host_floats);
+	}
+	SECTION("64-bit keys"){
+		auto host_data = std::vector<int64_t>(100000);
+		auto dist = std::uniform_int_distribution<int64_t>();
+		std::generate(begin(host_data), end(host_data), [&]{ return dist(gen) - (int64_t(1) << 62); });
+		auto d_data = vuh::Array<int64_t>(device, host_data);
+		vuh::sort(d_data).wait();
+		std::sort(begin(host_data), end(host_data));
+		REQUIRE(d_data.toHost<std::vector<int64_t>>() == host_data);
+	}
+	SECTION("mismatched key and value views are rejected"){
+		auto d_keys = vuh::Array<uint32_t>(device, 1000);
+		auto d_vals = vuh::Array<uint32_t>(device, 999);
+		REQUIRE_THROWS_AS(vuh::sort_by_key(d_keys, d_vals), vuh::BufferRangeExceeded);
+		auto other = vuh::Device(instance, instance.devices().at(0));
+		auto d_other = vuh::Array<uint32_t>(other, 1000);
+		REQUIRE_THROWS_AS(vuh::sort_by_key(d_keys, d_other), vuh::DeviceMismatch);
+	}
+	SECTION("key-value pairs keep the order of equal keys"){
+		auto dist = std::uniform_int_distribution<uint32_t>(0, 99);
+		auto host_keys = std::vector<uint32_t>(300000);
+		std::generate(begin(host_keys), end(host_keys), [&]{ return dist(gen); });
+		auto host_vals = std::vector<uint64_t>(host_keys.size());
+		std::iota(begin(host_vals), end(host_vals), uint64_t(1) << 40);
+		auto d_keys = vuh::Array<uint32_t>(device, host_keys);
+		auto d_vals = vuh::Array<uint64_t>(device, host_vals);
+		vuh::sort_by_key(d_keys, d_vals).wait();
+
+		auto order = std::vector<size_t>(host_keys.size());
+		std::iota(begin(order), end(order), size_t(0));
+		std::stable_sort(begin(order), end(order), [&](size_t a, size_t b){ return host_keys[a] < host_keys[b]; });
+		auto ref_keys = std::vector<uint32_t>();
+		auto ref_vals = std::vector<uint64_t>();
+		for(auto i: order){
+			ref_keys.push_back(host_keys[i]);
+			ref_vals.push_back(host_vals[i]);
+		}
+		REQUIRE(d_keys.toHost<std::vector<uint32_t>>() == ref_keys);
+		REQUIRE(d_vals.toHost<std::vector<uint64_t>>() == ref_vals);
+	}
+}
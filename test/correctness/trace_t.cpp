@@ -0,0 +1,37 @@
+#include <catch2/catch.hpp>
+
+#include <vuh/vuh.h>
+#include <vuh/array.hpp>
+#include <vuh/trace.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+TEST_CASE("chrome trace export", "[trace]"){
+	auto instance = vuh::Instance();
+	auto device = instance.devices().at(0);
+	auto host_data = std::vector<float>(128, 3.14f);
+
+	vuh::trace::clear();
+	vuh::trace::start();
+	REQUIRE(vuh::trace::enabled());
+	{
+		VUH_TRACE_SCOPE("test scope", "test");
+		auto array = vuh::Array<float>(device, host_data);
+		vuh::copy_async(device_begin(array), device_end(array), begin(host_data)).wait();
+	}
+	vuh::trace::stop();
+	REQUIRE_FALSE(vuh::trace::enabled());
+
+	vuh::trace::write_json("vuh_trace_t.json");
+	auto fin = std::ifstream("vuh_trace_t.json");
+	const auto json = std::string(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+	REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+#ifdef VUH_ENABLE_TRACE
+	REQUIRE(json.find("\"test scope\"") != std::string::npos);
+	REQUIRE(json.find("\"copy_async\"") != std::string::npos);
+	REQUIRE(json.find("\"Delayed::wait\"") != std::string::npos);
+#endif
+}
@@ -0,0 +1,55 @@
+#include <sltbench/Bench.h>
+
+#include <vuh/array.hpp>
+#include <vuh/vuh.h>
+#include <vuh/alg/gemm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+	auto instance = vuh::Instance();
+	auto device = vuh::Device(instance, instance.devices().at(0)); ///< gpu device
+
+	/// Square matrices A, B, C in device-local memory.
+	struct Matrices {
+		vuh::Array<float> a;
+		vuh::Array<float> b;
+		vuh::Array<float> c;
+		uint32_t n;
+	};
+
+	/// Fixture keeping the matrices. Tuning of the gemm variant runs in the set up.
+	struct FixDeviceData {
+		using Type = Matrices;
+
+		auto SetUp(const uint32_t& n)-> Type& {
+			if(n != data.n){
+				const auto h = std::vector<float>(size_t(n)*n, 1.f);
+				data = Type{vuh::Array<float>(device, h), vuh::Array<float>(device, h)
+				            , vuh::Array<float>(device, h), n};
+				(void)vuh::detail::gemm_variant(device, n, n);
+			}
+			return data;
+		}
+
+		auto TearDown()-> void {}
+	private:
+		Type data = Type{vuh::Array<float>(device, 1), vuh::Array<float>(device, 1)
+		                 , vuh::Array<float>(device, 1), 0};
+	}; // struct FixDeviceData
+
+	/// Benchmarked function. C = A*B of n x n matrices, waits for completion.
+	auto gemm(Matrices& d, const uint32_t& n)-> void {
+		const auto size = size_t(n)*n;
+		vuh::gemm(n, n, n, 1.f, vuh::array_view(d.a, 0, size), n, vuh::array_view(d.b, 0, size), n
+		          , 0.f, vuh::array_view(d.c, 0, size), n).wait();
+	}
+
+	/// Set of matrix sizes to run benchmarks on.
+	static const auto params = std::vector<uint32_t>({64, 256, 1024, 2048});
+} // namespace
+
+SLTBENCH_FUNCTION_WITH_FIXTURE_AND_ARGS(gemm, FixDeviceData, params)
+
+SLTBENCH_MAIN()
@@ -0,0 +1,64 @@
+#include <sltbench/Bench.h>
+
+#include <vuh/array.hpp>
+#include <vuh/vuh.h>
+#include <vuh/alg/scan.hpp>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace {
+	auto instance = vuh::Instance();
+	auto device = vuh::Device(instance, instance.devices().at(0)); ///< gpu device
+
+	/// Fixture keeping the host data.
+	struct FixHostData {
+		using Type = std::vector<uint32_t>;
+
+		auto SetUp(const size_t& n)-> Type& {
+			if(n != data.size()){
+				data = Type(n, 1u);
+			}
+			return data;
+		}
+
+		auto TearDown()-> void {}
+	private:
+		Type data;
+	}; // struct FixHostData
+
+	/// Fixture keeping the data in device-local memory.
+	struct FixDeviceData {
+		using Type = vuh::Array<uint32_t>;
+
+		auto SetUp(const size_t& n)-> Type& {
+			if(n != data.size()){
+				data = Type(device, std::vector<uint32_t>(n, 1u));
+			}
+			return data;
+		}
+
+		auto TearDown()-> void {}
+	private:
+		Type data = Type(device, 1);
+	}; // struct FixDeviceData
+
+	/// Benchmarked function. Host baseline.
+	auto scan(std::vector<uint32_t>& data, const size_t& /*n*/)-> void {
+		std::inclusive_scan(begin(data), end(data), begin(data));
+	}
+
+	/// Benchmarked function. In-place device scan, waits for completion.
+	auto scan(vuh::Array<uint32_t>& data, const size_t& n)-> void {
+		vuh::inclusive_scan(vuh::array_view(data, 0, n)).wait();
+	}
+
+	/// Set of array sizes to run benchmarks on.
+	static const auto params = std::vector<size_t>({size_t(1) << 16, size_t(1) << 20, size_t(1) << 24});
+} // namespace
+
+SLTBENCH_FUNCTION_WITH_FIXTURE_AND_ARGS(scan, FixHostData, params)
+SLTBENCH_FUNCTION_WITH_FIXTURE_AND_ARGS(scan, FixDeviceData, params)
+
+SLTBENCH_MAIN()
@@ -0,0 +1,69 @@
+#include <sltbench/Bench.h>
+
+#include <vuh/array.hpp>
+#include <vuh/vuh.h>
+#include <vuh/alg/sort.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+	auto instance = vuh::Instance();
+	auto device = vuh::Device(instance, instance.devices().at(0)); ///< gpu device
+
+	/// @return n random keys, same for all fixtures
+	auto random_keys(size_t n)-> std::vector<uint32_t> {
+		auto gen = std::mt19937(42);
+		auto r = std::vector<uint32_t>(n);
+		std::generate(begin(r), end(r), gen);
+		return r;
+	}
+
+	/// Fixture keeping the unsorted host data.
+	struct FixHostData {
+		using Type = std::vector<uint32_t>;
+
+		auto SetUp(const size_t& n)-> Type& {
+			data = random_keys(n);
+			return data;
+		}
+
+		auto TearDown()-> void {}
+	private:
+		Type data;
+	}; // struct FixHostData
+
+	/// Fixture keeping the unsorted data in device-local memory.
+	struct FixDeviceData {
+		using Type = vuh::Array<uint32_t>;
+
+		auto SetUp(const size_t& n)-> Type& {
+			data = Type(device, random_keys(n));
+			return data;
+		}
+
+		auto TearDown()-> void {}
+	private:
+		Type data = Type(device, 1);
+	}; // struct FixDeviceData
+
+	/// Benchmarked function. Host baseline.
+	auto sort(std::vector<uint32_t>& data, const size_t& /*n*/)-> void {
+		std::sort(begin(data), end(data));
+	}
+
+	/// Benchmarked function. In-place device radix sort, waits for completion.
+	auto sort(vuh::Array<uint32_t>& data, const size_t& /*n*/)-> void {
+		vuh::sort(data).wait();
+	}
+
+	/// Set of array sizes to run benchmarks on.
+	static const auto params = std::vector<size_t>({size_t(1) << 16, size_t(1) << 20, size_t(1) << 24});
+} // namespace
+
+SLTBENCH_FUNCTION_WITH_FIXTURE_AND_ARGS(sort, FixHostData, params)
+SLTBENCH_FUNCTION_WITH_FIXTURE_AND_ARGS(sort, FixDeviceData, params)
+
+SLTBENCH_MAIN()